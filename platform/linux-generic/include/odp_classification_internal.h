@@ -50,6 +50,23 @@ This function should be called during pktio initialization.
 **/
 int pktio_classifier_init(pktio_entry_t *pktio);
 
+/**
+Packet RSS hash
+
+Calculates Toeplitz hash over the packet header fields selected by hash_proto.
+Packet must have been parsed up to L4 into prs. Headers are read from base.
+Returns zero when no selected header fields are present.
+**/
+uint32_t packet_rss_hash(const packet_parser_t *prs,
+			 odp_cls_hash_proto_t hash_proto, const uint8_t *base);
+
+/**
+Convert pktin hash protocol selection into classifier hash protocol bits. Bits
+are added into cls_proto.
+**/
+void _odp_cls_update_hash_proto(odp_cls_hash_proto_t *cls_proto,
+				odp_pktin_hash_proto_t hash_proto);
+
 #ifdef __cplusplus
 }
 #endif
@@ -149,6 +149,18 @@ extern "C" {
 /* Maximum packet vector size */
 #define CONFIG_PACKET_VECTOR_MAX_SIZE 256
 
+/*
+ * Maximum number of IPsec SAs. The actual number of SAs is selected with
+ * ipsec.max_num_sa config file option.
+ */
+#define CONFIG_IPSEC_MAX_NUM_SA (1024 * 1024)
+
+/*
+ * Maximum IPsec anti-replay window size. The actual maximum is selected with
+ * ipsec.max_antireplay_ws config file option.
+ */
+#define CONFIG_IPSEC_MAX_ANTIREPLAY_WS 4096
+
 #ifdef __cplusplus
 }
 #endif
@@ -83,17 +83,26 @@ int _odp_ipsec_status_send(odp_queue_t queue,
 
 #define IPSEC_MAX_SALT_LEN	4    /**< Maximum salt length in bytes */
 
-/* 32 is minimum required by the standard. We do not support more */
+/* 32 is minimum required by the standard. Maximum window size is selected
+ * with ipsec.max_antireplay_ws config file option. */
 #define IPSEC_ANTIREPLAY_WS	32
 
-/**
- * Maximum number of available SAs
- */
-#define ODP_CONFIG_IPSEC_SAS	8
+/* Length of ESN high order bits inserted for ICV calculation */
+#define IPSEC_SEQ_HI_LEN	4
 
 struct ipsec_sa_s {
 	odp_atomic_u32_t state ODP_ALIGNED_CACHE;
 
+	/* Next SA (index + 1) in the same lookup hash chain, 0 terminates */
+	odp_atomic_u32_t hash_next;
+
+	/* Incremented on every SA create. Used to detect stale per thread
+	 * lifetime state. */
+	uint32_t	create_seq;
+
+	/* Anti-replay window blocks of inbound SA */
+	odp_atomic_u64_t *antireplay_win;
+
 	/*
 	 * State that gets updated very frequently. Grouped separately
 	 * to avoid false cache line sharing with other data.
@@ -105,7 +114,8 @@ struct ipsec_sa_s {
 
 		union {
 			struct {
-				odp_atomic_u64_t antireplay;
+				/* Highest (64-bit) sequence number received */
+				odp_atomic_u64_t max_seq;
 			} in;
 
 			struct {
@@ -160,6 +170,11 @@ struct ipsec_sa_s {
 
 			/* Only for inbound */
 			unsigned	antireplay : 1;
+
+			/* Extended (64-bit) sequence numbers */
+			unsigned	esn : 1;
+			/* ESN high order bits are added to ICV calculation */
+			unsigned	insert_seq_hi : 1;
 		};
 	};
 
@@ -170,6 +185,9 @@ struct ipsec_sa_s {
 				odp_u32be_t	lookup_dst_ipv4;
 				uint8_t lookup_dst_ipv6[_ODP_IPV6ADDR_LEN];
 			};
+
+			/* Anti-replay window size */
+			uint32_t	antireplay_ws;
 		} in;
 
 		struct {
@@ -212,15 +230,30 @@ typedef struct odp_ipsec_sa_lookup_s {
 /** IPSEC AAD */
 typedef struct ODP_PACKED {
 	odp_u32be_t spi;     /**< Security Parameter Index */
-	odp_u32be_t seq_no;  /**< Sequence Number */
+	union {
+		odp_u32be_t seq_no;  /**< Sequence Number */
+		odp_u64be_t esn;     /**< Extended Sequence Number */
+	};
 } ipsec_aad_t;
 
+/** AAD length without ESN */
+#define IPSEC_AAD_LEN		8
+
+/** AAD length with ESN */
+#define IPSEC_AAD_ESN_LEN	12
+
 /* Return IV length required for the cipher for IPsec use */
 uint32_t _odp_ipsec_cipher_iv_len(odp_cipher_alg_t cipher);
 
 /* Return digest length required for the cipher for IPsec use */
 uint32_t _odp_ipsec_auth_digest_len(odp_auth_alg_t auth);
 
+/* Maximum number of SAs, as configured during global init */
+uint32_t _odp_ipsec_max_num_sa(void);
+
+/* Maximum anti-replay window size, as configured during global init */
+uint32_t _odp_ipsec_max_antireplay_ws(void);
+
 /*
  * Get SA entry from handle without obtaining a reference
  */
@@ -257,18 +290,22 @@ int _odp_ipsec_sa_stats_precheck(ipsec_sa_t *ipsec_sa,
 int _odp_ipsec_sa_stats_update(ipsec_sa_t *ipsec_sa, uint32_t len,
 			       odp_ipsec_op_status_t *status);
 
+/* Return full sequence number of an inbound packet. With ESN, high order
+ * bits are inferred from the current window position (RFC 4303 A2). */
+uint64_t _odp_ipsec_sa_in_seq(ipsec_sa_t *ipsec_sa, uint32_t seq);
+
 /* Run pre-check on sequence number of the packet.
  *
  * @retval <0 if the packet falls out of window
  */
-int _odp_ipsec_sa_replay_precheck(ipsec_sa_t *ipsec_sa, uint32_t seq,
+int _odp_ipsec_sa_replay_precheck(ipsec_sa_t *ipsec_sa, uint64_t seq,
 				  odp_ipsec_op_status_t *status);
 
 /* Run check on sequence number of the packet and update window if necessary.
  *
  * @retval <0 if the packet falls out of window
  */
-int _odp_ipsec_sa_replay_update(ipsec_sa_t *ipsec_sa, uint32_t seq,
+int _odp_ipsec_sa_replay_update(ipsec_sa_t *ipsec_sa, uint64_t seq,
 				odp_ipsec_op_status_t *status);
 
 /**
@@ -252,6 +252,12 @@ extern const pktio_if_ops_t netmap_pktio_ops;
 extern const pktio_if_ops_t dpdk_pktio_ops;
 extern const pktio_if_ops_t sock_mmsg_pktio_ops;
 extern const pktio_if_ops_t sock_mmap_pktio_ops;
+#ifdef _ODP_PKTIO_XDP
+extern const pktio_if_ops_t sock_xdp_pktio_ops;
+#endif
+#ifdef _ODP_PKTIO_IO_URING
+extern const pktio_if_ops_t sock_uring_pktio_ops;
+#endif
 extern const pktio_if_ops_t loopback_pktio_ops;
 #ifdef _ODP_PKTIO_PCAP
 extern const pktio_if_ops_t pcap_pktio_ops;
@@ -19,8 +19,21 @@ extern "C" {
 
 int _odp_pcapng_start(pktio_entry_t *entry);
 void _odp_pcapng_stop(pktio_entry_t *entry);
-int _odp_pcapng_write_pkts(pktio_entry_t *entry, int qidx,
-			   const odp_packet_t packets[], int num);
+
+/* Capture packets. Packets are referenced and queued to the writer thread. */
+void _odp_pcapng_capture_pkts(pktio_entry_t *entry, int qidx,
+			      const odp_packet_t packets[], int num);
+
+/* Two phase capture for packet output. Start references the packets and
+ * stores the selected capture slots into slot_idx (min. num entries). End
+ * queues packets with index < num_sent to the writer thread and releases the
+ * rest. */
+int _odp_pcapng_capture_start(pktio_entry_t *entry, int qidx,
+			      const odp_packet_t packets[], int num,
+			      uint32_t slot_idx[]);
+void _odp_pcapng_capture_end(pktio_entry_t *entry, int qidx,
+			     const uint32_t slot_idx[], int num_slot,
+			     int num_sent);
 
 #ifdef __cplusplus
 }
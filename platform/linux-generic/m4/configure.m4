@@ -24,6 +24,8 @@ AM_CONDITIONAL([ODP_PKTIO_PCAP], [test x$have_pcap = xyes])
 m4_include([platform/linux-generic/m4/odp_libconfig.m4])
 m4_include([platform/linux-generic/m4/odp_pcapng.m4])
 m4_include([platform/linux-generic/m4/odp_netmap.m4])
+m4_include([platform/linux-generic/m4/odp_xdp.m4])
+m4_include([platform/linux-generic/m4/odp_io_uring.m4])
 m4_include([platform/linux-generic/m4/odp_dpdk.m4])
 ODP_SCHEDULER
 
@@ -34,6 +36,8 @@ AS_VAR_APPEND([PLAT_DEP_LIBS], ["${LIBCONFIG_LIBS} ${OPENSSL_LIBS} ${DPDK_LIBS_L
 AS_VAR_APPEND([PLAT_CFG_TEXT], ["
 	pcap:			${have_pcap}
 	pcapng:			${have_pcapng}
+	xdp:			${have_xdp}
+	io_uring:		${have_io_uring}
 	default_config_path:	${default_config_path}"])
 
 AC_CONFIG_COMMANDS_PRE([dnl
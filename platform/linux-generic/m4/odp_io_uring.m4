@@ -0,0 +1,25 @@
+##########################################################################
+# Enable io_uring socket support
+##########################################################################
+have_io_uring=no
+AC_ARG_ENABLE([io-uring],
+    [AS_HELP_STRING([--enable-io-uring], [include io_uring socket IO support]
+                    [[default=disabled] (linux-generic)])],
+    [if test x$enableval = xyes; then
+        have_io_uring=yes
+    fi])
+
+##########################################################################
+# Check for io_uring availability
+##########################################################################
+if test x$have_io_uring = xyes
+then
+    AC_CHECK_HEADERS([linux/io_uring.h linux/time_types.h], [],
+        [AC_MSG_FAILURE(["can't find io_uring kernel headers"])])
+    AC_CHECK_DECLS([IORING_RECV_MULTISHOT, IORING_REGISTER_PBUF_RING,
+                    IORING_ASYNC_CANCEL_ANY], [],
+        [AC_MSG_FAILURE(["io_uring kernel headers too old"])],
+        [#include <linux/io_uring.h>])
+    AC_DEFINE([_ODP_PKTIO_IO_URING], [1],
+	      [Define to 1 to enable io_uring socket packet I/O support])
+fi
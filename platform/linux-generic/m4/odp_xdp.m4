@@ -0,0 +1,27 @@
+##########################################################################
+# Enable AF_XDP socket support
+##########################################################################
+have_xdp=no
+AC_ARG_ENABLE([xdp],
+    [AS_HELP_STRING([--enable-xdp], [include AF_XDP socket IO support]
+                    [[default=disabled] (linux-generic)])],
+    [if test x$enableval = xyes; then
+        have_xdp=yes
+    fi])
+
+##########################################################################
+# Check for AF_XDP availability
+##########################################################################
+if test x$have_xdp = xyes
+then
+    AC_CHECK_HEADERS([linux/if_xdp.h linux/bpf.h], [],
+        [AC_MSG_FAILURE(["can't find AF_XDP kernel headers"])])
+    AC_CHECK_DECLS([XDP_UMEM_UNALIGNED_CHUNK_FLAG, XDP_USE_NEED_WAKEUP],
+        [], [AC_MSG_FAILURE(["AF_XDP kernel headers too old"])],
+        [#include <linux/if_xdp.h>])
+    AC_CHECK_DECLS([BPF_LINK_CREATE], [],
+        [AC_MSG_FAILURE(["BPF kernel headers too old"])],
+        [#include <linux/bpf.h>])
+    AC_DEFINE([_ODP_PKTIO_XDP], [1],
+	      [Define to 1 to enable AF_XDP socket packet I/O support])
+fi
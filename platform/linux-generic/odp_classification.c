@@ -205,19 +205,19 @@ void odp_cls_pmr_create_opt_init(odp_pmr_create_opt_t *opt)
 	opt->mark = 0;
 }
 
-static void _odp_cls_update_hash_proto(cos_t *cos,
-				       odp_pktin_hash_proto_t hash_proto)
+void _odp_cls_update_hash_proto(odp_cls_hash_proto_t *cls_proto,
+				odp_pktin_hash_proto_t hash_proto)
 {
 	if (hash_proto.proto.ipv4 || hash_proto.proto.ipv4_tcp ||
 	    hash_proto.proto.ipv4_udp)
-		cos->s.hash_proto.ipv4 = 1;
+		cls_proto->ipv4 = 1;
 	if (hash_proto.proto.ipv6 || hash_proto.proto.ipv6_tcp ||
 	    hash_proto.proto.ipv6_udp)
-		cos->s.hash_proto.ipv6 = 1;
+		cls_proto->ipv6 = 1;
 	if (hash_proto.proto.ipv4_tcp || hash_proto.proto.ipv6_tcp)
-		cos->s.hash_proto.tcp = 1;
+		cls_proto->tcp = 1;
 	if (hash_proto.proto.ipv4_udp || hash_proto.proto.ipv6_udp)
-		cos->s.hash_proto.udp = 1;
+		cls_proto->udp = 1;
 }
 
 static inline void _cls_queue_unwind(uint32_t tbl_index, uint32_t j)
@@ -286,7 +286,7 @@ odp_cos_t odp_cls_cos_create(const char *name, const odp_cls_cos_param_t *param)
 				odp_queue_param_init(&cos->s.queue_param);
 				cos->s.queue_group = true;
 				cos->s.queue = ODP_QUEUE_INVALID;
-				_odp_cls_update_hash_proto(cos,
+				_odp_cls_update_hash_proto(&cos->s.hash_proto,
 							   param->hash_proto);
 				tbl_index = i * CLS_COS_QUEUE_MAX;
 				for (j = 0; j < param->num_queue; j++) {
@@ -1561,10 +1561,6 @@ static inline cos_t *cls_select_cos(pktio_entry_t *entry,
 	return cls->default_cos;
 }
 
-static uint32_t packet_rss_hash(odp_packet_hdr_t *pkt_hdr,
-				odp_cls_hash_proto_t hash_proto,
-				const uint8_t *base);
-
 /**
  * Classify packet
  *
@@ -1619,7 +1615,7 @@ int cls_classify_packet(pktio_entry_t *entry, const uint8_t *base,
 		return 0;
 	}
 
-	hash = packet_rss_hash(pkt_hdr, cos->s.hash_proto, base);
+	hash = packet_rss_hash(&pkt_hdr->p, cos->s.hash_proto, base);
 	/* CLS_COS_QUEUE_MAX is a power of 2 */
 	hash = hash & (CLS_COS_QUEUE_MAX - 1);
 	tbl_index = (cos->s.index * CLS_COS_QUEUE_MAX) + (hash %
@@ -1628,9 +1624,8 @@ int cls_classify_packet(pktio_entry_t *entry, const uint8_t *base,
 	return 0;
 }
 
-static uint32_t packet_rss_hash(odp_packet_hdr_t *pkt_hdr,
-				odp_cls_hash_proto_t hash_proto,
-				const uint8_t *base)
+uint32_t packet_rss_hash(const packet_parser_t *prs,
+			 odp_cls_hash_proto_t hash_proto, const uint8_t *base)
 {
 	thash_tuple_t tuple;
 	const _odp_ipv4hdr_t *ipv4;
@@ -1642,49 +1637,49 @@ static uint32_t packet_rss_hash(odp_packet_hdr_t *pkt_hdr,
 
 	tuple_len = 0;
 	hash = 0;
-	if (pkt_hdr->p.input_flags.ipv4) {
+	if (prs->input_flags.ipv4) {
 		if (hash_proto.ipv4) {
 			/* add ipv4 */
 			ipv4 = (const _odp_ipv4hdr_t *)(base +
-				pkt_hdr->p.l3_offset);
+				prs->l3_offset);
 			tuple.v4.src_addr = ipv4->src_addr;
 			tuple.v4.dst_addr = ipv4->dst_addr;
 			tuple_len += 2;
 		}
 
-		if (pkt_hdr->p.input_flags.tcp && hash_proto.tcp) {
+		if (prs->input_flags.tcp && hash_proto.tcp) {
 			/* add tcp */
 			tcp = (const _odp_tcphdr_t *)(base +
-			       pkt_hdr->p.l4_offset);
+			       prs->l4_offset);
 			tuple.v4.sport = tcp->src_port;
 			tuple.v4.dport = tcp->dst_port;
 			tuple_len += 1;
-		} else if (pkt_hdr->p.input_flags.udp && hash_proto.udp) {
+		} else if (prs->input_flags.udp && hash_proto.udp) {
 			/* add udp */
 			udp = (const _odp_udphdr_t *)(base +
-			       pkt_hdr->p.l4_offset);
+			       prs->l4_offset);
 			tuple.v4.sport = udp->src_port;
 			tuple.v4.dport = udp->dst_port;
 			tuple_len += 1;
 		}
-	} else if (pkt_hdr->p.input_flags.ipv6) {
+	} else if (prs->input_flags.ipv6) {
 		if (hash_proto.ipv6) {
 			/* add ipv6 */
 			ipv6 = (const _odp_ipv6hdr_t *)(base +
-				pkt_hdr->p.l3_offset);
+				prs->l3_offset);
 			thash_load_ipv6_addr(ipv6, &tuple);
 			tuple_len += 8;
 		}
-		if (pkt_hdr->p.input_flags.tcp && hash_proto.tcp) {
+		if (prs->input_flags.tcp && hash_proto.tcp) {
 			tcp = (const _odp_tcphdr_t *)(base +
-			       pkt_hdr->p.l4_offset);
+			       prs->l4_offset);
 			tuple.v6.sport = tcp->src_port;
 			tuple.v6.dport = tcp->dst_port;
 			tuple_len += 1;
-		} else if (pkt_hdr->p.input_flags.udp && hash_proto.udp) {
+		} else if (prs->input_flags.udp && hash_proto.udp) {
 			/* add udp */
 			udp = (const _odp_udphdr_t *)(base +
-			       pkt_hdr->p.l4_offset);
+			       prs->l4_offset);
 			tuple.v6.sport = udp->src_port;
 			tuple.v6.dport = udp->dst_port;
 			tuple_len += 1;
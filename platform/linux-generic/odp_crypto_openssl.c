@@ -15,17 +15,25 @@
 #include <odp_debug_internal.h>
 #include <odp/api/hints.h>
 #include <odp/api/random.h>
+#include <odp/api/time.h>
 #include <odp/api/plat/packet_inlines.h>
 #include <odp/api/plat/thread_inlines.h>
 #include <odp_packet_internal.h>
 #include <odp/api/plat/queue_inlines.h>
 #include <odp_global_data.h>
+#include <odp_libconfig_internal.h>
+#include <odp_align_internal.h>
+#include <odp_ring_u32_internal.h>
 
 /* Inlined API functions */
 #include <odp/api/plat/event_inlines.h>
 
 #include <string.h>
 #include <stdlib.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
 
 #include <openssl/hmac.h>
 #include <openssl/cmac.h>
@@ -37,10 +45,21 @@
 #define _ODP_HAVE_CHACHA20_POLY1305 0
 #endif
 
-#define MAX_SESSIONS 32
+#define MAX_SESSIONS (64 * 1024)
 #define AES_BLOCK_SIZE 16
 #define AES_KEY_LENGTH 16
 
+/* Crypto engine limits */
+#define ENGINE_MAX_WORKERS    16
+#define ENGINE_MAX_QUEUE_SIZE (64 * 1024)
+#define ENGINE_MAX_BURST      64
+#define ENGINE_MAX_AAD_LEN    16
+
+/* Per thread OpenSSL context cache size. Cache is set associative and
+ * sessions map to sets by session index. */
+#define CTX_CACHE_SETS 256
+#define CTX_CACHE_WAYS 4
+
 /*
  * Cipher algorithm capabilities
  *
@@ -203,8 +222,6 @@ typedef void (*crypto_init_func_t)(odp_crypto_generic_session_t *session);
  * Per crypto session data structure
  */
 struct odp_crypto_generic_session_t {
-	odp_crypto_generic_session_t *next;
-
 	/* Session creation parameters */
 	odp_crypto_session_param_t p;
 
@@ -232,94 +249,98 @@ struct odp_crypto_generic_session_t {
 	} auth;
 
 	unsigned idx;
+
+	/* Incremented on every allocation. Invalidates contexts cached for
+	 * previous sessions using the same slot. */
+	uint32_t gen;
 };
 
 typedef struct odp_crypto_global_s odp_crypto_global_t;
 
 struct odp_crypto_global_s {
-	odp_spinlock_t                lock;
-	odp_crypto_generic_session_t *free;
-	odp_crypto_generic_session_t  sessions[MAX_SESSIONS];
+	odp_crypto_generic_session_t *sessions;
 
-	/* These flags are cleared at alloc_session() */
-	uint8_t ctx_valid[ODP_THREAD_COUNT_MAX][MAX_SESSIONS];
+	/* Free session indexes */
+	ring_u32_t                   *free_ring;
+	uint32_t                      ring_mask;
+	uint32_t                      max_sessions;
+	odp_atomic_u32_t              num_sessions;
 
 	odp_ticketlock_t              openssl_lock[0];
 };
 
 static odp_crypto_global_t *global;
 
+/* OpenSSL contexts of a session. Contexts are created on first use and reused
+ * for another session when the cache entry is evicted. */
+typedef struct {
+	odp_crypto_generic_session_t *session;
+	uint32_t gen;
+	uint32_t last_use;
+	EVP_MD_CTX *md_ctx;
+	HMAC_CTX *hmac_ctx;
+	CMAC_CTX *cmac_ctx;
+	EVP_CIPHER_CTX *cipher_ctx;
+	EVP_CIPHER_CTX *mac_cipher_ctx;
+} crypto_ctx_t;
+
 typedef struct crypto_local_t {
-	EVP_MD_CTX *md_ctx[MAX_SESSIONS];
-	HMAC_CTX *hmac_ctx[MAX_SESSIONS];
-	CMAC_CTX *cmac_ctx[MAX_SESSIONS];
-	EVP_CIPHER_CTX *cipher_ctx[MAX_SESSIONS];
-	EVP_CIPHER_CTX *mac_cipher_ctx[MAX_SESSIONS];
-	uint8_t *ctx_valid;
+	/* Contexts of the session being processed */
+	crypto_ctx_t *ctx;
+
+	/* CTX_CACHE_SETS * CTX_CACHE_WAYS entries */
+	crypto_ctx_t *cache;
+	uint32_t use_cnt;
 } crypto_local_t;
 
 static __thread crypto_local_t local;
 
-static inline void crypto_init(odp_crypto_generic_session_t *session)
-{
-	if (local.ctx_valid[session->idx])
-		return;
+/* Asynchronous operation waiting for an engine worker */
+typedef struct {
+	odp_packet_t pkt;
+	odp_crypto_generic_session_t *session;
+	odp_crypto_packet_op_param_t param;
+	uint8_t cipher_iv[EVP_MAX_IV_LENGTH];
+	uint8_t auth_iv[EVP_MAX_IV_LENGTH];
+	uint8_t aad[ENGINE_MAX_AAD_LEN];
+} engine_op_t;
 
-	session->cipher.init(session);
-	session->auth.init(session);
+typedef struct ODP_ALIGNED_CACHE {
+	/* Operation slots owned by this worker */
+	engine_op_t *op;
 
-	local.ctx_valid[session->idx] = 1;
-}
+	/* Free operation slot indexes */
+	ring_u32_t *free_ring;
 
-static
-odp_crypto_generic_session_t *alloc_session(void)
-{
-	odp_crypto_generic_session_t *session = NULL;
-	unsigned i;
+	/* Submitted operation slot indexes */
+	ring_u32_t *submit_ring;
 
-	odp_spinlock_lock(&global->lock);
-	session = global->free;
-	if (session) {
-		global->free = session->next;
-		session->next = NULL;
-	}
-	odp_spinlock_unlock(&global->lock);
+	pthread_t thread;
+	int started;
+	int idx;
 
-	if (!session)
-		return NULL;
+	/* Completion events dropped due to a completion queue failure */
+	odp_atomic_u64_t dropped;
+} engine_worker_t;
 
-	session->idx = session - global->sessions;
+typedef struct {
+	odp_shm_t shm;
+	odp_atomic_u32_t stop;
+	uint32_t num_workers;
+	uint32_t ring_mask;
+	uint32_t burst_size;
+	uint64_t idle_sleep_ns;
+	int cpu;
 
-	for (i = 0; i < ODP_THREAD_COUNT_MAX; i++)
-		global->ctx_valid[i][session->idx] = 0;
+	engine_worker_t worker[ENGINE_MAX_WORKERS];
+} crypto_engine_t;
 
-	return session;
-}
+/* NULL when the engine is disabled */
+static crypto_engine_t *engine;
 
-static
-void free_session(odp_crypto_generic_session_t *session)
-{
-	odp_spinlock_lock(&global->lock);
-	session->next = global->free;
-	global->free = session;
-	odp_spinlock_unlock(&global->lock);
-}
-
-static odp_crypto_alg_err_t
-null_crypto_routine(odp_packet_t pkt ODP_UNUSED,
-		    const odp_crypto_packet_op_param_t *param ODP_UNUSED,
-		    odp_crypto_generic_session_t *session ODP_UNUSED)
-{
-	return ODP_CRYPTO_ALG_ERR_NONE;
-}
-
-static void
-null_crypto_init_routine(odp_crypto_generic_session_t *session ODP_UNUSED)
-{
-	return;
-}
+static int engine_init_global(void);
+static int engine_term_global(void);
 
-/* Mimic new OpenSSL 1.1.y API */
 #if OPENSSL_VERSION_NUMBER < 0x10100000L
 static HMAC_CTX *HMAC_CTX_new(void)
 {
@@ -350,10 +371,144 @@ static void EVP_MD_CTX_free(EVP_MD_CTX *ctx)
 }
 #endif
 
+static void crypto_ctx_free(crypto_ctx_t *ctx)
+{
+	if (ctx->cmac_ctx != NULL)
+		CMAC_CTX_free(ctx->cmac_ctx);
+	if (ctx->hmac_ctx != NULL)
+		HMAC_CTX_free(ctx->hmac_ctx);
+	if (ctx->cipher_ctx != NULL)
+		EVP_CIPHER_CTX_free(ctx->cipher_ctx);
+	if (ctx->mac_cipher_ctx != NULL)
+		EVP_CIPHER_CTX_free(ctx->mac_cipher_ctx);
+	if (ctx->md_ctx != NULL)
+		EVP_MD_CTX_free(ctx->md_ctx);
+
+	memset(ctx, 0, sizeof(crypto_ctx_t));
+}
+
+static int crypto_ctx_alloc(crypto_ctx_t *ctx)
+{
+	ctx->hmac_ctx = HMAC_CTX_new();
+	ctx->cmac_ctx = CMAC_CTX_new();
+	ctx->cipher_ctx = EVP_CIPHER_CTX_new();
+	ctx->mac_cipher_ctx = EVP_CIPHER_CTX_new();
+	ctx->md_ctx = EVP_MD_CTX_new();
+
+	if (ctx->hmac_ctx == NULL ||
+	    ctx->cmac_ctx == NULL ||
+	    ctx->md_ctx == NULL ||
+	    ctx->cipher_ctx == NULL ||
+	    ctx->mac_cipher_ctx == NULL) {
+		crypto_ctx_free(ctx);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Replace the least recently used entry of the set with session contexts */
+static int crypto_ctx_miss(odp_crypto_generic_session_t *session,
+			   crypto_ctx_t *set)
+{
+	crypto_ctx_t *ctx = &set[0];
+	uint32_t age, max_age = 0;
+	int i;
+
+	for (i = 0; i < CTX_CACHE_WAYS; i++) {
+		if (set[i].session == NULL) {
+			ctx = &set[i];
+			break;
+		}
+
+		age = local.use_cnt - set[i].last_use;
+		if (age > max_age) {
+			max_age = age;
+			ctx = &set[i];
+		}
+	}
+
+	if (ctx->md_ctx == NULL && crypto_ctx_alloc(ctx)) {
+		ODP_DBG("OpenSSL context alloc failed\n");
+		return -1;
+	}
+
+	ctx->session = session;
+	ctx->gen = session->gen;
+	ctx->last_use = local.use_cnt;
+	local.ctx = ctx;
+
+	session->cipher.init(session);
+	session->auth.init(session);
+
+	return 0;
+}
+
+/* Select session contexts of this thread */
+static inline int crypto_init(odp_crypto_generic_session_t *session)
+{
+	uint32_t set_idx = session->idx & (CTX_CACHE_SETS - 1);
+	crypto_ctx_t *set = &local.cache[set_idx * CTX_CACHE_WAYS];
+	int i;
+
+	local.use_cnt++;
+
+	for (i = 0; i < CTX_CACHE_WAYS; i++) {
+		if (odp_likely(set[i].session == session &&
+			       set[i].gen == session->gen)) {
+			set[i].last_use = local.use_cnt;
+			local.ctx = &set[i];
+			return 0;
+		}
+	}
+
+	return crypto_ctx_miss(session, set);
+}
+
+static
+odp_crypto_generic_session_t *alloc_session(void)
+{
+	odp_crypto_generic_session_t *session;
+	uint32_t idx;
+
+	if (ring_u32_deq(global->free_ring, global->ring_mask, &idx) == 0)
+		return NULL;
+
+	odp_atomic_inc_u32(&global->num_sessions);
+
+	session = &global->sessions[idx];
+	session->idx = idx;
+	session->gen++;
+
+	return session;
+}
+
+static
+void free_session(odp_crypto_generic_session_t *session)
+{
+	odp_atomic_dec_u32(&global->num_sessions);
+	ring_u32_enq(global->free_ring, global->ring_mask, session->idx);
+}
+
+static odp_crypto_alg_err_t
+null_crypto_routine(odp_packet_t pkt ODP_UNUSED,
+		    const odp_crypto_packet_op_param_t *param ODP_UNUSED,
+		    odp_crypto_generic_session_t *session ODP_UNUSED)
+{
+	return ODP_CRYPTO_ALG_ERR_NONE;
+}
+
+static void
+null_crypto_init_routine(odp_crypto_generic_session_t *session ODP_UNUSED)
+{
+	return;
+}
+
+/* Mimic new OpenSSL 1.1.y API */
 static void
 auth_hmac_init(odp_crypto_generic_session_t *session)
 {
-	HMAC_CTX *ctx = local.hmac_ctx[session->idx];
+	HMAC_CTX *ctx = local.ctx->hmac_ctx;
 
 	HMAC_Init_ex(ctx,
 		     session->auth.key,
@@ -365,10 +520,10 @@ auth_hmac_init(odp_crypto_generic_session_t *session)
 static
 void packet_hmac(odp_packet_t pkt,
 		 const odp_crypto_packet_op_param_t *param,
-		 odp_crypto_generic_session_t *session,
+		 odp_crypto_generic_session_t *session ODP_UNUSED,
 		 uint8_t *hash)
 {
-	HMAC_CTX *ctx = local.hmac_ctx[session->idx];
+	HMAC_CTX *ctx = local.ctx->hmac_ctx;
 	uint32_t offset = param->auth_range.offset;
 	uint32_t len   = param->auth_range.length;
 
@@ -603,7 +758,7 @@ odp_crypto_alg_err_t auth_hmac_check(odp_packet_t pkt,
 static void
 auth_cmac_init(odp_crypto_generic_session_t *session)
 {
-	CMAC_CTX *ctx = local.cmac_ctx[session->idx];
+	CMAC_CTX *ctx = local.ctx->cmac_ctx;
 
 	CMAC_Init(ctx,
 		  session->auth.key,
@@ -615,10 +770,10 @@ auth_cmac_init(odp_crypto_generic_session_t *session)
 static
 void packet_cmac(odp_packet_t pkt,
 		 const odp_crypto_packet_op_param_t *param,
-		 odp_crypto_generic_session_t *session,
+		 odp_crypto_generic_session_t *session ODP_UNUSED,
 		 uint8_t *hash)
 {
-	CMAC_CTX *ctx = local.cmac_ctx[session->idx];
+	CMAC_CTX *ctx = local.ctx->cmac_ctx;
 	uint32_t offset = param->auth_range.offset;
 	uint32_t len   = param->auth_range.length;
 	size_t outlen;
@@ -693,7 +848,7 @@ int packet_cmac_eia2(odp_packet_t pkt,
 		     odp_crypto_generic_session_t *session,
 		     uint8_t *hash)
 {
-	CMAC_CTX *ctx = local.cmac_ctx[session->idx];
+	CMAC_CTX *ctx = local.ctx->cmac_ctx;
 	void *iv_ptr;
 	uint32_t offset = param->auth_range.offset;
 	uint32_t len   = (param->auth_range.length + 7) / 8;
@@ -789,7 +944,7 @@ void packet_digest(odp_packet_t pkt,
 		   odp_crypto_generic_session_t *session,
 		   uint8_t *hash)
 {
-	EVP_MD_CTX *ctx = local.md_ctx[session->idx];
+	EVP_MD_CTX *ctx = local.ctx->md_ctx;
 	uint32_t offset = param->auth_range.offset;
 	uint32_t len   = param->auth_range.length;
 
@@ -1013,7 +1168,7 @@ int internal_decrypt(EVP_CIPHER_CTX *ctx,
 static void
 cipher_encrypt_init(odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->cipher_ctx;
 
 	EVP_EncryptInit_ex(ctx, session->cipher.evp_cipher, NULL,
 			   session->cipher.key_data, NULL);
@@ -1025,7 +1180,7 @@ odp_crypto_alg_err_t cipher_encrypt(odp_packet_t pkt,
 				    const odp_crypto_packet_op_param_t *param,
 				    odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->cipher_ctx;
 	void *iv_ptr;
 	int ret;
 
@@ -1047,7 +1202,7 @@ odp_crypto_alg_err_t cipher_encrypt(odp_packet_t pkt,
 static void
 cipher_decrypt_init(odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->cipher_ctx;
 
 	EVP_DecryptInit_ex(ctx, session->cipher.evp_cipher, NULL,
 			   session->cipher.key_data, NULL);
@@ -1059,7 +1214,7 @@ odp_crypto_alg_err_t cipher_decrypt(odp_packet_t pkt,
 				    const odp_crypto_packet_op_param_t *param,
 				    odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->cipher_ctx;
 	void *iv_ptr;
 	int ret;
 
@@ -1114,7 +1269,7 @@ odp_crypto_alg_err_t cipher_encrypt_bits(odp_packet_t pkt,
 							*param,
 					 odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->cipher_ctx;
 	void *iv_ptr;
 	int dummy_len = 0;
 	int cipher_len;
@@ -1152,7 +1307,7 @@ odp_crypto_alg_err_t cipher_decrypt_bits(odp_packet_t pkt,
 							*param,
 					 odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->cipher_ctx;
 	void *iv_ptr;
 	int dummy_len = 0;
 	int cipher_len;
@@ -1217,7 +1372,7 @@ static int process_cipher_param_bits(odp_crypto_generic_session_t *session,
 static void
 aes_gcm_encrypt_init(odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->cipher_ctx;
 
 	EVP_EncryptInit_ex(ctx, session->cipher.evp_cipher, NULL,
 			   session->cipher.key_data, NULL);
@@ -1231,7 +1386,7 @@ odp_crypto_alg_err_t aes_gcm_encrypt(odp_packet_t pkt,
 				     const odp_crypto_packet_op_param_t *param,
 				     odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->cipher_ctx;
 	const uint8_t *aad_head = param->aad_ptr;
 	uint32_t aad_len = session->p.auth_aad_len;
 	void *iv_ptr;
@@ -1267,7 +1422,7 @@ odp_crypto_alg_err_t aes_gcm_encrypt(odp_packet_t pkt,
 static void
 aes_gcm_decrypt_init(odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->cipher_ctx;
 
 	EVP_DecryptInit_ex(ctx, session->cipher.evp_cipher, NULL,
 			   session->cipher.key_data, NULL);
@@ -1281,7 +1436,7 @@ odp_crypto_alg_err_t aes_gcm_decrypt(odp_packet_t pkt,
 				     const odp_crypto_packet_op_param_t *param,
 				     odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->cipher_ctx;
 	const uint8_t *aad_head = param->aad_ptr;
 	uint32_t aad_len = session->p.auth_aad_len;
 	int dummy_len = 0;
@@ -1346,7 +1501,7 @@ static int process_aes_gcm_param(odp_crypto_generic_session_t *session,
 static void
 aes_gmac_gen_init(odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.mac_cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->mac_cipher_ctx;
 
 	EVP_EncryptInit_ex(ctx, session->auth.evp_cipher, NULL,
 			   session->auth.key, NULL);
@@ -1360,7 +1515,7 @@ odp_crypto_alg_err_t aes_gmac_gen(odp_packet_t pkt,
 				  const odp_crypto_packet_op_param_t *param,
 				  odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.mac_cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->mac_cipher_ctx;
 	void *iv_ptr;
 	uint8_t block[EVP_MAX_MD_SIZE];
 	int ret;
@@ -1388,7 +1543,7 @@ odp_crypto_alg_err_t aes_gmac_gen(odp_packet_t pkt,
 static void
 aes_gmac_check_init(odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.mac_cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->mac_cipher_ctx;
 
 	EVP_DecryptInit_ex(ctx, session->auth.evp_cipher, NULL,
 			   session->auth.key, NULL);
@@ -1402,7 +1557,7 @@ odp_crypto_alg_err_t aes_gmac_check(odp_packet_t pkt,
 				    const odp_crypto_packet_op_param_t *param,
 				    odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.mac_cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->mac_cipher_ctx;
 	void *iv_ptr;
 	uint8_t block[EVP_MAX_MD_SIZE];
 	int ret;
@@ -1461,7 +1616,7 @@ static int process_aes_gmac_param(odp_crypto_generic_session_t *session,
 static void
 aes_ccm_encrypt_init(odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->cipher_ctx;
 
 	EVP_EncryptInit_ex(ctx, session->cipher.evp_cipher, NULL,
 			   NULL, NULL);
@@ -1475,7 +1630,7 @@ odp_crypto_alg_err_t aes_ccm_encrypt(odp_packet_t pkt,
 				     const odp_crypto_packet_op_param_t *param,
 				     odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->cipher_ctx;
 	const uint8_t *aad_head = param->aad_ptr;
 	uint32_t aad_len = session->p.auth_aad_len;
 	void *iv_ptr;
@@ -1528,7 +1683,7 @@ odp_crypto_alg_err_t aes_ccm_encrypt(odp_packet_t pkt,
 static void
 aes_ccm_decrypt_init(odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->cipher_ctx;
 
 	EVP_DecryptInit_ex(ctx, session->cipher.evp_cipher, NULL,
 			   session->cipher.key_data, NULL);
@@ -1542,7 +1697,7 @@ odp_crypto_alg_err_t aes_ccm_decrypt(odp_packet_t pkt,
 				     const odp_crypto_packet_op_param_t *param,
 				     odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->cipher_ctx;
 	const uint8_t *aad_head = param->aad_ptr;
 	uint32_t aad_len = session->p.auth_aad_len;
 	void *iv_ptr;
@@ -1624,7 +1779,7 @@ odp_crypto_alg_err_t xts_encrypt(odp_packet_t pkt,
 				 const odp_crypto_packet_op_param_t *param,
 				 odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->cipher_ctx;
 	void *iv_ptr;
 	int dummy_len = 0;
 	int cipher_len;
@@ -1661,7 +1816,7 @@ odp_crypto_alg_err_t xts_decrypt(odp_packet_t pkt,
 				 const odp_crypto_packet_op_param_t *param,
 				 odp_crypto_generic_session_t *session)
 {
-	EVP_CIPHER_CTX *ctx = local.cipher_ctx[session->idx];
+	EVP_CIPHER_CTX *ctx = local.ctx->cipher_ctx;
 	void *iv_ptr;
 	int dummy_len = 0;
 	int cipher_len;
@@ -1897,7 +2052,7 @@ int odp_crypto_capability(odp_crypto_capability_t *capa)
 	capa->auths.bit.aes128_gcm   = 1;
 #endif
 
-	capa->max_sessions = MAX_SESSIONS;
+	capa->max_sessions = global->max_sessions;
 
 	return 0;
 }
@@ -2115,6 +2270,14 @@ odp_crypto_session_create(const odp_crypto_session_param_t *param,
 		goto err;
 	}
 
+	/* Engine copies AAD of asynchronous operations */
+	if (engine && param->op_mode == ODP_CRYPTO_ASYNC &&
+	    session->p.auth_aad_len > ENGINE_MAX_AAD_LEN) {
+		ODP_DBG("Maximum AAD length exceeded\n");
+		*status = ODP_CRYPTO_SES_CREATE_ERR_INV_AUTH;
+		goto err;
+	}
+
 	/* Copy IV data */
 	if (session->p.cipher_iv.data)
 		memcpy(session->cipher.iv_data, session->p.cipher_iv.data,
@@ -2429,9 +2592,15 @@ err:
 int odp_crypto_session_destroy(odp_crypto_session_t session)
 {
 	odp_crypto_generic_session_t *generic;
+	unsigned idx;
+	uint32_t gen;
 
 	generic = (odp_crypto_generic_session_t *)(intptr_t)session;
+	idx = generic->idx;
+	gen = generic->gen;
 	memset(generic, 0, sizeof(*generic));
+	generic->idx = idx;
+	generic->gen = gen;
 	free_session(generic);
 	return 0;
 }
@@ -2507,9 +2676,11 @@ static void ODP_UNUSED openssl_lock(int mode, int n,
 
 int _odp_crypto_init_global(void)
 {
-	size_t mem_size;
+	size_t mem_size, session_offset, ring_offset;
 	odp_shm_t shm;
-	int idx;
+	const char *str;
+	uint32_t max_sessions, ring_size;
+	int idx, val;
 	int nlocks = CRYPTO_num_locks();
 
 	if (odp_global_ro.disable.crypto) {
@@ -2517,9 +2688,28 @@ int _odp_crypto_init_global(void)
 		return 0;
 	}
 
+	str = "crypto.max_num_sessions";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+	if (val < 1 || val > MAX_SESSIONS) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+	max_sessions = val;
+	/* Ring must be larger than the number of sessions */
+	ring_size = ROUNDUP_POWER2_U32(max_sessions + 1);
+
 	/* Calculate the memory size we need */
 	mem_size  = sizeof(odp_crypto_global_t);
 	mem_size += nlocks * sizeof(odp_ticketlock_t);
+	mem_size  = ROUNDUP_CACHE_LINE(mem_size);
+	session_offset = mem_size;
+	mem_size += ROUNDUP_CACHE_LINE(max_sessions *
+				       sizeof(odp_crypto_generic_session_t));
+	ring_offset = mem_size;
+	mem_size += sizeof(ring_u32_t) + ring_size * sizeof(uint32_t);
 
 	/* Allocate our globally shared memory */
 	shm = odp_shm_reserve("_odp_crypto_pool_ssl", mem_size,
@@ -2535,12 +2725,17 @@ int _odp_crypto_init_global(void)
 	/* Clear it out */
 	memset(global, 0, mem_size);
 
-	/* Initialize free list and lock */
-	for (idx = 0; idx < MAX_SESSIONS; idx++) {
-		global->sessions[idx].next = global->free;
-		global->free = &global->sessions[idx];
-	}
-	odp_spinlock_init(&global->lock);
+	global->sessions = (odp_crypto_generic_session_t *)
+			   ((uintptr_t)global + session_offset);
+	global->free_ring = (ring_u32_t *)((uintptr_t)global + ring_offset);
+	global->ring_mask = ring_size - 1;
+	global->max_sessions = max_sessions;
+	odp_atomic_init_u32(&global->num_sessions, 0);
+
+	/* Initialize session free list */
+	ring_u32_init(global->free_ring);
+	for (idx = 0; idx < (int)max_sessions; idx++)
+		ring_u32_enq(global->free_ring, global->ring_mask, idx);
 
 	if (nlocks > 0) {
 		for (idx = 0; idx < nlocks; idx++)
@@ -2552,6 +2747,11 @@ int _odp_crypto_init_global(void)
 #endif
 	}
 
+	if (engine_init_global()) {
+		odp_shm_free(shm);
+		return -1;
+	}
+
 	return 0;
 }
 
@@ -2559,15 +2759,14 @@ int _odp_crypto_term_global(void)
 {
 	int rc = 0;
 	int ret;
-	int count = 0;
-	odp_crypto_generic_session_t *session;
 
 	if (odp_global_ro.disable.crypto)
 		return 0;
 
-	for (session = global->free; session != NULL; session = session->next)
-		count++;
-	if (count != MAX_SESSIONS) {
+	if (engine_term_global())
+		rc = -1;
+
+	if (odp_atomic_load_u32(&global->num_sessions)) {
 		ODP_ERR("crypto sessions still active\n");
 		rc = -1;
 	}
@@ -2586,59 +2785,51 @@ int _odp_crypto_term_global(void)
 	return rc;
 }
 
-int _odp_crypto_init_local(void)
+static void crypto_local_term(void)
 {
-	unsigned i;
-	int id;
+	int i;
 
-	memset(&local, 0, sizeof(local));
+	if (local.cache == NULL)
+		return;
 
-	if (odp_global_ro.disable.crypto)
-		return 0;
+	for (i = 0; i < CTX_CACHE_SETS * CTX_CACHE_WAYS; i++)
+		crypto_ctx_free(&local.cache[i]);
 
-	for (i = 0; i < MAX_SESSIONS; i++) {
-		local.hmac_ctx[i] = HMAC_CTX_new();
-		local.cmac_ctx[i] = CMAC_CTX_new();
-		local.cipher_ctx[i] = EVP_CIPHER_CTX_new();
-		local.mac_cipher_ctx[i] = EVP_CIPHER_CTX_new();
-		local.md_ctx[i] = EVP_MD_CTX_new();
-
-		if (local.hmac_ctx[i] == NULL ||
-		    local.cmac_ctx[i] == NULL ||
-		    local.md_ctx[i] == NULL ||
-		    local.cipher_ctx[i] == NULL ||
-		    local.mac_cipher_ctx[i] == NULL) {
-			_odp_crypto_term_local();
-			return -1;
-		}
-	}
+	free(local.cache);
+	local.cache = NULL;
+}
 
-	id = odp_thread_id();
-	local.ctx_valid = global->ctx_valid[id];
-	/* No need to clear flags here, alloc_session did the job for us */
+static int crypto_local_init(void)
+{
+	memset(&local, 0, sizeof(local));
+
+	/* Contexts are created on first use */
+	local.cache = calloc(CTX_CACHE_SETS * CTX_CACHE_WAYS,
+			     sizeof(crypto_ctx_t));
+	if (local.cache == NULL) {
+		ODP_ERR("Crypto context cache alloc failed\n");
+		return -1;
+	}
 
 	return 0;
 }
 
-int _odp_crypto_term_local(void)
+int _odp_crypto_init_local(void)
 {
-	unsigned i;
+	if (odp_global_ro.disable.crypto) {
+		memset(&local, 0, sizeof(local));
+		return 0;
+	}
 
+	return crypto_local_init();
+}
+
+int _odp_crypto_term_local(void)
+{
 	if (odp_global_ro.disable.crypto)
 		return 0;
 
-	for (i = 0; i < MAX_SESSIONS; i++) {
-		if (local.cmac_ctx[i] != NULL)
-			CMAC_CTX_free(local.cmac_ctx[i]);
-		if (local.hmac_ctx[i] != NULL)
-			HMAC_CTX_free(local.hmac_ctx[i]);
-		if (local.cipher_ctx[i] != NULL)
-			EVP_CIPHER_CTX_free(local.cipher_ctx[i]);
-		if (local.mac_cipher_ctx[i] != NULL)
-			EVP_CIPHER_CTX_free(local.mac_cipher_ctx[i]);
-		if (local.md_ctx[i] != NULL)
-			EVP_MD_CTX_free(local.md_ctx[i]);
-	}
+	crypto_local_term();
 
 	return 0;
 }
@@ -2727,20 +2918,13 @@ int odp_crypto_result(odp_crypto_packet_result_t *result,
 	return 0;
 }
 
-static
-int crypto_int(odp_packet_t pkt_in,
-	       odp_packet_t *pkt_out,
-	       const odp_crypto_packet_op_param_t *param)
+/* Resolve output packet and copy input packet into it when needed */
+static int crypto_pkt_out(odp_packet_t pkt_in,
+			  odp_packet_t *pkt_out,
+			  odp_crypto_generic_session_t *session)
 {
-	odp_crypto_alg_err_t rc_cipher = ODP_CRYPTO_ALG_ERR_NONE;
-	odp_crypto_alg_err_t rc_auth = ODP_CRYPTO_ALG_ERR_NONE;
-	odp_crypto_generic_session_t *session;
 	odp_bool_t allocated = false;
 	odp_packet_t out_pkt = *pkt_out;
-	odp_crypto_packet_result_t *op_result;
-	odp_packet_hdr_t *pkt_hdr;
-
-	session = (odp_crypto_generic_session_t *)(intptr_t)param->session;
 
 	/* Resolve output buffer */
 	if (ODP_PACKET_INVALID == out_pkt &&
@@ -2771,10 +2955,35 @@ int crypto_int(odp_packet_t pkt_in,
 		pkt_in = ODP_PACKET_INVALID;
 	}
 
-	crypto_init(session);
+	*pkt_out = out_pkt;
+
+	return 0;
+
+err:
+	if (allocated) {
+		odp_packet_free(out_pkt);
+		*pkt_out = ODP_PACKET_INVALID;
+	}
+
+	return -1;
+}
+
+/* Process operation on the output packet and fill in the result */
+static void crypto_pkt_process(odp_packet_t out_pkt,
+			       const odp_crypto_packet_op_param_t *param,
+			       odp_crypto_generic_session_t *session)
+{
+	odp_crypto_alg_err_t rc_cipher = ODP_CRYPTO_ALG_ERR_NONE;
+	odp_crypto_alg_err_t rc_auth = ODP_CRYPTO_ALG_ERR_NONE;
+	odp_crypto_hw_err_t hw_err = ODP_CRYPTO_HW_ERR_NONE;
+	odp_crypto_packet_result_t *op_result;
+	odp_packet_hdr_t *pkt_hdr;
 
-	/* Invoke the functions */
-	if (session->do_cipher_first) {
+	if (odp_unlikely(crypto_init(session))) {
+		/* Out of memory for OpenSSL contexts */
+		hw_err = ODP_CRYPTO_HW_ERR_BP_DEPLETED;
+	} else if (session->do_cipher_first) {
+		/* Invoke the functions */
 		rc_cipher = session->cipher.func(out_pkt, param, session);
 		rc_auth = session->auth.func(out_pkt, param, session);
 	} else {
@@ -2786,28 +2995,34 @@ int crypto_int(odp_packet_t pkt_in,
 	packet_subtype_set(out_pkt, ODP_EVENT_PACKET_CRYPTO);
 	op_result = get_op_result_from_packet(out_pkt);
 	op_result->cipher_status.alg_err = rc_cipher;
-	op_result->cipher_status.hw_err = ODP_CRYPTO_HW_ERR_NONE;
+	op_result->cipher_status.hw_err = hw_err;
 	op_result->auth_status.alg_err = rc_auth;
-	op_result->auth_status.hw_err = ODP_CRYPTO_HW_ERR_NONE;
+	op_result->auth_status.hw_err = hw_err;
 	op_result->ok =
 		(rc_cipher == ODP_CRYPTO_ALG_ERR_NONE) &&
-		(rc_auth == ODP_CRYPTO_ALG_ERR_NONE);
+		(rc_auth == ODP_CRYPTO_ALG_ERR_NONE) &&
+		(hw_err == ODP_CRYPTO_HW_ERR_NONE);
 
 	pkt_hdr = packet_hdr(out_pkt);
 	pkt_hdr->p.flags.crypto_err = !op_result->ok;
+}
 
-	/* Synchronous, simply return results */
-	*pkt_out = out_pkt;
+static
+int crypto_int(odp_packet_t pkt_in,
+	       odp_packet_t *pkt_out,
+	       const odp_crypto_packet_op_param_t *param)
+{
+	odp_crypto_generic_session_t *session;
 
-	return 0;
+	session = (odp_crypto_generic_session_t *)(intptr_t)param->session;
 
-err:
-	if (allocated) {
-		odp_packet_free(out_pkt);
-		*pkt_out = ODP_PACKET_INVALID;
-	}
+	if (odp_unlikely(crypto_pkt_out(pkt_in, pkt_out, session)))
+		return -1;
 
-	return -1;
+	crypto_pkt_process(*pkt_out, param, session);
+
+	/* Synchronous, simply return results */
+	return 0;
 }
 
 int odp_crypto_op(const odp_packet_t pkt_in[],
@@ -2830,6 +3045,200 @@ int odp_crypto_op(const odp_packet_t pkt_in[],
 	return i;
 }
 
+/* Enqueue completion events. Events of consecutive operations with the same
+ * completion queue are enqueued together. */
+static void engine_compl_multi(engine_worker_t *worker, engine_op_t *op[],
+			       int num)
+{
+	odp_event_t event[ENGINE_MAX_BURST];
+	odp_queue_t queue;
+	int i, j, n, ret;
+
+	for (i = 0; i < num; i += n) {
+		queue = op[i]->session->p.compl_queue;
+
+		for (n = 0; i + n < num; n++) {
+			if (op[i + n]->session->p.compl_queue != queue)
+				break;
+
+			event[n] = odp_packet_to_event(op[i + n]->pkt);
+		}
+
+		ret = odp_queue_enq_multi(queue, event, n);
+		if (odp_unlikely(ret < 0))
+			ret = 0;
+
+		if (odp_unlikely(ret < n)) {
+			for (j = ret; j < n; j++)
+				odp_event_free(event[j]);
+
+			odp_atomic_add_u64(&worker->dropped, n - ret);
+		}
+	}
+}
+
+/* Process a burst of operations. Operations are grouped per session, while
+ * preserving order of operations within each session. */
+static int engine_process(engine_worker_t *worker)
+{
+	uint32_t idx[ENGINE_MAX_BURST];
+	engine_op_t *op[ENGINE_MAX_BURST];
+	uint8_t done[ENGINE_MAX_BURST];
+	odp_crypto_generic_session_t *session;
+	int i, j, num, num_op;
+
+	num = ring_u32_deq_multi(worker->submit_ring, engine->ring_mask, idx,
+				 engine->burst_size);
+	if (num == 0)
+		return 0;
+
+	memset(done, 0, num);
+	num_op = 0;
+
+	for (i = 0; i < num; i++) {
+		if (done[i])
+			continue;
+
+		session = worker->op[idx[i]].session;
+
+		for (j = i; j < num; j++) {
+			engine_op_t *cur = &worker->op[idx[j]];
+
+			if (done[j] || cur->session != session)
+				continue;
+
+			crypto_pkt_process(cur->pkt, &cur->param, session);
+			op[num_op++] = cur;
+			done[j] = 1;
+		}
+	}
+
+	engine_compl_multi(worker, op, num_op);
+
+	ring_u32_enq_multi(worker->free_ring, engine->ring_mask, idx, num);
+
+	return num;
+}
+
+static void *engine_worker_run(void *arg)
+{
+	engine_worker_t *worker = arg;
+	struct timespec ts;
+	int idle = 0;
+
+	if (crypto_local_init()) {
+		ODP_ERR("Crypto engine worker %i: context init failed\n",
+			worker->idx);
+		return NULL;
+	}
+
+	ts.tv_sec  = engine->idle_sleep_ns / ODP_TIME_SEC_IN_NS;
+	ts.tv_nsec = engine->idle_sleep_ns % ODP_TIME_SEC_IN_NS;
+
+	while (odp_atomic_load_acq_u32(&engine->stop) == 0) {
+		if (engine_process(worker)) {
+			idle = 0;
+			continue;
+		}
+
+		/* Busy poll a while before sleeping */
+		if (engine->idle_sleep_ns && ++idle > 1000)
+			nanosleep(&ts, NULL);
+		else
+			odp_cpu_pause();
+	}
+
+	/* Complete operations submitted before termination */
+	while (engine_process(worker))
+		;
+
+	crypto_local_term();
+
+	return NULL;
+}
+
+/* Copy operation into an engine slot. Pointers in operation parameters refer
+ * to application memory that may not be valid after odp_crypto_op_enq()
+ * returns. Lengths have been checked at session creation. */
+static inline void engine_op_fill(engine_op_t *op,
+				  odp_crypto_generic_session_t *session,
+				  const odp_crypto_packet_op_param_t *param)
+{
+	op->session = session;
+	op->param = *param;
+
+	if (param->cipher_iv_ptr) {
+		memcpy(op->cipher_iv, param->cipher_iv_ptr,
+		       session->p.cipher_iv.length);
+		op->param.cipher_iv_ptr = op->cipher_iv;
+	}
+
+	if (param->auth_iv_ptr) {
+		memcpy(op->auth_iv, param->auth_iv_ptr,
+		       session->p.auth_iv.length);
+		op->param.auth_iv_ptr = op->auth_iv;
+	}
+
+	if (param->aad_ptr) {
+		memcpy(op->aad, param->aad_ptr, session->p.auth_aad_len);
+		op->param.aad_ptr = op->aad;
+	}
+}
+
+/* Submit operations to engine workers. Operations of a session are always
+ * processed by the same worker. */
+static int engine_op_enq(const odp_packet_t pkt_in[],
+			 const odp_packet_t pkt_out[],
+			 const odp_crypto_packet_op_param_t param[],
+			 int num_pkt)
+{
+	uint32_t idx[ENGINE_MAX_BURST];
+	engine_worker_t *worker = NULL;
+	engine_worker_t *cur;
+	odp_crypto_generic_session_t *session;
+	engine_op_t *op;
+	odp_packet_t pkt;
+	uint32_t mask = engine->ring_mask;
+	int num = 0;
+	int i;
+
+	for (i = 0; i < num_pkt; i++) {
+		session = (odp_crypto_generic_session_t *)(intptr_t)param[i].session;
+		ODP_ASSERT(ODP_CRYPTO_ASYNC == session->p.op_mode);
+		ODP_ASSERT(ODP_QUEUE_INVALID != session->p.compl_queue);
+
+		cur = &engine->worker[session->idx % engine->num_workers];
+
+		if (worker != cur || num == ENGINE_MAX_BURST) {
+			if (num)
+				ring_u32_enq_multi(worker->submit_ring, mask,
+						   idx, num);
+			worker = cur;
+			num = 0;
+		}
+
+		if (odp_unlikely(ring_u32_deq(worker->free_ring, mask,
+					      &idx[num]) == 0))
+			break;
+
+		pkt = pkt_out[i];
+		if (odp_unlikely(crypto_pkt_out(pkt_in[i], &pkt, session))) {
+			ring_u32_enq(worker->free_ring, mask, idx[num]);
+			break;
+		}
+
+		op = &worker->op[idx[num]];
+		engine_op_fill(op, session, &param[i]);
+		op->pkt = pkt;
+		num++;
+	}
+
+	if (num)
+		ring_u32_enq_multi(worker->submit_ring, mask, idx, num);
+
+	return i;
+}
+
 int odp_crypto_op_enq(const odp_packet_t pkt_in[],
 		      const odp_packet_t pkt_out[],
 		      const odp_crypto_packet_op_param_t param[],
@@ -2840,6 +3249,9 @@ int odp_crypto_op_enq(const odp_packet_t pkt_in[],
 	odp_crypto_generic_session_t *session;
 	int i, rc;
 
+	if (engine)
+		return engine_op_enq(pkt_in, pkt_out, param, num_pkt);
+
 	for (i = 0; i < num_pkt; i++) {
 		session = (odp_crypto_generic_session_t *)(intptr_t)param[i].session;
 		ODP_ASSERT(ODP_CRYPTO_ASYNC == session->p.op_mode);
@@ -2859,3 +3271,229 @@ int odp_crypto_op_enq(const odp_packet_t pkt_in[],
 
 	return i;
 }
+
+static int engine_read_config(crypto_engine_t *cfg)
+{
+	const char *str;
+	int val;
+
+	str = "crypto.engine.num_workers";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+	if (val < 1 || val > ENGINE_MAX_WORKERS) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+	cfg->num_workers = val;
+
+	str = "crypto.engine.cpu";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+	if (val < -1) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+	cfg->cpu = val;
+
+	str = "crypto.engine.queue_size";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+	if (val < 1 || val > ENGINE_MAX_QUEUE_SIZE ||
+	    !CHECK_IS_POWER2(val)) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+	/* Rings are larger than the number of slots stored into them */
+	cfg->ring_mask = (2 * val) - 1;
+
+	str = "crypto.engine.burst_size";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+	if (val < 1 || val > ENGINE_MAX_BURST) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+	cfg->burst_size = val;
+
+	str = "crypto.engine.idle_sleep_ns";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+	if (val < 0) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+	cfg->idle_sleep_ns = val;
+
+	return 0;
+}
+
+static int engine_start(engine_worker_t *worker)
+{
+	pthread_attr_t attr;
+	cpu_set_t cpu_set;
+	int ret;
+
+	if (pthread_attr_init(&attr))
+		return -1;
+
+	if (engine->cpu >= 0) {
+		CPU_ZERO(&cpu_set);
+		CPU_SET(engine->cpu + worker->idx, &cpu_set);
+
+		if (pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t),
+						&cpu_set)) {
+			ODP_ERR("Crypto engine worker %i: bad CPU %i\n",
+				worker->idx, engine->cpu + worker->idx);
+			pthread_attr_destroy(&attr);
+			return -1;
+		}
+	}
+
+	ret = pthread_create(&worker->thread, &attr, engine_worker_run,
+			     worker);
+	pthread_attr_destroy(&attr);
+
+	if (ret) {
+		ODP_ERR("Crypto engine worker %i: thread create failed: %s\n",
+			worker->idx, strerror(ret));
+		return -1;
+	}
+
+	worker->started = 1;
+
+	return 0;
+}
+
+static int engine_init_global(void)
+{
+	crypto_engine_t cfg;
+	engine_worker_t *worker;
+	const char *str;
+	odp_shm_t shm;
+	uint8_t *addr;
+	uint32_t num_op, ring_size, i, j;
+	uint64_t op_size, ring_bytes, worker_size, mem_size;
+	int val;
+
+	str = "crypto.engine.enable";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+
+	if (val == 0)
+		return 0;
+
+	if (odp_global_ro.init_param.mem_model == ODP_MEM_MODEL_PROCESS) {
+		ODP_ERR("Crypto engine is not supported in process mode\n");
+		return -1;
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	if (engine_read_config(&cfg))
+		return -1;
+
+	ring_size   = cfg.ring_mask + 1;
+	num_op      = ring_size / 2;
+	op_size     = ROUNDUP_CACHE_LINE(num_op * sizeof(engine_op_t));
+	ring_bytes  = ROUNDUP_CACHE_LINE(sizeof(ring_u32_t) +
+					 ring_size * sizeof(uint32_t));
+	worker_size = op_size + 2 * ring_bytes;
+	mem_size    = ROUNDUP_CACHE_LINE(sizeof(crypto_engine_t)) +
+		      cfg.num_workers * worker_size;
+
+	shm = odp_shm_reserve("_odp_crypto_engine", mem_size,
+			      ODP_CACHE_LINE_SIZE, 0);
+	if (shm == ODP_SHM_INVALID) {
+		ODP_ERR("Crypto engine shm reserve failed\n");
+		return -1;
+	}
+
+	addr = odp_shm_addr(shm);
+	engine = (crypto_engine_t *)(uintptr_t)addr;
+	*engine = cfg;
+	engine->shm = shm;
+	odp_atomic_init_u32(&engine->stop, 0);
+
+	addr += ROUNDUP_CACHE_LINE(sizeof(crypto_engine_t));
+
+	for (i = 0; i < engine->num_workers; i++) {
+		worker = &engine->worker[i];
+		worker->idx = i;
+		odp_atomic_init_u64(&worker->dropped, 0);
+
+		worker->op = (engine_op_t *)(uintptr_t)addr;
+		addr += op_size;
+		worker->free_ring = (ring_u32_t *)(uintptr_t)addr;
+		addr += ring_bytes;
+		worker->submit_ring = (ring_u32_t *)(uintptr_t)addr;
+		addr += ring_bytes;
+
+		ring_u32_init(worker->free_ring);
+		ring_u32_init(worker->submit_ring);
+
+		for (j = 0; j < num_op; j++)
+			ring_u32_enq(worker->free_ring, engine->ring_mask, j);
+	}
+
+	for (i = 0; i < engine->num_workers; i++) {
+		if (engine_start(&engine->worker[i])) {
+			engine_term_global();
+			return -1;
+		}
+	}
+
+	ODP_DBG("Crypto engine: %u workers, queue size %u\n",
+		engine->num_workers, num_op);
+
+	return 0;
+}
+
+static int engine_term_global(void)
+{
+	engine_worker_t *worker;
+	uint64_t dropped;
+	uint32_t i;
+	int rc = 0;
+
+	if (engine == NULL)
+		return 0;
+
+	odp_atomic_store_rel_u32(&engine->stop, 1);
+
+	for (i = 0; i < engine->num_workers; i++) {
+		worker = &engine->worker[i];
+
+		if (!worker->started)
+			continue;
+
+		if (pthread_join(worker->thread, NULL)) {
+			ODP_ERR("Crypto engine worker %u: join failed\n", i);
+			rc = -1;
+		}
+
+		dropped = odp_atomic_load_u64(&worker->dropped);
+		if (dropped)
+			ODP_DBG("Crypto engine worker %u: %" PRIu64 " completion "
+				"events dropped\n", i, dropped);
+	}
+
+	if (odp_shm_free(engine->shm)) {
+		ODP_ERR("Crypto engine shm free failed\n");
+		rc = -1;
+	}
+
+	engine = NULL;
+
+	return rc;
+}
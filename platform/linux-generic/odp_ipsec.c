@@ -48,9 +48,9 @@ int odp_ipsec_capability(odp_ipsec_capability_t *capa)
 
 	capa->proto_ah = ODP_SUPPORT_YES;
 
-	capa->max_num_sa = ODP_CONFIG_IPSEC_SAS;
+	capa->max_num_sa = _odp_ipsec_max_num_sa();
 
-	capa->max_antireplay_ws = IPSEC_ANTIREPLAY_WS;
+	capa->max_antireplay_ws = _odp_ipsec_max_antireplay_ws();
 
 	rc = odp_crypto_capability(&crypto_capa);
 	if (rc < 0)
@@ -144,7 +144,7 @@ void odp_ipsec_config_init(odp_ipsec_config_t *config)
 	memset(config, 0, sizeof(odp_ipsec_config_t));
 	config->inbound_mode = ODP_IPSEC_OP_MODE_SYNC;
 	config->outbound_mode = ODP_IPSEC_OP_MODE_SYNC;
-	config->max_num_sa = ODP_CONFIG_IPSEC_SAS;
+	config->max_num_sa = _odp_ipsec_max_num_sa();
 	config->inbound.default_queue = ODP_QUEUE_INVALID;
 	config->inbound.lookup.min_spi = 0;
 	config->inbound.lookup.max_spi = UINT32_MAX;
@@ -152,7 +152,7 @@ void odp_ipsec_config_init(odp_ipsec_config_t *config)
 
 int odp_ipsec_config(const odp_ipsec_config_t *config)
 {
-	if (ODP_CONFIG_IPSEC_SAS < config->max_num_sa)
+	if (_odp_ipsec_max_num_sa() < config->max_num_sa)
 		return -1;
 
 	*ipsec_config = *config;
@@ -228,7 +228,7 @@ typedef struct {
 		struct {
 			uint16_t hdr_len;
 			uint16_t trl_len;
-			odp_u32be_t seq_no;
+			uint64_t seq_no;
 		} in;
 		odp_u32be_t ipv4_addr;
 		uint8_t ipv6_addr[_ODP_IPV6ADDR_LEN];
@@ -247,9 +247,44 @@ typedef struct {
 			ipsec_aad_t aad;
 		} esp;
 	};
+	/* ESN high order bits and their offset in ICV input */
+	uint32_t seq_hi;
+	uint32_t seq_hi_offset;
 	uint8_t	iv[IPSEC_MAX_IV_LEN];
 } ipsec_state_t;
 
+/* Insert ESN high order bits into the packet for ICV calculation */
+static int ipsec_seq_hi_insert(odp_packet_t *pkt, ipsec_state_t *state)
+{
+	uint32_t len = odp_packet_len(*pkt);
+	uint32_t offset = state->seq_hi_offset;
+	odp_u32be_t seq_hi = odp_cpu_to_be_32(state->seq_hi);
+
+	if (odp_packet_extend_tail(pkt, IPSEC_SEQ_HI_LEN, NULL, NULL) < 0)
+		return -1;
+
+	if (offset < len)
+		odp_packet_move_data(*pkt, offset + IPSEC_SEQ_HI_LEN, offset,
+				     len - offset);
+
+	odp_packet_copy_from_mem(*pkt, offset, IPSEC_SEQ_HI_LEN, &seq_hi);
+
+	return 0;
+}
+
+/* Remove ESN high order bits inserted by ipsec_seq_hi_insert() */
+static int ipsec_seq_hi_remove(odp_packet_t *pkt, ipsec_state_t *state)
+{
+	uint32_t len = odp_packet_len(*pkt) - IPSEC_SEQ_HI_LEN;
+	uint32_t offset = state->seq_hi_offset;
+
+	if (offset < len)
+		odp_packet_move_data(*pkt, offset, offset + IPSEC_SEQ_HI_LEN,
+				     len - offset);
+
+	return odp_packet_trunc_tail(pkt, IPSEC_SEQ_HI_LEN, NULL, NULL);
+}
+
 static int ipsec_parse_ipv4(ipsec_state_t *state, odp_packet_t pkt)
 {
 	_odp_ipv4hdr_t ipv4hdr;
@@ -439,9 +474,13 @@ static int ipsec_in_esp(odp_packet_t *pkt,
 	param->cipher_iv_ptr = state->iv;
 	param->auth_iv_ptr = state->iv;
 
+	state->in.seq_no = _odp_ipsec_sa_in_seq(ipsec_sa,
+						odp_be_to_cpu_32(esp.seq_no));
 	state->esp.aad.spi = esp.spi;
-	state->esp.aad.seq_no = esp.seq_no;
-	state->in.seq_no = odp_be_to_cpu_32(esp.seq_no);
+	if (ipsec_sa->esn)
+		state->esp.aad.esn = odp_cpu_to_be_64(state->in.seq_no);
+	else
+		state->esp.aad.seq_no = esp.seq_no;
 
 	param->aad_ptr = (uint8_t *)&state->esp.aad;
 
@@ -453,6 +492,10 @@ static int ipsec_in_esp(odp_packet_t *pkt,
 				   state->ip_tot_len -
 				   ipsec_sa->icv_len;
 
+	/* ESN high order bits go between ESP trailer and ICV */
+	state->seq_hi = state->in.seq_no >> 32;
+	state->seq_hi_offset = param->hash_result_offset;
+
 	state->stats_length = param->cipher_range.length;
 
 	return 0;
@@ -551,13 +594,18 @@ static int ipsec_in_ah(odp_packet_t *pkt,
 		ipv6hdr->hop_limit = 0;
 	}
 
-	state->in.seq_no = odp_be_to_cpu_32(ah.seq_no);
+	state->in.seq_no = _odp_ipsec_sa_in_seq(ipsec_sa,
+						odp_be_to_cpu_32(ah.seq_no));
 
 	param->auth_range.offset = state->ip_offset;
 	param->auth_range.length = state->ip_tot_len;
 	param->hash_result_offset = ipsec_offset + _ODP_AHHDR_LEN +
 				ipsec_sa->esp_iv_len;
 
+	/* ESN high order bits go after the IP packet */
+	state->seq_hi = state->in.seq_no >> 32;
+	state->seq_hi_offset = state->ip_offset + state->ip_tot_len;
+
 	state->stats_length = param->auth_range.length;
 
 	return 0;
@@ -659,7 +707,21 @@ static ipsec_sa_t *ipsec_in_single(odp_packet_t pkt,
 
 	param.session = ipsec_sa->session;
 
+	if (ipsec_sa->insert_seq_hi) {
+		if (ipsec_seq_hi_insert(&pkt, &state) < 0) {
+			status->error.alg = 1;
+			goto err;
+		}
+		param.auth_range.length += IPSEC_SEQ_HI_LEN;
+		if (param.hash_result_offset >= state.seq_hi_offset)
+			param.hash_result_offset += IPSEC_SEQ_HI_LEN;
+	}
+
 	rc = odp_crypto_op(&pkt, &pkt, &param, 1);
+
+	if (ipsec_sa->insert_seq_hi && ipsec_seq_hi_remove(&pkt, &state) < 0)
+		rc = -1;
+
 	if (rc < 0) {
 		ODP_DBG("Crypto failed\n");
 		status->error.alg = 1;
@@ -1107,9 +1169,13 @@ static int ipsec_out_esp(odp_packet_t *pkt,
 	esp.seq_no = odp_cpu_to_be_32(seq_no & 0xffffffff);
 
 	state->esp.aad.spi = esp.spi;
-	state->esp.aad.seq_no = esp.seq_no;
+	if (ipsec_sa->esn)
+		state->esp.aad.esn = odp_cpu_to_be_64(seq_no);
+	else
+		state->esp.aad.seq_no = esp.seq_no;
 
 	param->aad_ptr = (uint8_t *)&state->esp.aad;
+	state->seq_hi = seq_no >> 32;
 
 	memset(&esptrl, 0, sizeof(esptrl));
 	esptrl.pad_len = encrypt_len - ip_data_len - tfc_len - _ODP_ESPTRL_LEN;
@@ -1203,6 +1269,9 @@ static int ipsec_out_esp(odp_packet_t *pkt,
 				   state->ip_tot_len -
 				   ipsec_sa->icv_len;
 
+	/* ESN high order bits go between ESP trailer and ICV */
+	state->seq_hi_offset = param->hash_result_offset;
+
 	state->stats_length = param->cipher_range.length;
 
 	return 0;
@@ -1305,6 +1374,10 @@ static int ipsec_out_ah(odp_packet_t *pkt,
 	param->hash_result_offset = ipsec_offset + _ODP_AHHDR_LEN +
 				ipsec_sa->esp_iv_len;
 
+	/* ESN high order bits go after the IP packet */
+	state->seq_hi = seq_no >> 32;
+	state->seq_hi_offset = state->ip_offset + state->ip_tot_len;
+
 	state->stats_length = param->auth_range.length;
 
 	return 0;
@@ -1510,7 +1583,21 @@ static ipsec_sa_t *ipsec_out_single(odp_packet_t pkt,
 	 * the SA before this output routine returns (and all its side
 	 * effects are visible to the disabling thread).
 	 */
+	if (ipsec_sa->insert_seq_hi) {
+		if (ipsec_seq_hi_insert(&pkt, &state) < 0) {
+			status->error.alg = 1;
+			goto err;
+		}
+		param.auth_range.length += IPSEC_SEQ_HI_LEN;
+		if (param.hash_result_offset >= state.seq_hi_offset)
+			param.hash_result_offset += IPSEC_SEQ_HI_LEN;
+	}
+
 	rc = odp_crypto_op(&pkt, &pkt, &param, 1);
+
+	if (ipsec_sa->insert_seq_hi && ipsec_seq_hi_remove(&pkt, &state) < 0)
+		rc = -1;
+
 	if (rc < 0) {
 		ODP_DBG("Crypto failed\n");
 		status->error.alg = 1;
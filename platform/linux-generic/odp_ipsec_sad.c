@@ -5,14 +5,19 @@
  */
 
 #include <odp/api/atomic.h>
+#include <odp/api/hash.h>
 #include <odp/api/ipsec.h>
 #include <odp/api/random.h>
 #include <odp/api/shared_memory.h>
+#include <odp/api/spinlock.h>
 
+#include <odp_config_internal.h>
 #include <odp_init_internal.h>
 #include <odp_debug_internal.h>
 #include <odp_ipsec_internal.h>
+#include <odp_libconfig_internal.h>
 #include <odp_ring_mpmc_internal.h>
+#include <odp_ring_u32_internal.h>
 #include <odp_global_data.h>
 
 #include <odp/api/plat/atomic_inlines.h>
@@ -40,6 +45,23 @@
 #warning IPV4_ID_RING_SIZE is too small for the maximum number of threads.
 #endif
 
+/*
+ * Anti-replay window is a ring of 64-bit blocks. Each block covers
+ * AR_BLOCK_BITS consecutive sequence numbers: the upper 32 bits store the
+ * block number (seq / AR_BLOCK_BITS) and the lower 32 bits a bitmap of
+ * received sequence numbers of the block. Blocks are updated with CAS
+ * independently of each other, and the window top (hot.in.max_seq) is
+ * moved forward with CAS after a block update.
+ *
+ * A block is taken into use for a newer block number only when the old
+ * block has fallen out of the window. The ring has at least
+ * (max window size / AR_BLOCK_BITS + 1) blocks, so that blocks within the
+ * window never share a slot. A packet that finds its slot already reused by
+ * a newer block is outside of the window.
+ */
+#define AR_BLOCK_BITS  32
+#define AR_BLOCK_SHIFT 5
+
 /*
  * To avoid checking and updating the packet and byte counters in the
  * SA for every packet, we increment the global counters once for several
@@ -52,11 +74,26 @@
  * The warnings and errors may get triggered a bit too early since
  * some threads may still have unused quota when the first thread
  * hits the limit.
+ *
+ * Thread local quotas are stored in a direct mapped cache indexed by the
+ * SA index, so that memory usage does not grow with the number of SAs.
+ * When an SA is evicted from the cache, its unused quota is returned to
+ * the SA-global counters.
  */
 #define SA_LIFE_PACKETS_PREALLOC  64
 #define SA_LIFE_BYTES_PREALLOC    4000
 
+#define SA_THREAD_CACHE_SIZE 256 /* must be power of 2 */
+#define SA_THREAD_CACHE_MASK (SA_THREAD_CACHE_SIZE - 1)
+
 typedef struct sa_thread_local_s {
+	/* Index of the SA that currently owns this cache entry */
+	uint32_t sa_idx;
+	/*
+	 * Create sequence number of the owner SA. Zero marks an unused
+	 * entry, since SA create sequence numbers start from one.
+	 */
+	uint32_t sa_seq;
 	/*
 	 * Packets that can be processed in this thread before looking at
 	 * the SA-global packet counter and checking hard and soft limits.
@@ -75,18 +112,54 @@ typedef struct sa_thread_local_s {
 } sa_thread_local_t;
 
 typedef struct ODP_ALIGNED_CACHE ipsec_thread_local_s {
-	sa_thread_local_t sa[ODP_CONFIG_IPSEC_SAS];
+	sa_thread_local_t sa[SA_THREAD_CACHE_SIZE];
 	uint16_t first_ipv4_id; /* first ID of current block of IDs */
 	uint16_t next_ipv4_id;  /* next ID to be used */
 } ipsec_thread_local_t;
 
+/*
+ * SA lookup hash index
+ *
+ * Buckets store the index + 1 of the first SA in the hash chain, and SAs
+ * are linked through ipsec_sa_t::hash_next. Zero terminates a chain. An SA
+ * is linked into one index at most, depending on its lookup mode.
+ *
+ * Lookups walk the chains without locks. Writers serialize on hash_lock and
+ * publish new links with store-release. An SA is unlinked when destroyed,
+ * but its own link is left intact so that a concurrent reader can continue
+ * the walk. Destroyed SAs are reused only after all other free SAs (see
+ * free_ring), and each unlink increments hash_gen. A lookup that fails to
+ * find a match is retried if hash_gen changed during the walk, as an SA may
+ * have been reused and relinked into another chain under the reader.
+ */
+typedef struct sa_hash_t {
+	uint32_t mask;
+	odp_atomic_u32_t *bucket;
+} sa_hash_t;
+
 typedef struct ipsec_sa_table_t {
-	ipsec_sa_t ipsec_sa[ODP_CONFIG_IPSEC_SAS];
+	ipsec_sa_t *ipsec_sa;
+	uint32_t max_num_sa;
+	uint32_t max_antireplay_ws;
+	/* Number of anti-replay window blocks per SA - 1 */
+	uint32_t ar_block_mask;
 	ipsec_thread_local_t per_thread[ODP_THREAD_COUNT_MAX];
 	struct ODP_ALIGNED_CACHE {
 		ring_mpmc_t ipv4_id_ring;
 		uint32_t ipv4_id_data[IPV4_ID_RING_SIZE] ODP_ALIGNED_CACHE;
 	} hot;
+
+	/* Indexes of free SAs in FIFO order */
+	ring_u32_t *free_ring;
+	uint32_t free_ring_mask;
+
+	/* Lookup index for ODP_IPSEC_LOOKUP_DSTADDR_SPI SAs */
+	sa_hash_t hash_dst;
+	/* Lookup index for ODP_IPSEC_LOOKUP_SPI SAs */
+	sa_hash_t hash_spi;
+	odp_spinlock_t hash_lock;
+	odp_atomic_u32_t hash_gen ODP_ALIGNED_CACHE;
+
 	odp_shm_t shm;
 } ipsec_sa_table_t;
 
@@ -113,42 +186,247 @@ ipsec_sa_t *_odp_ipsec_sa_entry_from_hdl(odp_ipsec_sa_t sa)
 	return ipsec_sa_entry_from_hdl(sa);
 }
 
+uint32_t _odp_ipsec_max_num_sa(void)
+{
+	if (ipsec_sa_tbl == NULL)
+		return 0;
+
+	return ipsec_sa_tbl->max_num_sa;
+}
+
+uint32_t _odp_ipsec_max_antireplay_ws(void)
+{
+	if (ipsec_sa_tbl == NULL)
+		return 0;
+
+	return ipsec_sa_tbl->max_antireplay_ws;
+}
+
+/* Return unused quota of the cache entry to the SA-global counters */
+static void sa_thread_local_flush(sa_thread_local_t *sa_tl)
+{
+	ipsec_sa_t *ipsec_sa = ipsec_sa_entry(sa_tl->sa_idx);
+	odp_atomic_u64_t *counter[2] = { &ipsec_sa->hot.packets,
+					 &ipsec_sa->hot.bytes };
+	uint64_t quota[2] = { sa_tl->packet_quota, sa_tl->byte_quota };
+	int i;
+
+	/*
+	 * The SA may have been destroyed and created again after this entry
+	 * was filled. Counters of the new SA are not touched in that case,
+	 * and the update never takes a counter below zero in case the SA is
+	 * recreated concurrently.
+	 */
+	if (ipsec_sa->create_seq != sa_tl->sa_seq)
+		return;
+
+	for (i = 0; i < 2; i++) {
+		uint64_t old = odp_atomic_load_u64(counter[i]);
+		uint64_t new;
+
+		do {
+			new = old > quota[i] ? old - quota[i] : 0;
+		} while (!odp_atomic_cas_u64(counter[i], &old, new));
+	}
+}
+
 static inline sa_thread_local_t *ipsec_sa_thread_local(ipsec_sa_t *sa)
 {
-	return &ipsec_sa_tbl->per_thread[odp_thread_id()].sa[sa->ipsec_sa_idx];
+	ipsec_thread_local_t *tl = &ipsec_sa_tbl->per_thread[odp_thread_id()];
+	sa_thread_local_t *sa_tl = &tl->sa[sa->ipsec_sa_idx &
+					   SA_THREAD_CACHE_MASK];
+
+	if (odp_likely(sa_tl->sa_idx == sa->ipsec_sa_idx &&
+		       sa_tl->sa_seq == sa->create_seq))
+		return sa_tl;
+
+	if (sa_tl->sa_seq)
+		sa_thread_local_flush(sa_tl);
+
+	sa_tl->sa_idx = sa->ipsec_sa_idx;
+	sa_tl->sa_seq = sa->create_seq;
+	sa_tl->packet_quota = 0;
+	sa_tl->byte_quota = 0;
+	sa_tl->lifetime_status.all = 0;
+
+	return sa_tl;
+}
+
+static uint32_t sa_hash_dst(odp_ipsec_protocol_t proto, uint32_t spi,
+			    odp_ipsec_ip_version_t ver, const void *dst_addr)
+{
+	uint32_t key[2 + _ODP_IPV6ADDR_LEN / 4];
+	uint32_t len = (ver == ODP_IPSEC_IPV4) ? _ODP_IPV4ADDR_LEN :
+						  _ODP_IPV6ADDR_LEN;
+
+	key[0] = spi;
+	key[1] = proto;
+	memcpy(&key[2], dst_addr, len);
+
+	return odp_hash_crc32c(key, 2 * sizeof(uint32_t) + len, ver);
 }
 
-static void init_sa_thread_local(ipsec_sa_t *sa)
+static uint32_t sa_hash_spi(odp_ipsec_protocol_t proto, uint32_t spi)
 {
-	sa_thread_local_t *sa_tl;
-	int n;
+	uint32_t key[2];
+
+	key[0] = spi;
+	key[1] = proto;
+
+	return odp_hash_crc32c(key, sizeof(key), 0);
+}
 
-	for (n = 0; n < ODP_THREAD_COUNT_MAX; n++) {
-		sa_tl = &ipsec_sa_tbl->per_thread[n].sa[sa->ipsec_sa_idx];
-		sa_tl->packet_quota = 0;
-		sa_tl->byte_quota = 0;
-		sa_tl->lifetime_status.all = 0;
+/* Return hash bucket of the SA, or NULL if the SA is not looked up */
+static odp_atomic_u32_t *sa_hash_bucket(ipsec_sa_t *ipsec_sa)
+{
+	sa_hash_t *hash;
+	uint32_t hv;
+
+	if (ODP_IPSEC_LOOKUP_DSTADDR_SPI == ipsec_sa->lookup_mode) {
+		hash = &ipsec_sa_tbl->hash_dst;
+		hv = sa_hash_dst(ipsec_sa->proto, ipsec_sa->spi,
+				 ipsec_sa->in.lookup_ver,
+				 &ipsec_sa->in.lookup_dst_ipv4);
+	} else if (ODP_IPSEC_LOOKUP_SPI == ipsec_sa->lookup_mode) {
+		hash = &ipsec_sa_tbl->hash_spi;
+		hv = sa_hash_spi(ipsec_sa->proto, ipsec_sa->spi);
+	} else {
+		return NULL;
 	}
+
+	return &hash->bucket[hv & hash->mask];
+}
+
+static void sa_hash_insert(ipsec_sa_t *ipsec_sa)
+{
+	odp_atomic_u32_t *bucket = sa_hash_bucket(ipsec_sa);
+
+	if (bucket == NULL)
+		return;
+
+	odp_spinlock_lock(&ipsec_sa_tbl->hash_lock);
+	odp_atomic_store_u32(&ipsec_sa->hash_next, odp_atomic_load_u32(bucket));
+	odp_atomic_store_rel_u32(bucket, ipsec_sa->ipsec_sa_idx + 1);
+	odp_spinlock_unlock(&ipsec_sa_tbl->hash_lock);
+}
+
+static void sa_hash_remove(ipsec_sa_t *ipsec_sa)
+{
+	odp_atomic_u32_t *bucket = sa_hash_bucket(ipsec_sa);
+	odp_atomic_u32_t *prev;
+	uint32_t idx;
+
+	if (bucket == NULL)
+		return;
+
+	odp_spinlock_lock(&ipsec_sa_tbl->hash_lock);
+
+	prev = bucket;
+	idx = odp_atomic_load_u32(prev);
+
+	while (idx) {
+		if (idx == ipsec_sa->ipsec_sa_idx + 1) {
+			odp_atomic_store_rel_u32(prev,
+						 odp_atomic_load_u32(&ipsec_sa->hash_next));
+			break;
+		}
+		prev = &ipsec_sa_entry(idx - 1)->hash_next;
+		idx = odp_atomic_load_u32(prev);
+	}
+
+	odp_atomic_inc_u32(&ipsec_sa_tbl->hash_gen);
+	odp_spinlock_unlock(&ipsec_sa_tbl->hash_lock);
 }
 
 int _odp_ipsec_sad_init_global(void)
 {
 	odp_shm_t shm;
 	unsigned i;
+	int val;
+	uint32_t max_num_sa, ring_size, num_bucket, max_ws, num_block;
+	uint64_t sa_offset, ring_offset, bucket_offset, win_offset, shm_size;
+	uint8_t *base;
+	const char *conf_str;
 
 	if (odp_global_ro.disable.ipsec)
 		return 0;
 
+	conf_str = "ipsec.max_num_sa";
+	if (!_odp_libconfig_lookup_int(conf_str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", conf_str);
+		return -1;
+	}
+
+	if (val < 1 || val > CONFIG_IPSEC_MAX_NUM_SA) {
+		ODP_ERR("Bad value %s = %i\n", conf_str, val);
+		return -1;
+	}
+
+	max_num_sa = val;
+
+	conf_str = "ipsec.max_antireplay_ws";
+	if (!_odp_libconfig_lookup_int(conf_str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", conf_str);
+		return -1;
+	}
+
+	if (val < IPSEC_ANTIREPLAY_WS || val > CONFIG_IPSEC_MAX_ANTIREPLAY_WS) {
+		ODP_ERR("Bad value %s = %i\n", conf_str, val);
+		return -1;
+	}
+
+	max_ws = val;
+	num_block = ROUNDUP_POWER2_U32((max_ws + AR_BLOCK_BITS - 1) /
+				       AR_BLOCK_BITS + 1);
+
+	/* Ring size must be larger than the number of items stored */
+	ring_size = ROUNDUP_POWER2_U32(max_num_sa + 1);
+	num_bucket = ROUNDUP_POWER2_U32(max_num_sa);
+
+	sa_offset = ROUNDUP_CACHE_LINE(sizeof(ipsec_sa_table_t));
+	ring_offset = sa_offset + (uint64_t)max_num_sa * sizeof(ipsec_sa_t);
+	ring_offset = ROUNDUP_CACHE_LINE(ring_offset);
+	bucket_offset = ring_offset + sizeof(ring_u32_t) +
+			(uint64_t)ring_size * sizeof(uint32_t);
+	bucket_offset = ROUNDUP_CACHE_LINE(bucket_offset);
+	win_offset = bucket_offset +
+		     2 * (uint64_t)num_bucket * sizeof(odp_atomic_u32_t);
+	win_offset = ROUNDUP_CACHE_LINE(win_offset);
+	shm_size = win_offset +
+		   (uint64_t)max_num_sa * num_block * sizeof(odp_atomic_u64_t);
+
 	shm = odp_shm_reserve("_odp_ipsec_sa_table",
-			      sizeof(ipsec_sa_table_t),
+			      shm_size,
 			      ODP_CACHE_LINE_SIZE,
 			      0);
 	if (shm == ODP_SHM_INVALID)
 		return -1;
 
-	ipsec_sa_tbl = odp_shm_addr(shm);
+	base = odp_shm_addr(shm);
+	ipsec_sa_tbl = (ipsec_sa_table_t *)(uintptr_t)base;
 	memset(ipsec_sa_tbl, 0, sizeof(ipsec_sa_table_t));
 	ipsec_sa_tbl->shm = shm;
+	ipsec_sa_tbl->max_num_sa = max_num_sa;
+	ipsec_sa_tbl->max_antireplay_ws = max_ws;
+	ipsec_sa_tbl->ar_block_mask = num_block - 1;
+	ipsec_sa_tbl->ipsec_sa = (ipsec_sa_t *)(uintptr_t)(base + sa_offset);
+	ipsec_sa_tbl->free_ring = (ring_u32_t *)(uintptr_t)(base + ring_offset);
+	ipsec_sa_tbl->free_ring_mask = ring_size - 1;
+
+	ipsec_sa_tbl->hash_dst.mask = num_bucket - 1;
+	ipsec_sa_tbl->hash_dst.bucket =
+		(odp_atomic_u32_t *)(uintptr_t)(base + bucket_offset);
+	ipsec_sa_tbl->hash_spi.mask = num_bucket - 1;
+	ipsec_sa_tbl->hash_spi.bucket =
+		ipsec_sa_tbl->hash_dst.bucket + num_bucket;
+
+	for (i = 0; i < num_bucket; i++) {
+		odp_atomic_init_u32(&ipsec_sa_tbl->hash_dst.bucket[i], 0);
+		odp_atomic_init_u32(&ipsec_sa_tbl->hash_spi.bucket[i], 0);
+	}
+
+	odp_spinlock_init(&ipsec_sa_tbl->hash_lock);
+	odp_atomic_init_u32(&ipsec_sa_tbl->hash_gen, 0);
 
 	ring_mpmc_init(&ipsec_sa_tbl->hot.ipv4_id_ring);
 	for (i = 0; i < ODP_THREAD_COUNT_MAX; i++) {
@@ -175,14 +453,24 @@ int _odp_ipsec_sad_init_global(void)
 				    1);
 	}
 
-	for (i = 0; i < ODP_CONFIG_IPSEC_SAS; i++) {
+	ring_u32_init(ipsec_sa_tbl->free_ring);
+
+	for (i = 0; i < max_num_sa; i++) {
 		ipsec_sa_t *ipsec_sa = ipsec_sa_entry(i);
 
+		memset(ipsec_sa, 0, sizeof(ipsec_sa_t));
 		ipsec_sa->ipsec_sa_hdl = ipsec_sa_index_to_handle(i);
 		ipsec_sa->ipsec_sa_idx = i;
 		odp_atomic_init_u32(&ipsec_sa->state, IPSEC_SA_STATE_FREE);
+		odp_atomic_init_u32(&ipsec_sa->hash_next, 0);
 		odp_atomic_init_u64(&ipsec_sa->hot.bytes, 0);
 		odp_atomic_init_u64(&ipsec_sa->hot.packets, 0);
+		ipsec_sa->antireplay_win = (odp_atomic_u64_t *)(uintptr_t)
+			(base + win_offset +
+			 (uint64_t)i * num_block * sizeof(odp_atomic_u64_t));
+
+		ring_u32_enq(ipsec_sa_tbl->free_ring,
+			     ipsec_sa_tbl->free_ring_mask, i);
 	}
 
 	return 0;
@@ -190,7 +478,7 @@ int _odp_ipsec_sad_init_global(void)
 
 int _odp_ipsec_sad_term_global(void)
 {
-	int i;
+	uint32_t i;
 	ipsec_sa_t *ipsec_sa;
 	int ret = 0;
 	int rc = 0;
@@ -198,7 +486,7 @@ int _odp_ipsec_sad_term_global(void)
 	if (odp_global_ro.disable.ipsec)
 		return 0;
 
-	for (i = 0; i < ODP_CONFIG_IPSEC_SAS; i++) {
+	for (i = 0; i < ipsec_sa_tbl->max_num_sa; i++) {
 		ipsec_sa = ipsec_sa_entry(i);
 
 		if (odp_atomic_load_u32(&ipsec_sa->state) !=
@@ -216,30 +504,37 @@ int _odp_ipsec_sad_term_global(void)
 		rc = -1;
 	}
 
+	ipsec_sa_tbl = NULL;
+
 	return rc;
 }
 
 static ipsec_sa_t *ipsec_sa_reserve(void)
 {
-	int i;
 	ipsec_sa_t *ipsec_sa;
+	uint32_t idx;
+	uint32_t state = IPSEC_SA_STATE_FREE;
 
-	for (i = 0; i < ODP_CONFIG_IPSEC_SAS; i++) {
-		uint32_t state = IPSEC_SA_STATE_FREE;
+	if (ring_u32_deq(ipsec_sa_tbl->free_ring, ipsec_sa_tbl->free_ring_mask,
+			 &idx) == 0)
+		return NULL;
 
-		ipsec_sa = ipsec_sa_entry(i);
+	ipsec_sa = ipsec_sa_entry(idx);
 
-		if (odp_atomic_cas_acq_u32(&ipsec_sa->state, &state,
-					   IPSEC_SA_STATE_RESERVED))
-			return ipsec_sa;
+	if (!odp_atomic_cas_acq_u32(&ipsec_sa->state, &state,
+				    IPSEC_SA_STATE_RESERVED)) {
+		ODP_ERR("Free SA %u in bad state 0x%x\n", idx, state);
+		return NULL;
 	}
 
-	return NULL;
+	return ipsec_sa;
 }
 
 static void ipsec_sa_release(ipsec_sa_t *ipsec_sa)
 {
 	odp_atomic_store_rel_u32(&ipsec_sa->state, IPSEC_SA_STATE_FREE);
+	ring_u32_enq(ipsec_sa_tbl->free_ring, ipsec_sa_tbl->free_ring_mask,
+		     ipsec_sa->ipsec_sa_idx);
 }
 
 /* Mark reserved SA as available now */
@@ -416,11 +711,11 @@ odp_ipsec_sa_t odp_ipsec_sa_create(const odp_ipsec_sa_param_t *param)
 	ipsec_sa->queue = param->dest_queue;
 	ipsec_sa->mode = param->mode;
 	ipsec_sa->flags = 0;
-	if (param->opt.esn) {
-		ODP_ERR("ESN is not supported!\n");
-		return ODP_IPSEC_SA_INVALID;
-	}
+	ipsec_sa->esn = param->opt.esn;
 	if (ODP_IPSEC_DIR_INBOUND == param->dir) {
+		odp_atomic_u64_t *win = ipsec_sa->antireplay_win;
+		uint32_t i;
+
 		ipsec_sa->lookup_mode = param->inbound.lookup_mode;
 		if (ODP_IPSEC_LOOKUP_DSTADDR_SPI == ipsec_sa->lookup_mode) {
 			ipsec_sa->in.lookup_ver =
@@ -435,10 +730,17 @@ odp_ipsec_sa_t odp_ipsec_sa_create(const odp_ipsec_sa_param_t *param)
 				       sizeof(ipsec_sa->in.lookup_dst_ipv6));
 		}
 
-		if (param->inbound.antireplay_ws > IPSEC_ANTIREPLAY_WS)
+		if (param->inbound.antireplay_ws >
+		    ipsec_sa_tbl->max_antireplay_ws) {
+			ODP_ERR("Too large anti-replay window: %u\n",
+				param->inbound.antireplay_ws);
 			goto error;
+		}
 		ipsec_sa->antireplay = (param->inbound.antireplay_ws != 0);
-		odp_atomic_init_u64(&ipsec_sa->hot.in.antireplay, 0);
+		ipsec_sa->in.antireplay_ws = param->inbound.antireplay_ws;
+		odp_atomic_init_u64(&ipsec_sa->hot.in.max_seq, 0);
+		for (i = 0; i <= ipsec_sa_tbl->ar_block_mask; i++)
+			odp_atomic_init_u64(&win[i], 0);
 	} else {
 		ipsec_sa->lookup_mode = ODP_IPSEC_LOOKUP_DISABLED;
 		odp_atomic_store_u64(&ipsec_sa->hot.out.seq, 1);
@@ -587,11 +889,16 @@ odp_ipsec_sa_t odp_ipsec_sa_create(const odp_ipsec_sa_param_t *param)
 	case ODP_AUTH_ALG_AES128_GCM:
 #endif
 	case ODP_AUTH_ALG_AES_GCM:
-		crypto_param.auth_aad_len = sizeof(ipsec_aad_t);
+		crypto_param.auth_aad_len = ipsec_sa->esn ? IPSEC_AAD_ESN_LEN :
+							    IPSEC_AAD_LEN;
 		break;
 	case ODP_AUTH_ALG_AES_GMAC:
 		if (ODP_CIPHER_ALG_NULL != crypto_param.cipher_alg)
 			goto error;
+		if (ipsec_sa->esn) {
+			ODP_ERR("ESN is not supported with AES-GMAC\n");
+			goto error;
+		}
 		ipsec_sa->use_counter_iv = 1;
 		ipsec_sa->esp_iv_len = 8;
 		ipsec_sa->esp_pad_mask = esp_block_len_to_mask(16);
@@ -600,9 +907,20 @@ odp_ipsec_sa_t odp_ipsec_sa_create(const odp_ipsec_sa_param_t *param)
 		salt_param = &param->crypto.auth_key_extra;
 		break;
 	case ODP_AUTH_ALG_CHACHA20_POLY1305:
-		crypto_param.auth_aad_len = sizeof(ipsec_aad_t);
+		crypto_param.auth_aad_len = ipsec_sa->esn ? IPSEC_AAD_ESN_LEN :
+							    IPSEC_AAD_LEN;
+		break;
+	case ODP_AUTH_ALG_AES_CCM:
+		if (ipsec_sa->esn) {
+			ODP_ERR("ESN is not supported with AES-CCM\n");
+			goto error;
+		}
 		break;
 	default:
+		/* ESN high order bits are appended to ICV input (RFC 4302,
+		 * RFC 4303) */
+		ipsec_sa->insert_seq_hi = ipsec_sa->esn &&
+					  crypto_param.auth_digest_len > 0;
 		break;
 	}
 
@@ -627,10 +945,15 @@ odp_ipsec_sa_t odp_ipsec_sa_create(const odp_ipsec_sa_param_t *param)
 				      &ses_create_rc))
 		goto error;
 
-	init_sa_thread_local(ipsec_sa);
+	ipsec_sa->create_seq++;
+	/* Zero marks unused thread local cache entries */
+	if (ipsec_sa->create_seq == 0)
+		ipsec_sa->create_seq = 1;
 
 	ipsec_sa_publish(ipsec_sa);
 
+	sa_hash_insert(ipsec_sa);
+
 	return ipsec_sa->ipsec_sa_hdl;
 
 error:
@@ -700,6 +1023,8 @@ int odp_ipsec_sa_destroy(odp_ipsec_sa_t sa)
 		rc = -1;
 	}
 
+	sa_hash_remove(ipsec_sa);
+
 	ipsec_sa_release(ipsec_sa);
 
 	return rc;
@@ -731,39 +1056,80 @@ int odp_ipsec_sa_mtu_update(odp_ipsec_sa_t sa, uint32_t mtu)
 	return 0;
 }
 
-ipsec_sa_t *_odp_ipsec_sa_lookup(const ipsec_sa_lookup_t *lookup)
+static inline int sa_lookup_match(const ipsec_sa_t *ipsec_sa,
+				  const ipsec_sa_lookup_t *lookup,
+				  odp_ipsec_lookup_mode_t mode)
 {
-	int i;
-	ipsec_sa_t *best = NULL;
+	if (mode != ipsec_sa->lookup_mode ||
+	    lookup->proto != ipsec_sa->proto ||
+	    lookup->spi != ipsec_sa->spi)
+		return 0;
 
-	for (i = 0; i < ODP_CONFIG_IPSEC_SAS; i++) {
-		ipsec_sa_t *ipsec_sa = ipsec_sa_entry(i);
+	if (ODP_IPSEC_LOOKUP_SPI == mode)
+		return 1;
 
-		if (ipsec_sa_lock(ipsec_sa) < 0)
-			continue;
-
-		if (ODP_IPSEC_LOOKUP_DSTADDR_SPI == ipsec_sa->lookup_mode &&
-		    lookup->proto == ipsec_sa->proto &&
-		    lookup->spi == ipsec_sa->spi &&
-		    lookup->ver == ipsec_sa->in.lookup_ver &&
-		    !memcmp(lookup->dst_addr, &ipsec_sa->in.lookup_dst_ipv4,
-			    lookup->ver == ODP_IPSEC_IPV4 ?
-				    _ODP_IPV4ADDR_LEN :
-				    _ODP_IPV6ADDR_LEN)) {
-			if (NULL != best)
-				_odp_ipsec_sa_unuse(best);
-			return ipsec_sa;
-		} else if (NULL == best &&
-			   ODP_IPSEC_LOOKUP_SPI == ipsec_sa->lookup_mode &&
-			   lookup->proto == ipsec_sa->proto &&
-			   lookup->spi == ipsec_sa->spi) {
-			best = ipsec_sa;
-		} else {
-			_odp_ipsec_sa_unuse(ipsec_sa);
+	return lookup->ver == ipsec_sa->in.lookup_ver &&
+	       !memcmp(lookup->dst_addr, &ipsec_sa->in.lookup_dst_ipv4,
+		       lookup->ver == ODP_IPSEC_IPV4 ?
+				_ODP_IPV4ADDR_LEN :
+				_ODP_IPV6ADDR_LEN);
+}
+
+static ipsec_sa_t *sa_hash_lookup(odp_atomic_u32_t *bucket,
+				  const ipsec_sa_lookup_t *lookup,
+				  odp_ipsec_lookup_mode_t mode)
+{
+	uint32_t gen, idx, num;
+	ipsec_sa_t *ipsec_sa;
+
+	do {
+		gen = odp_atomic_load_acq_u32(&ipsec_sa_tbl->hash_gen);
+		idx = odp_atomic_load_acq_u32(bucket);
+		num = 0;
+
+		/* Walk is limited in case SAs are relinked under the reader */
+		while (idx && num++ < ipsec_sa_tbl->max_num_sa) {
+			ipsec_sa = ipsec_sa_entry(idx - 1);
+
+			if (sa_lookup_match(ipsec_sa, lookup, mode) &&
+			    ipsec_sa_lock(ipsec_sa) == 0) {
+				/* SA may have been recreated before it was
+				 * locked */
+				if (odp_likely(sa_lookup_match(ipsec_sa, lookup,
+							       mode)))
+					return ipsec_sa;
+
+				_odp_ipsec_sa_unuse(ipsec_sa);
+			}
+
+			idx = odp_atomic_load_acq_u32(&ipsec_sa->hash_next);
 		}
-	}
+	} while (odp_unlikely(gen !=
+			      odp_atomic_load_acq_u32(&ipsec_sa_tbl->hash_gen)));
 
-	return best;
+	return NULL;
+}
+
+ipsec_sa_t *_odp_ipsec_sa_lookup(const ipsec_sa_lookup_t *lookup)
+{
+	ipsec_sa_t *ipsec_sa;
+	sa_hash_t *hash;
+	uint32_t hv;
+
+	/* SAs with destination address lookup take precedence */
+	hash = &ipsec_sa_tbl->hash_dst;
+	hv = sa_hash_dst(lookup->proto, lookup->spi, lookup->ver,
+			 lookup->dst_addr);
+	ipsec_sa = sa_hash_lookup(&hash->bucket[hv & hash->mask], lookup,
+				  ODP_IPSEC_LOOKUP_DSTADDR_SPI);
+	if (ipsec_sa)
+		return ipsec_sa;
+
+	hash = &ipsec_sa_tbl->hash_spi;
+	hv = sa_hash_spi(lookup->proto, lookup->spi);
+
+	return sa_hash_lookup(&hash->bucket[hv & hash->mask], lookup,
+			      ODP_IPSEC_LOOKUP_SPI);
 }
 
 int _odp_ipsec_sa_stats_precheck(ipsec_sa_t *ipsec_sa,
@@ -827,13 +1193,59 @@ int _odp_ipsec_sa_stats_update(ipsec_sa_t *ipsec_sa, uint32_t len,
 	return 0;
 }
 
-int _odp_ipsec_sa_replay_precheck(ipsec_sa_t *ipsec_sa, uint32_t seq,
+uint64_t _odp_ipsec_sa_in_seq(ipsec_sa_t *ipsec_sa, uint32_t seq)
+{
+	uint64_t max_seq;
+	uint32_t top_lo, top_hi, ws, seq_hi;
+
+	if (!ipsec_sa->esn)
+		return seq;
+
+	max_seq = odp_atomic_load_u64(&ipsec_sa->hot.in.max_seq);
+	top_lo = max_seq & 0xffffffff;
+	top_hi = max_seq >> 32;
+
+	/* Without anti-replay, pick the closest sequence number */
+	ws = ipsec_sa->antireplay ? ipsec_sa->in.antireplay_ws : 0x80000000;
+
+	if (top_lo >= ws - 1) {
+		/* Window is within one sequence number subspace */
+		if (seq >= top_lo - ws + 1)
+			seq_hi = top_hi;
+		else
+			seq_hi = top_hi + 1;
+	} else {
+		/* Window spans two subspaces */
+		if (seq >= top_lo - ws + 1 && top_hi > 0)
+			seq_hi = top_hi - 1;
+		else
+			seq_hi = top_hi;
+	}
+
+	return ((uint64_t)seq_hi << 32) | seq;
+}
+
+int _odp_ipsec_sa_replay_precheck(ipsec_sa_t *ipsec_sa, uint64_t seq,
 				  odp_ipsec_op_status_t *status)
 {
+	uint64_t block, val;
+
+	if (!ipsec_sa->antireplay)
+		return 0;
+
 	/* Try to be as quick as possible, we will discard packets later */
-	if (ipsec_sa->antireplay &&
-	    seq + IPSEC_ANTIREPLAY_WS <=
-	    (odp_atomic_load_u64(&ipsec_sa->hot.in.antireplay) & 0xffffffff)) {
+	if (seq + ipsec_sa->in.antireplay_ws <=
+	    odp_atomic_load_u64(&ipsec_sa->hot.in.max_seq)) {
+		status->error.antireplay = 1;
+		return -1;
+	}
+
+	block = seq >> AR_BLOCK_SHIFT;
+	val = odp_atomic_load_u64(&ipsec_sa->antireplay_win[block &
+				  ipsec_sa_tbl->ar_block_mask]);
+
+	if ((uint32_t)(val >> 32) == (uint32_t)block &&
+	    (val & (1U << (seq & (AR_BLOCK_BITS - 1))))) {
 		status->error.antireplay = 1;
 		return -1;
 	}
@@ -841,42 +1253,61 @@ int _odp_ipsec_sa_replay_precheck(ipsec_sa_t *ipsec_sa, uint32_t seq,
 	return 0;
 }
 
-int _odp_ipsec_sa_replay_update(ipsec_sa_t *ipsec_sa, uint32_t seq,
+int _odp_ipsec_sa_replay_update(ipsec_sa_t *ipsec_sa, uint64_t seq,
 				odp_ipsec_op_status_t *status)
 {
-	int cas = 0;
-	uint64_t state, new_state;
+	uint64_t max_seq;
 
-	if (!ipsec_sa->antireplay)
+	if (!ipsec_sa->antireplay && !ipsec_sa->esn)
 		return 0;
 
-	state = odp_atomic_load_u64(&ipsec_sa->hot.in.antireplay);
+	if (ipsec_sa->antireplay) {
+		odp_atomic_u64_t *win;
+		uint64_t block, val, new_val;
+		uint32_t tag, bit;
 
-	while (0 == cas) {
-		uint32_t max_seq = state & 0xffffffff;
-		uint32_t mask = state >> 32;
-
-		if (seq + IPSEC_ANTIREPLAY_WS <= max_seq) {
+		if (seq + ipsec_sa->in.antireplay_ws <=
+		    odp_atomic_load_u64(&ipsec_sa->hot.in.max_seq)) {
 			status->error.antireplay = 1;
 			return -1;
-		} else if (seq >= max_seq + IPSEC_ANTIREPLAY_WS) {
-			mask = 1;
-			max_seq = seq;
-		} else if (seq > max_seq) {
-			mask <<= seq - max_seq;
-			mask |= 1;
-			max_seq = seq;
-		} else if (mask & (1U << (max_seq - seq))) {
-			status->error.antireplay = 1;
-			return -1;
-		} else {
-			mask |= (1U << (max_seq - seq));
 		}
 
-		new_state = (((uint64_t)mask) << 32) | max_seq;
+		block = seq >> AR_BLOCK_SHIFT;
+		bit = 1U << (seq & (AR_BLOCK_BITS - 1));
+		win = &ipsec_sa->antireplay_win[block &
+						 ipsec_sa_tbl->ar_block_mask];
+		val = odp_atomic_load_u64(win);
+
+		do {
+			tag = val >> 32;
+
+			if (tag == (uint32_t)block) {
+				if (val & bit) {
+					status->error.antireplay = 1;
+					return -1;
+				}
+				new_val = val | bit;
+			} else if ((int32_t)(tag - (uint32_t)block) > 0) {
+				/* Block reused already for newer sequence
+				 * numbers. Packet is out of window. */
+				status->error.antireplay = 1;
+				return -1;
+			} else {
+				/* Old block is out of window, take it into
+				 * use */
+				new_val = (((uint64_t)(uint32_t)block) << 32) |
+					  bit;
+			}
+		} while (!odp_atomic_cas_acq_rel_u64(win, &val, new_val));
+	}
+
+	/* Move window top */
+	max_seq = odp_atomic_load_u64(&ipsec_sa->hot.in.max_seq);
 
-		cas = odp_atomic_cas_acq_rel_u64(&ipsec_sa->hot.in.antireplay,
-						 &state, new_state);
+	while (seq > max_seq) {
+		if (odp_atomic_cas_rel_u64(&ipsec_sa->hot.in.max_seq,
+					   &max_seq, seq))
+			break;
 	}
 
 	return 0;
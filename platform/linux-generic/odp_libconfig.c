@@ -111,6 +111,37 @@ int _odp_libconfig_lookup_int(const char *path, int *value)
 	return  (ret_def == CONFIG_TRUE || ret_rt == CONFIG_TRUE) ? 1 : 0;
 }
 
+int _odp_libconfig_lookup_str(const char *path, char *value,
+			      unsigned int str_size)
+{
+	const config_t *config;
+	const char *str;
+	unsigned int len;
+	int i;
+
+	/* Runtime option overrides default value */
+	for (i = 0; i < 2; i++) {
+		if (i == 0)
+			config = &odp_global_ro.libconfig_runtime;
+		else
+			config = &odp_global_ro.libconfig_default;
+
+		if (config_lookup_string(config, path, &str) == CONFIG_FALSE)
+			continue;
+
+		len = strlen(str);
+		if (len >= str_size)
+			return -1;
+
+		memcpy(value, str, len + 1);
+
+		/* String length */
+		return len;
+	}
+
+	return -1;
+}
+
 int _odp_libconfig_lookup_array(const char *path, int value[], int max_num)
 {
 	const config_t *config;
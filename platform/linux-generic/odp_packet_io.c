@@ -2163,7 +2163,24 @@ static inline void _odp_dump_pcapng_pkts(pktio_entry_t *entry, int qidx,
 					 const odp_packet_t packets[], int num)
 {
 	if (odp_unlikely(entry->s.pcapng.state[qidx] == PCAPNG_WR_PKT))
-		_odp_pcapng_write_pkts(entry, qidx, packets, num);
+		_odp_pcapng_capture_pkts(entry, qidx, packets, num);
+}
+
+/* Capture only packets that the driver accepted */
+static int pktout_send_pcapng(pktio_entry_t *entry, int qidx,
+			      const odp_packet_t packets[], int num)
+{
+	uint32_t slot_idx[num > 0 ? num : 1];
+	int num_slot, ret;
+
+	num_slot = _odp_pcapng_capture_start(entry, qidx, packets, num,
+					     slot_idx);
+
+	ret = entry->s.ops->send(entry, qidx, packets, num);
+
+	_odp_pcapng_capture_end(entry, qidx, slot_idx, num_slot, ret);
+
+	return ret;
 }
 
 int odp_pktin_recv(odp_pktin_queue_t queue, odp_packet_t packets[], int num)
@@ -2365,8 +2382,9 @@ int odp_pktout_send(odp_pktout_queue_t queue, const odp_packet_t packets[],
 	if (odp_unlikely(entry->s.state != PKTIO_STATE_STARTED))
 		return 0;
 
-	if (_ODP_PCAPNG)
-		_odp_dump_pcapng_pkts(entry, queue.index, packets, num);
+	if (_ODP_PCAPNG &&
+	    odp_unlikely(entry->s.pcapng.state[queue.index] == PCAPNG_WR_PKT))
+		return pktout_send_pcapng(entry, queue.index, packets, num);
 
 	return entry->s.ops->send(entry, queue.index, packets, num);
 }
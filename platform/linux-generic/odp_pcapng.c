@@ -14,19 +14,26 @@
 #include <odp_pcapng.h>
 #include <odp/api/plat/packet_inlines.h>
 #include <odp/api/shared_memory.h>
+#include <odp/api/time.h>
+#include <odp_debug_internal.h>
+#include <odp_global_data.h>
 #include <odp_init_internal.h>
+#include <odp_libconfig_internal.h>
 #include <odp_macros_internal.h>
 #include <odp_packet_io_internal.h>
 #include <odp_posix_extensions.h>
+#include <odp_ring_u32_internal.h>
 #include <odp/api/spinlock.h>
 
 #include <errno.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <limits.h>
+#include <poll.h>
 #include <pthread.h>
+#include <time.h>
 #include <unistd.h>
 #include <sys/stat.h>
-#include <sys/uio.h>
 #include <sys/inotify.h>
 #include <sys/select.h>
 
@@ -36,11 +43,24 @@
 #define PCAPNG_ENDIAN_MAGIC 0x1A2B3C4DUL
 #define PCAPNG_DATA_ALIGN 4
 #define PCAPNG_LINKTYPE_ETHERNET 0x1
+#define PCAPNG_OPT_IF_TSRESOL 9
+/* Timestamps are in nanoseconds */
+#define PCAPNG_TSRESOL_NS 9
 
 /* inotify */
 #define INOTIFY_BUF_LEN (16 * (sizeof(struct inotify_event)))
 #define PCAPNG_WATCH_DIR "/var/run/odp/"
 
+/* Max number of capture ring entries processed by the writer per queue
+ * in one go */
+#define PCAPNG_BURST 64
+
+/* Writer thread sleep time when there is no capture data */
+#define PCAPNG_IDLE_SLEEP_NS (1000 * 1000)
+
+/* Max time the writer waits for FIFO space to complete a partial write */
+#define PCAPNG_WRITE_TMO_MS 100
+
 /* pcapng: enhanced packet block file encoding */
 typedef struct ODP_PACKED pcapng_section_hdr_block_s {
 	uint32_t block_type;
@@ -58,6 +78,13 @@ typedef struct pcapng_interface_description_block {
 	uint16_t linktype;
 	uint16_t reserved;
 	uint32_t snaplen;
+	/* if_tsresol option */
+	uint16_t tsresol_code;
+	uint16_t tsresol_len;
+	uint8_t tsresol;
+	uint8_t tsresol_pad[3];
+	/* opt_endofopt */
+	uint32_t end_of_opt;
 	uint32_t block_total_length2;
 } pcapng_interface_description_block_t;
 
@@ -71,6 +98,58 @@ typedef struct pcapng_enhanced_packet_block_s {
 	uint32_t packet_len;
 } pcapng_enhanced_packet_block_t;
 
+#define PCAPNG_HDR_LEN (sizeof(pcapng_section_hdr_block_t) + \
+			sizeof(pcapng_interface_description_block_t))
+
+/* Captured packet. Packet is referenced until the writer has copied its data
+ * and a capturing thread has released the slot. */
+typedef struct {
+	odp_packet_t pkt;
+	const uint8_t *data;
+	uint64_t ts_ns;
+	uint32_t cap_len;
+	uint32_t pkt_len;
+	/* Packet index in the burst */
+	uint32_t idx;
+} pcapng_slot_t;
+
+/* Capture state of a pktio queue */
+typedef struct ODP_ALIGNED_CACHE {
+	/* Free slots */
+	ring_u32_t *free_ring;
+	/* Captured slots to be written */
+	ring_u32_t *cap_ring;
+	/* Written slots, packet references to be released */
+	ring_u32_t *done_ring;
+	pcapng_slot_t *slot;
+
+	odp_atomic_u32_t sample;
+	odp_atomic_u64_t captured;
+	odp_atomic_u64_t dropped;
+
+	/* FIFO open and close requests from inotify thread */
+	odp_atomic_u32_t open_req;
+	odp_atomic_u32_t close_req;
+
+	/* Writer state */
+	uint8_t *buf;
+	uint32_t buf_len;
+	uint32_t buf_num;
+	int fd;
+	int active;
+	uint32_t file_idx;
+	uint64_t file_len;
+	uint64_t write_dropped;
+} pcapng_queue_t;
+
+/* Capture state of a pktio */
+typedef struct {
+	odp_shm_t shm;
+	pktio_entry_t *entry;
+	uint32_t num_queues;
+	pcapng_queue_t queue[];
+} pcapng_pktio_t;
+
 typedef struct ODP_ALIGNED_CACHE {
 	odp_shm_t shm;
 	pktio_entry_t *entry[ODP_CONFIG_PKTIO_ENTRIES];
@@ -80,14 +159,137 @@ typedef struct ODP_ALIGNED_CACHE {
 	int inotify_watch_fd;
 	int inotify_is_running;
 	odp_spinlock_t lock;
+
+	/* Capture state of started pktios. Protected by writer_lock. */
+	pcapng_pktio_t *pktio[ODP_CONFIG_PKTIO_ENTRIES];
+	pthread_mutex_t writer_lock;
+	pthread_t writer_thread;
+	int writer_is_running;
+	odp_atomic_u32_t writer_stop;
+
+	/* Offset from global time to wall clock time */
+	uint64_t ts_offset_ns;
+
+	struct {
+		uint32_t ring_size;
+		uint32_t snaplen;
+		uint32_t sample_rate;
+		uint32_t write_size;
+		uint64_t file_size;
+		uint32_t file_count;
+		char file_dir[PATH_MAX];
+	} config;
 } pcapng_global_t;
 
 static pcapng_global_t *pcapng_gbl;
 
-int write_pcapng_hdr(pktio_entry_t *entry, int qidx);
+static int read_config_file(pcapng_global_t *gbl)
+{
+	const char *str;
+	int val = 0;
+
+	ODP_PRINT("Pcapng config:\n");
+
+	str = "pcapng.ring_size";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+
+	if (val < PCAPNG_BURST || !CHECK_IS_POWER2(val)) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+
+	gbl->config.ring_size = val;
+	ODP_PRINT("  %s: %i\n", str, val);
+
+	str = "pcapng.snaplen";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+
+	if (val < 0) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+
+	gbl->config.snaplen = val;
+	ODP_PRINT("  %s: %i\n", str, val);
+
+	str = "pcapng.sample_rate";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+
+	if (val < 1) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+
+	gbl->config.sample_rate = val;
+	ODP_PRINT("  %s: %i\n", str, val);
+
+	str = "pcapng.write_size_kb";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+
+	if (val < 4 || val > 64 * 1024) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+
+	gbl->config.write_size = val * 1024;
+	ODP_PRINT("  %s: %i\n", str, val);
+
+	str = "pcapng.file_dir";
+	val = _odp_libconfig_lookup_str(str, gbl->config.file_dir,
+					sizeof(gbl->config.file_dir));
+	if (val < 0) {
+		ODP_ERR("Config option '%s' not found or too long.\n", str);
+		return -1;
+	}
+
+	ODP_PRINT("  %s: \"%s\"\n", str, gbl->config.file_dir);
+
+	str = "pcapng.file_size_mb";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+
+	if (val < 1) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+
+	gbl->config.file_size = (uint64_t)val * 1024 * 1024;
+	ODP_PRINT("  %s: %i\n", str, val);
+
+	str = "pcapng.file_count";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+
+	if (val < 1) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+
+	gbl->config.file_count = val;
+	ODP_PRINT("  %s: %i\n\n", str, val);
+
+	return 0;
+}
 
 int _odp_pcapng_init_global(void)
 {
+	struct timespec ts;
 	odp_shm_t shm;
 
 	shm = odp_shm_reserve("_odp_pcapng_gbl", sizeof(pcapng_global_t),
@@ -101,6 +303,18 @@ int _odp_pcapng_init_global(void)
 	pcapng_gbl->shm = shm;
 
 	odp_spinlock_init(&pcapng_gbl->lock);
+	pthread_mutex_init(&pcapng_gbl->writer_lock, NULL);
+	odp_atomic_init_u32(&pcapng_gbl->writer_stop, 0);
+
+	if (read_config_file(pcapng_gbl)) {
+		odp_shm_free(shm);
+		return -1;
+	}
+
+	/* Packet timestamps are global time. Capture files use wall clock. */
+	clock_gettime(CLOCK_REALTIME, &ts);
+	pcapng_gbl->ts_offset_ns = (uint64_t)ts.tv_sec * ODP_TIME_SEC_IN_NS +
+				   ts.tv_nsec - odp_time_global_ns();
 
 	return 0;
 }
@@ -109,6 +323,14 @@ int _odp_pcapng_term_global(void)
 {
 	int ret = 0;
 
+	if (pcapng_gbl->writer_is_running) {
+		odp_atomic_store_u32(&pcapng_gbl->writer_stop, 1);
+		pthread_join(pcapng_gbl->writer_thread, NULL);
+		pcapng_gbl->writer_is_running = 0;
+	}
+
+	pthread_mutex_destroy(&pcapng_gbl->writer_lock);
+
 	if (odp_shm_free(pcapng_gbl->shm)) {
 		ODP_ERR("shm free failed");
 		ret = -1;
@@ -117,6 +339,11 @@ int _odp_pcapng_term_global(void)
 	return ret;
 }
 
+static inline pcapng_queue_t *pcapng_queue(pktio_entry_t *entry, int qidx)
+{
+	return &pcapng_gbl->pktio[odp_pktio_index(entry->s.handle)]->queue[qidx];
+}
+
 static void pcapng_drain_fifo(int fd)
 {
 	char buffer[4096];
@@ -127,36 +354,263 @@ static void pcapng_drain_fifo(int fd)
 	} while (len > 0);
 }
 
-static void inotify_event_handle(pktio_entry_t *entry, int qidx,
-				 struct inotify_event *event)
+/* Write section header and interface description blocks */
+static uint32_t pcapng_hdr_fill(uint8_t *buf)
 {
-	int mtu = MAX(odp_pktin_maxlen(entry->s.handle),
-		      odp_pktout_maxlen(entry->s.handle));
+	pcapng_section_hdr_block_t shb;
+	pcapng_interface_description_block_t idb;
 
-	if (event->mask & IN_OPEN) {
-		int ret;
+	memset(&shb, 0, sizeof(shb));
+	memset(&idb, 0, sizeof(idb));
+
+	shb.block_type = PCAPNG_BLOCK_TYPE_SHB;
+	shb.block_total_length = sizeof(shb);
+	shb.block_total_length2 = sizeof(shb);
+	shb.magic = PCAPNG_ENDIAN_MAGIC;
+	shb.version_major = 0x1;
+	shb.version_minor = 0x0;
+	shb.section_len = -1;
+
+	idb.block_type = PCAPNG_BLOCK_TYPE_IDB;
+	idb.block_total_length = sizeof(idb);
+	idb.block_total_length2 = sizeof(idb);
+	idb.linktype = PCAPNG_LINKTYPE_ETHERNET;
+	idb.snaplen = pcapng_gbl->config.snaplen; /* 0: unlimited */
+	idb.tsresol_code = PCAPNG_OPT_IF_TSRESOL;
+	idb.tsresol_len = 1;
+	idb.tsresol = PCAPNG_TSRESOL_NS;
 
-		if (PIPE_BUF < mtu + sizeof(pcapng_enhanced_packet_block_t) +
-		    sizeof(uint32_t)) {
-			ODP_ERR("PIPE_BUF:%d too small. Disabling pcap\n",
-				PIPE_BUF);
-			entry->s.pcapng.state[qidx] = PCAPNG_WR_STOP;
+	memcpy(buf, &shb, sizeof(shb));
+	memcpy(buf + sizeof(shb), &idb, sizeof(idb));
 
-			return;
+	return PCAPNG_HDR_LEN;
+}
+
+/* Write all data. FIFO is non-blocking. When the FIFO is full, data is
+ * dropped, unless it has been partially written already. */
+static int pcapng_write(int fd, const uint8_t *buf, uint32_t len)
+{
+	struct pollfd pfd;
+	uint32_t done = 0;
+	ssize_t ret;
+
+	pfd.fd = fd;
+	pfd.events = POLLOUT;
+
+	while (done < len) {
+		ret = write(fd, buf + done, len - done);
+
+		if (ret > 0) {
+			done += ret;
+			continue;
 		}
 
-		ret = write_pcapng_hdr(entry, qidx);
-		if (ret) {
-			entry->s.pcapng.state[qidx] = PCAPNG_WR_STOP;
-		} else {
-			entry->s.pcapng.state[qidx] = PCAPNG_WR_PKT;
-			ODP_DBG("Open %s for pcap tracing\n", event->name);
+		if (ret < 0 && errno == EINTR)
+			continue;
+
+		if (ret < 0 && errno == EAGAIN && done &&
+		    poll(&pfd, 1, PCAPNG_WRITE_TMO_MS) > 0)
+			continue;
+
+		return -1;
+	}
+
+	return 0;
+}
+
+static int pcapng_file_open(pcapng_pktio_t *cap, uint32_t qidx)
+{
+	pcapng_queue_t *queue = &cap->queue[qidx];
+	uint8_t hdr[PCAPNG_HDR_LEN];
+	uint32_t hdr_len;
+	char path[PATH_MAX + 256];
+
+	snprintf(path, sizeof(path), "%s/%d-%s-flow-%u-%u.pcapng",
+		 pcapng_gbl->config.file_dir, odp_global_ro.main_pid,
+		 cap->entry->s.name, qidx, queue->file_idx);
+
+	queue->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC,
+			 S_IRUSR | S_IWUSR | S_IRGRP);
+	if (queue->fd == -1) {
+		ODP_ERR("Failed to open %s: %s\n", path, strerror(errno));
+		return -1;
+	}
+
+	hdr_len = pcapng_hdr_fill(hdr);
+	if (pcapng_write(queue->fd, hdr, hdr_len)) {
+		ODP_ERR("Failed to write pcapng header into %s\n", path);
+		close(queue->fd);
+		queue->fd = -1;
+		return -1;
+	}
+
+	queue->file_len = hdr_len;
+
+	return 0;
+}
+
+/* Write buffered capture data. Moves to the next file when the current file
+ * would become too large. */
+static void pcapng_flush(pcapng_pktio_t *cap, uint32_t qidx)
+{
+	pcapng_queue_t *queue = &cap->queue[qidx];
+
+	if (queue->buf_len == 0)
+		return;
+
+	if (pcapng_gbl->config.file_dir[0] && queue->fd != -1 &&
+	    queue->file_len > PCAPNG_HDR_LEN &&
+	    queue->file_len + queue->buf_len > pcapng_gbl->config.file_size) {
+		close(queue->fd);
+		queue->file_idx++;
+		if (queue->file_idx == pcapng_gbl->config.file_count)
+			queue->file_idx = 0;
+
+		pcapng_file_open(cap, qidx);
+	}
+
+	if (queue->fd != -1 &&
+	    pcapng_write(queue->fd, queue->buf, queue->buf_len) == 0)
+		queue->file_len += queue->buf_len;
+	else
+		queue->write_dropped += queue->buf_num;
+
+	queue->buf_len = 0;
+	queue->buf_num = 0;
+}
+
+/* Copy a captured packet into the write buffer */
+static void pcapng_buf_add(pcapng_pktio_t *cap, uint32_t qidx,
+			   const pcapng_slot_t *slot)
+{
+	pcapng_queue_t *queue = &cap->queue[qidx];
+	pcapng_enhanced_packet_block_t epb;
+	uint32_t data_len = ROUNDUP_ALIGN(slot->cap_len, PCAPNG_DATA_ALIGN);
+	uint32_t block_len = sizeof(epb) + data_len + sizeof(uint32_t);
+	uint8_t *ptr;
+
+	if (queue->buf_len + block_len > pcapng_gbl->config.write_size)
+		pcapng_flush(cap, qidx);
+
+	epb.block_type = PCAPNG_BLOCK_TYPE_EPB;
+	epb.block_total_length = block_len;
+	epb.interface_idx = 0;
+	epb.timestamp_high = (uint32_t)(slot->ts_ns >> 32);
+	epb.timestamp_low = (uint32_t)(slot->ts_ns);
+	epb.captured_len = slot->cap_len;
+	epb.packet_len = slot->pkt_len;
+
+	ptr = queue->buf + queue->buf_len;
+	memcpy(ptr, &epb, sizeof(epb));
+	ptr += sizeof(epb);
+	memcpy(ptr, slot->data, slot->cap_len);
+	memset(ptr + slot->cap_len, 0, data_len - slot->cap_len);
+	ptr += data_len;
+	memcpy(ptr, &block_len, sizeof(uint32_t));
+
+	queue->buf_len += block_len;
+	queue->buf_num++;
+}
+
+/* Write captured packets of a queue into the write buffer. Returns number of
+ * capture ring entries processed. */
+static int pcapng_queue_process(pcapng_pktio_t *cap, uint32_t qidx)
+{
+	pcapng_queue_t *queue = &cap->queue[qidx];
+	pktio_entry_t *entry = cap->entry;
+	uint32_t mask = pcapng_gbl->config.ring_size - 1;
+	uint32_t idx[PCAPNG_BURST];
+	uint32_t i, num;
+
+	if (odp_unlikely(odp_atomic_load_acq_u32(&queue->close_req))) {
+		odp_atomic_store_u32(&queue->close_req, 0);
+		queue->active = 0;
+		queue->buf_len = 0;
+		queue->buf_num = 0;
+		pcapng_drain_fifo(queue->fd);
+	}
+
+	if (odp_unlikely(odp_atomic_load_acq_u32(&queue->open_req))) {
+		odp_atomic_store_u32(&queue->open_req, 0);
+		queue->buf_len = pcapng_hdr_fill(queue->buf);
+		queue->buf_num = 0;
+		queue->active = 1;
+		entry->s.pcapng.state[qidx] = PCAPNG_WR_PKT;
+	}
+
+	num = ring_u32_deq_multi(queue->cap_ring, mask, idx, PCAPNG_BURST);
+	if (num == 0)
+		return 0;
+
+	if (queue->active) {
+		for (i = 0; i < num; i++)
+			pcapng_buf_add(cap, qidx, &queue->slot[idx[i]]);
+	}
+
+	/* Writer thread cannot free packets. Capturing threads release
+	 * the references. */
+	ring_u32_enq_multi(queue->done_ring, mask, idx, num);
+
+	return num;
+}
+
+static void *pcapng_writer(void *arg ODP_UNUSED)
+{
+	struct timespec ts;
+	pcapng_pktio_t *cap;
+	uint32_t q;
+	int i, num;
+
+	ts.tv_sec = 0;
+	ts.tv_nsec = PCAPNG_IDLE_SLEEP_NS;
+
+	while (odp_atomic_load_u32(&pcapng_gbl->writer_stop) == 0) {
+		num = 0;
+
+		pthread_mutex_lock(&pcapng_gbl->writer_lock);
+
+		for (i = 0; i < ODP_CONFIG_PKTIO_ENTRIES; i++) {
+			cap = pcapng_gbl->pktio[i];
+			if (cap == NULL)
+				continue;
+
+			for (q = 0; q < cap->num_queues; q++)
+				num += pcapng_queue_process(cap, q);
 		}
-	} else if (event->mask & IN_CLOSE) {
-		int fd = entry->s.pcapng.fd[qidx];
 
-		pcapng_drain_fifo(fd);
+		/* Write out partially filled buffers when idle */
+		if (num == 0) {
+			for (i = 0; i < ODP_CONFIG_PKTIO_ENTRIES; i++) {
+				cap = pcapng_gbl->pktio[i];
+				if (cap == NULL)
+					continue;
+
+				for (q = 0; q < cap->num_queues; q++)
+					pcapng_flush(cap, q);
+			}
+		}
+
+		pthread_mutex_unlock(&pcapng_gbl->writer_lock);
+
+		if (num == 0)
+			nanosleep(&ts, NULL);
+	}
+
+	return NULL;
+}
+
+static void inotify_event_handle(pktio_entry_t *entry, int qidx,
+				 struct inotify_event *event)
+{
+	pcapng_queue_t *queue = pcapng_queue(entry, qidx);
+
+	/* Writer thread writes pcapng header and starts capture */
+	if (event->mask & IN_OPEN) {
+		odp_atomic_store_rel_u32(&queue->open_req, 1);
+		ODP_DBG("Open %s for pcap tracing\n", event->name);
+	} else if (event->mask & IN_CLOSE) {
 		entry->s.pcapng.state[qidx] = PCAPNG_WR_STOP;
+		odp_atomic_store_rel_u32(&queue->close_req, 1);
 		ODP_DBG("Close %s for pcap tracing\n", event->name);
 	} else {
 		ODP_ERR("Unknown inotify event 0x%08x\n", event->mask);
@@ -286,59 +740,159 @@ static int get_fifo_max_size(void)
 	return ret;
 }
 
-int _odp_pcapng_start(pktio_entry_t *entry)
+
+static int pcapng_fifo_open(pktio_entry_t *entry, uint32_t qidx, int fifo_sz)
 {
-	int ret = -1, fd;
-	pthread_attr_t attr;
-	unsigned int i;
-	unsigned int max_queue =
-		MAX(entry->s.num_in_queue, entry->s.num_out_queue);
-	int fifo_sz;
+	char pcapng_name[128];
+	char pcapng_path[256];
+	int fd;
+
+	get_pcapng_fifo_name(pcapng_name, sizeof(pcapng_name),
+			     entry->s.name, qidx);
+	snprintf(pcapng_path, sizeof(pcapng_path), "%s/%s",
+		 PCAPNG_WATCH_DIR, pcapng_name);
+	if (mkfifo(pcapng_path, O_RDWR)) {
+		ODP_ERR("pcap not available for %s %s\n",
+			pcapng_path, strerror(errno));
+		return -1;
+	}
 
-	fifo_sz = get_fifo_max_size();
-	if (fifo_sz < 0)
-		ODP_DBG("failed to read max fifo size\n");
+	if (chmod(pcapng_path, S_IRUSR | S_IRGRP))
+		ODP_ERR("Failed to change file permission for %s %s\n",
+			pcapng_path, strerror(errno));
 
-	for (i = 0; i < max_queue; i++) {
-		char pcapng_name[128];
-		char pcapng_path[256];
+	fd = open(pcapng_path, O_RDWR | O_NONBLOCK);
+	if (fd == -1) {
+		ODP_ERR("Fail to open fifo\n");
+		if (remove(pcapng_path) == -1)
+			ODP_ERR("Can't remove fifo %s\n", pcapng_path);
+		return -1;
+	}
 
-		entry->s.pcapng.fd[i] = -1;
-		entry->s.pcapng.state[i] = PCAPNG_WR_STOP;
+	if (fifo_sz > 0) {
+		if (fcntl(fd, F_SETPIPE_SZ, fifo_sz) != fifo_sz)
+			ODP_DBG("Failed to set max fifo size\n");
+		else
+			ODP_DBG("set pcap fifo size %i\n", fifo_sz);
+	}
 
-		get_pcapng_fifo_name(pcapng_name, sizeof(pcapng_name),
-				     entry->s.name, i);
-		snprintf(pcapng_path, sizeof(pcapng_path), "%s/%s",
-			 PCAPNG_WATCH_DIR, pcapng_name);
-		if (mkfifo(pcapng_path, O_RDWR)) {
-			ODP_ERR("pcap not available for %s %s\n",
-				pcapng_path, strerror(errno));
-			continue;
-		}
+	return fd;
+}
+
+static void pcapng_fifo_close(pktio_entry_t *entry, uint32_t qidx, int fd)
+{
+	char pcapng_name[128];
+	char pcapng_path[256];
 
-		if (chmod(pcapng_path, S_IRUSR | S_IRGRP))
-			ODP_ERR("Failed to change file permission for %s %s\n",
-				pcapng_path, strerror(errno));
+	close(fd);
 
-		fd = open(pcapng_path, O_RDWR | O_NONBLOCK);
-		if (fd == -1) {
-			ODP_ERR("Fail to open fifo\n");
-			entry->s.pcapng.state[i] = PCAPNG_WR_STOP;
-			if (remove(pcapng_path) == -1)
-				ODP_ERR("Can't remove fifo %s\n", pcapng_path);
-			continue;
-		}
+	get_pcapng_fifo_name(pcapng_name, sizeof(pcapng_name),
+			     entry->s.name, qidx);
+	snprintf(pcapng_path, sizeof(pcapng_path), "%s/%s",
+		 PCAPNG_WATCH_DIR, pcapng_name);
 
-		if (fifo_sz > 0) {
-			if (fcntl(fd, F_SETPIPE_SZ, fifo_sz) != fifo_sz)
-				ODP_DBG("Failed to set max fifo size\n");
-			else
-				ODP_DBG("set pcap fifo size %i\n", fifo_sz);
+	if (remove(pcapng_path))
+		ODP_ERR("can't delete fifo %s\n", pcapng_path);
+}
+
+static pcapng_pktio_t *pcapng_pktio_alloc(pktio_entry_t *entry,
+					  uint32_t num_queues)
+{
+	uint32_t ring_size = pcapng_gbl->config.ring_size;
+	uint32_t write_size = pcapng_gbl->config.write_size;
+	uint32_t ring_len = sizeof(ring_u32_t) + ring_size * sizeof(uint32_t);
+	uint32_t queue_len;
+	uint64_t size;
+	pcapng_pktio_t *cap;
+	odp_shm_t shm;
+	uint8_t *ptr;
+	char name[ODP_SHM_NAME_LEN];
+	uint32_t i, j;
+
+	ring_len = ROUNDUP_CACHE_LINE(ring_len);
+	queue_len = 3 * ring_len +
+		    ROUNDUP_CACHE_LINE(ring_size * sizeof(pcapng_slot_t)) +
+		    ROUNDUP_CACHE_LINE(write_size);
+	size = ROUNDUP_CACHE_LINE(sizeof(pcapng_pktio_t) +
+				  num_queues * sizeof(pcapng_queue_t)) +
+	       (uint64_t)num_queues * queue_len;
+
+	snprintf(name, sizeof(name), "_odp_pcapng_%d",
+		 odp_pktio_index(entry->s.handle));
+	shm = odp_shm_reserve(name, size, ODP_CACHE_LINE_SIZE, 0);
+	if (shm == ODP_SHM_INVALID)
+		return NULL;
+
+	cap = odp_shm_addr(shm);
+	memset(cap, 0, sizeof(pcapng_pktio_t) +
+	       num_queues * sizeof(pcapng_queue_t));
+	cap->shm = shm;
+	cap->entry = entry;
+	cap->num_queues = num_queues;
+
+	ptr = (uint8_t *)cap + ROUNDUP_CACHE_LINE(sizeof(pcapng_pktio_t) +
+				num_queues * sizeof(pcapng_queue_t));
+
+	for (i = 0; i < num_queues; i++) {
+		pcapng_queue_t *queue = &cap->queue[i];
+
+		queue->free_ring = (ring_u32_t *)(uintptr_t)ptr;
+		ptr += ring_len;
+		queue->cap_ring = (ring_u32_t *)(uintptr_t)ptr;
+		ptr += ring_len;
+		queue->done_ring = (ring_u32_t *)(uintptr_t)ptr;
+		ptr += ring_len;
+		queue->slot = (pcapng_slot_t *)(uintptr_t)ptr;
+		ptr += ROUNDUP_CACHE_LINE(ring_size * sizeof(pcapng_slot_t));
+		queue->buf = ptr;
+		ptr += ROUNDUP_CACHE_LINE(write_size);
+
+		ring_u32_init(queue->free_ring);
+		ring_u32_init(queue->cap_ring);
+		ring_u32_init(queue->done_ring);
+
+		for (j = 0; j < ring_size; j++) {
+			queue->slot[j].pkt = ODP_PACKET_INVALID;
+			ring_u32_enq(queue->free_ring, ring_size - 1, j);
 		}
 
-		entry->s.pcapng.fd[i] = fd;
+		odp_atomic_init_u32(&queue->sample, 0);
+		odp_atomic_init_u64(&queue->captured, 0);
+		odp_atomic_init_u64(&queue->dropped, 0);
+		odp_atomic_init_u32(&queue->open_req, 0);
+		odp_atomic_init_u32(&queue->close_req, 0);
+		queue->fd = -1;
 	}
 
+	return cap;
+}
+
+static int pcapng_writer_start(void)
+{
+	int ret;
+
+	if (pcapng_gbl->writer_is_running)
+		return 0;
+
+	odp_atomic_store_u32(&pcapng_gbl->writer_stop, 0);
+
+	ret = pthread_create(&pcapng_gbl->writer_thread, NULL, pcapng_writer,
+			     NULL);
+	if (ret) {
+		ODP_ERR("Can't start pcapng writer thread (ret=%d)\n", ret);
+		return -1;
+	}
+
+	pcapng_gbl->writer_is_running = 1;
+
+	return 0;
+}
+
+static int pcapng_inotify_start(pktio_entry_t *entry)
+{
+	pthread_attr_t attr;
+	int ret = -1;
+
 	odp_spinlock_lock(&pcapng_gbl->lock);
 
 	/* already running from a previous pktio */
@@ -355,7 +909,7 @@ int _odp_pcapng_start(pktio_entry_t *entry)
 	pcapng_gbl->inotify_fd = inotify_init();
 	if (pcapng_gbl->inotify_fd == -1) {
 		ODP_ERR("can't init inotify. pcap disabled\n");
-		goto out_destroy;
+		goto out;
 	}
 
 	pcapng_gbl->inotify_watch_fd = inotify_add_watch(pcapng_gbl->inotify_fd,
@@ -365,7 +919,8 @@ int _odp_pcapng_start(pktio_entry_t *entry)
 	if (pcapng_gbl->inotify_watch_fd == -1) {
 		ODP_ERR("can't register inotify for %s. pcap disabled\n",
 			strerror(errno));
-		goto out_destroy;
+		close(pcapng_gbl->inotify_fd);
+		goto out;
 	}
 
 	/* create a thread to poll inotify triggers */
@@ -374,33 +929,32 @@ int _odp_pcapng_start(pktio_entry_t *entry)
 			     &pcapng_gbl->inotify_fd);
 	if (ret) {
 		ODP_ERR("Can't start inotify thread (ret=%d). pcapng disabled.\n", ret);
+		inotify_rm_watch(pcapng_gbl->inotify_fd,
+				 pcapng_gbl->inotify_watch_fd);
+		close(pcapng_gbl->inotify_fd);
 	} else {
 		pcapng_gbl->entry[odp_pktio_index(entry->s.handle)] = entry;
 		pcapng_gbl->num_entries++;
 		pcapng_gbl->inotify_is_running = 1;
 	}
 
+out:
 	odp_spinlock_unlock(&pcapng_gbl->lock);
 
-	return ret;
-
-out_destroy:
-	odp_spinlock_unlock(&pcapng_gbl->lock);
-
-	_odp_pcapng_stop(entry);
-
 	return ret;
 }
 
-void _odp_pcapng_stop(pktio_entry_t *entry)
+static void pcapng_inotify_stop(pktio_entry_t *entry)
 {
 	int ret;
-	unsigned int i;
-	unsigned int max_queue =
-		MAX(entry->s.num_in_queue, entry->s.num_out_queue);
 
 	odp_spinlock_lock(&pcapng_gbl->lock);
 
+	if (pcapng_gbl->entry[odp_pktio_index(entry->s.handle)] == NULL) {
+		odp_spinlock_unlock(&pcapng_gbl->lock);
+		return;
+	}
+
 	pcapng_gbl->entry[odp_pktio_index(entry->s.handle)] = NULL;
 	pcapng_gbl->num_entries--;
 
@@ -410,171 +964,304 @@ void _odp_pcapng_stop(pktio_entry_t *entry)
 		if (ret)
 			ODP_ERR("can't cancel inotify thread %s\n",
 				strerror(errno));
+		else
+			pthread_join(pcapng_gbl->inotify_thread, NULL);
 		pcapng_gbl->inotify_is_running = 0;
-	}
 
-	if (pcapng_gbl->num_entries == 0) {
-		/* fd's will be -1 in case of any failure */
 		ret = inotify_rm_watch(pcapng_gbl->inotify_fd,
 				       pcapng_gbl->inotify_watch_fd);
 		if (ret)
 			ODP_ERR("can't deregister inotify %s\n",
 				strerror(errno));
 
-		if (pcapng_gbl->inotify_fd != -1)
-			close(pcapng_gbl->inotify_fd);
-
-		if (pcapng_gbl->inotify_watch_fd != -1)
-			close(pcapng_gbl->inotify_watch_fd);
+		close(pcapng_gbl->inotify_fd);
 	}
 
 	odp_spinlock_unlock(&pcapng_gbl->lock);
+}
 
-	for (i = 0; i < max_queue; i++) {
-		char pcapng_name[128];
-		char pcapng_path[256];
-
-		entry->s.pcapng.state[i] = PCAPNG_WR_STOP;
-		close(entry->s.pcapng.fd[i]);
-
-		get_pcapng_fifo_name(pcapng_name, sizeof(pcapng_name),
-				     entry->s.name, i);
-		snprintf(pcapng_path, sizeof(pcapng_path), "%s/%s",
-			 PCAPNG_WATCH_DIR, pcapng_name);
+/* Release all packet references. Called when no more packets are captured
+ * and the writer does not access the queue anymore. */
+static void pcapng_queue_release(pcapng_queue_t *queue)
+{
+	uint32_t i;
 
-		if (remove(pcapng_path))
-			ODP_ERR("can't delete fifo %s\n", pcapng_path);
+	for (i = 0; i < pcapng_gbl->config.ring_size; i++) {
+		if (queue->slot[i].pkt != ODP_PACKET_INVALID) {
+			odp_packet_free(queue->slot[i].pkt);
+			queue->slot[i].pkt = ODP_PACKET_INVALID;
+		}
 	}
 }
 
-int write_pcapng_hdr(pktio_entry_t *entry, int qidx)
+int _odp_pcapng_start(pktio_entry_t *entry)
 {
-	size_t len;
-	pcapng_section_hdr_block_t shb;
-	pcapng_interface_description_block_t idb;
-	int fd = entry->s.pcapng.fd[qidx];
+	unsigned int max_queue =
+		MAX(entry->s.num_in_queue, entry->s.num_out_queue);
+	int file_mode = pcapng_gbl->config.file_dir[0] != 0;
+	pcapng_pktio_t *cap;
+	int fifo_sz = -1;
+	unsigned int i;
 
-	memset(&shb, 0, sizeof(shb));
-	memset(&idb, 0, sizeof(idb));
+	for (i = 0; i < PKTIO_MAX_QUEUES; i++) {
+		entry->s.pcapng.fd[i] = -1;
+		entry->s.pcapng.state[i] = PCAPNG_WR_STOP;
+	}
 
-	shb.block_type = PCAPNG_BLOCK_TYPE_SHB;
-	shb.block_total_length = sizeof(shb);
-	shb.block_total_length2 = sizeof(shb);
-	shb.magic = PCAPNG_ENDIAN_MAGIC;
-	shb.version_major = 0x1;
-	shb.version_minor = 0x0;
-	shb.section_len = -1;
+	if (max_queue == 0)
+		return 0;
 
-	len = write(fd, &shb, sizeof(shb));
-	/* fail to write shb/idb means the pcapng is unreadable */
-	if (len != sizeof(shb)) {
-		ODP_ERR("Failed to write pcapng section hdr\n");
+	cap = pcapng_pktio_alloc(entry, max_queue);
+	if (cap == NULL) {
+		ODP_ERR("pcapng shm reserve failed\n");
 		return -1;
 	}
-	fsync(fd);
 
-	idb.block_type = PCAPNG_BLOCK_TYPE_IDB;
-	idb.block_total_length = sizeof(idb);
-	idb.block_total_length2 = sizeof(idb);
-	idb.linktype = PCAPNG_LINKTYPE_ETHERNET;
-	idb.snaplen = 0x0; /* unlimited */
-	len = write(fd, &idb, sizeof(idb));
-	if (len != sizeof(idb)) {
-		ODP_ERR("Failed to write pcapng interface description\n");
-		return -1;
+	if (!file_mode) {
+		fifo_sz = get_fifo_max_size();
+		if (fifo_sz < 0)
+			ODP_DBG("failed to read max fifo size\n");
+	}
+
+	for (i = 0; i < max_queue; i++) {
+		pcapng_queue_t *queue = &cap->queue[i];
+
+		if (file_mode) {
+			if (pcapng_file_open(cap, i))
+				continue;
+
+			queue->active = 1;
+		} else {
+			queue->fd = pcapng_fifo_open(entry, i, fifo_sz);
+			if (queue->fd == -1)
+				continue;
+		}
+
+		entry->s.pcapng.fd[i] = queue->fd;
 	}
-	fsync(fd);
+
+	pthread_mutex_lock(&pcapng_gbl->writer_lock);
+	pcapng_gbl->pktio[odp_pktio_index(entry->s.handle)] = cap;
+	pthread_mutex_unlock(&pcapng_gbl->writer_lock);
+
+	if (pcapng_writer_start())
+		goto error;
+
+	if (file_mode) {
+		for (i = 0; i < max_queue; i++)
+			if (cap->queue[i].fd != -1)
+				entry->s.pcapng.state[i] = PCAPNG_WR_PKT;
+
+		return 0;
+	}
+
+	if (pcapng_inotify_start(entry))
+		goto error;
 
 	return 0;
+
+error:
+	_odp_pcapng_stop(entry);
+	return -1;
 }
 
-/*
- * make sure that each fifo write is less than PIPE_BUF
- * this will make sure writes are atomic (on non blocking mode).
- * writev() transfers all the data and returns the number of bytes requested or
- * -EAGAIN
- */
-static ssize_t write_fifo(int fd, struct iovec *iov, int iovcnt)
+void _odp_pcapng_stop(pktio_entry_t *entry)
 {
-	ssize_t len = 0;
-
-	len = writev(fd, iov, iovcnt);
-	/*
-	 * we don't care if a writev fails, we asynchronously read the fifo
-	 * so the next block of packets might be successful. This error only
-	 * means that some packets failed to append on the pcap file
-	 */
-	if (len > 0)
-		fsync(fd);
-
-	return len;
+	int file_mode = pcapng_gbl->config.file_dir[0] != 0;
+	int idx = odp_pktio_index(entry->s.handle);
+	pcapng_pktio_t *cap = pcapng_gbl->pktio[idx];
+	uint64_t captured, dropped;
+	uint32_t i;
+
+	if (cap == NULL)
+		return;
+
+	for (i = 0; i < cap->num_queues; i++)
+		entry->s.pcapng.state[i] = PCAPNG_WR_STOP;
+
+	if (!file_mode)
+		pcapng_inotify_stop(entry);
+
+	pthread_mutex_lock(&pcapng_gbl->writer_lock);
+
+	pcapng_gbl->pktio[idx] = NULL;
+
+	/* Write out remaining captured packets */
+	for (i = 0; i < cap->num_queues; i++) {
+		pcapng_queue_t *queue = &cap->queue[i];
+
+		while (pcapng_queue_process(cap, i))
+			;
+
+		pcapng_flush(cap, i);
+		pcapng_queue_release(queue);
+
+		captured = odp_atomic_load_u64(&queue->captured);
+		dropped = odp_atomic_load_u64(&queue->dropped) +
+			  queue->write_dropped;
+		if (captured || dropped)
+			ODP_PRINT("pcapng %s queue %u: captured %" PRIu64
+				  ", dropped %" PRIu64 "\n", entry->s.name, i,
+				  captured - queue->write_dropped, dropped);
+
+		if (queue->fd == -1)
+			continue;
+
+		if (file_mode)
+			close(queue->fd);
+		else
+			pcapng_fifo_close(entry, i, queue->fd);
+
+		queue->fd = -1;
+		entry->s.pcapng.fd[i] = -1;
+	}
+
+	pthread_mutex_unlock(&pcapng_gbl->writer_lock);
+
+	if (odp_shm_free(cap->shm))
+		ODP_ERR("pcapng shm free failed\n");
 }
 
-int _odp_pcapng_write_pkts(pktio_entry_t *entry, int qidx,
-			   const odp_packet_t packets[], int num)
+/* Release packet references of slots the writer has completed */
+static inline void pcapng_done_release(pcapng_queue_t *queue, uint32_t mask)
 {
-	int i = 0;
-	struct iovec packet_iov[3 * num];
-	pcapng_enhanced_packet_block_t epb[num];
-	int iovcnt = 0;
-	ssize_t block_len = 0;
-	int fd = entry->s.pcapng.fd[qidx];
-	ssize_t len = 0, wlen;
+	uint32_t idx[PCAPNG_BURST];
+	odp_packet_t pkt[PCAPNG_BURST];
+	uint32_t i, num;
+
+	num = ring_u32_deq_multi(queue->done_ring, mask, idx, PCAPNG_BURST);
+	if (num == 0)
+		return;
 
 	for (i = 0; i < num; i++) {
-		odp_packet_hdr_t *pkt_hdr = packet_hdr(packets[i]);
-		uint32_t seg_len;
-		char *buf = (char *)odp_packet_offset(packets[i], 0, &seg_len,
-						      NULL);
-
-		if (block_len + sizeof(epb[i]) +
-		    ROUNDUP_ALIGN(seg_len, PCAPNG_DATA_ALIGN) +
-		    sizeof(uint32_t) > PIPE_BUF) {
-			wlen = write_fifo(fd, packet_iov, iovcnt);
-			if (wlen > 0) {
-				len += wlen;
-				block_len = 0;
-				iovcnt = 0;
-			}
+		pkt[i] = queue->slot[idx[i]].pkt;
+		queue->slot[idx[i]].pkt = ODP_PACKET_INVALID;
+	}
+
+	odp_packet_free_multi(pkt, num);
+	ring_u32_enq_multi(queue->free_ring, mask, idx, num);
+}
+
+int _odp_pcapng_capture_start(pktio_entry_t *entry, int qidx,
+			      const odp_packet_t packets[], int num,
+			      uint32_t slot_idx[])
+{
+	pcapng_queue_t *queue = pcapng_queue(entry, qidx);
+	uint32_t mask = pcapng_gbl->config.ring_size - 1;
+	uint32_t sample_rate = pcapng_gbl->config.sample_rate;
+	uint32_t snaplen = pcapng_gbl->config.snaplen;
+	uint32_t max_len = pcapng_gbl->config.write_size -
+			   sizeof(pcapng_enhanced_packet_block_t) -
+			   sizeof(uint32_t) - PCAPNG_DATA_ALIGN;
+	uint32_t pkt_idx[num];
+	uint32_t i, num_cap, num_slot;
+	uint64_t now_ns = 0;
+
+	if (odp_unlikely(num <= 0))
+		return 0;
+
+	/* Select every Nth packet */
+	if (sample_rate > 1) {
+		uint32_t cnt = odp_atomic_fetch_add_u32(&queue->sample, num);
+
+		num_cap = 0;
+		for (i = 0; i < (uint32_t)num; i++) {
+			if ((cnt + i) % sample_rate == 0)
+				pkt_idx[num_cap++] = i;
+		}
+	} else {
+		num_cap = num;
+		for (i = 0; i < num_cap; i++)
+			pkt_idx[i] = i;
+	}
+
+	if (num_cap == 0)
+		return 0;
+
+	pcapng_done_release(queue, mask);
+
+	num_slot = ring_u32_deq_multi(queue->free_ring, mask, slot_idx,
+				      num_cap);
+
+	if (odp_unlikely(num_slot < num_cap))
+		odp_atomic_add_u64(&queue->dropped, num_cap - num_slot);
+
+	for (i = 0; i < num_slot; i++) {
+		pcapng_slot_t *slot = &queue->slot[slot_idx[i]];
+		odp_packet_t pkt = packets[pkt_idx[i]];
+		odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
+		uint32_t seg_len = odp_packet_seg_len(pkt);
+		uint32_t cap_len = seg_len;
+
+		if (snaplen && cap_len > snaplen)
+			cap_len = snaplen;
+
+		if (cap_len > max_len)
+			cap_len = max_len;
+
+		if (pkt_hdr->p.input_flags.timestamp) {
+			slot->ts_ns = odp_time_to_ns(pkt_hdr->timestamp);
+		} else {
+			if (now_ns == 0)
+				now_ns = odp_time_global_ns();
+
+			slot->ts_ns = now_ns;
 		}
-		epb[i].block_type = PCAPNG_BLOCK_TYPE_EPB;
-		epb[i].block_total_length = sizeof(epb[i]) +
-			ROUNDUP_ALIGN(seg_len, PCAPNG_DATA_ALIGN) +
-			PCAPNG_DATA_ALIGN;
-		epb[i].interface_idx = 0;
-		epb[i].timestamp_high =
-			(uint32_t)(pkt_hdr->timestamp.u64 >> 32);
-		epb[i].timestamp_low = (uint32_t)(pkt_hdr->timestamp.u64);
-		epb[i].captured_len = seg_len;
-		epb[i].packet_len = seg_len;
-
-		/* epb */
-		packet_iov[iovcnt].iov_base = &epb[i];
-		packet_iov[iovcnt].iov_len = sizeof(epb[i]);
-		block_len += packet_iov[iovcnt].iov_len;
-		iovcnt++;
-
-		/* data */
-		packet_iov[iovcnt].iov_base = buf;
-		packet_iov[iovcnt].iov_len =
-			ROUNDUP_ALIGN(seg_len, PCAPNG_DATA_ALIGN);
-		block_len += packet_iov[iovcnt].iov_len;
-		iovcnt++;
-
-		/* trailing */
-		packet_iov[iovcnt].iov_base = &epb[i].block_total_length;
-		packet_iov[iovcnt].iov_len = sizeof(uint32_t);
-		block_len += packet_iov[iovcnt].iov_len;
-		iovcnt++;
-	}
-
-	if (iovcnt) {
-		wlen = write_fifo(fd, packet_iov, iovcnt);
-		if (wlen > 0)
-			len += wlen;
-	}
-
-	return len;
+
+		slot->ts_ns += pcapng_gbl->ts_offset_ns;
+		slot->pkt = odp_packet_ref_static(pkt);
+		slot->data = odp_packet_data(pkt);
+		slot->cap_len = cap_len;
+		slot->pkt_len = odp_packet_len(pkt);
+		slot->idx = pkt_idx[i];
+	}
+
+	return num_slot;
+}
+
+void _odp_pcapng_capture_end(pktio_entry_t *entry, int qidx,
+			     const uint32_t slot_idx[], int num_slot,
+			     int num_sent)
+{
+	pcapng_queue_t *queue = pcapng_queue(entry, qidx);
+	uint32_t mask = pcapng_gbl->config.ring_size - 1;
+	uint32_t cap_idx[num_slot > 0 ? num_slot : 1];
+	uint32_t free_idx[num_slot > 0 ? num_slot : 1];
+	int i, num_cap = 0, num_free = 0;
+
+	for (i = 0; i < num_slot; i++) {
+		pcapng_slot_t *slot = &queue->slot[slot_idx[i]];
+
+		if ((int)slot->idx < num_sent) {
+			cap_idx[num_cap++] = slot_idx[i];
+			continue;
+		}
+
+		/* Packet was not sent. Application still owns it. */
+		odp_packet_free(slot->pkt);
+		slot->pkt = ODP_PACKET_INVALID;
+		free_idx[num_free++] = slot_idx[i];
+	}
+
+	if (num_cap) {
+		ring_u32_enq_multi(queue->cap_ring, mask, cap_idx, num_cap);
+		odp_atomic_add_u64(&queue->captured, num_cap);
+	}
+
+	if (num_free)
+		ring_u32_enq_multi(queue->free_ring, mask, free_idx, num_free);
+}
+
+void _odp_pcapng_capture_pkts(pktio_entry_t *entry, int qidx,
+			      const odp_packet_t packets[], int num)
+{
+	uint32_t slot_idx[num > 0 ? num : 1];
+	int num_slot;
+
+	num_slot = _odp_pcapng_capture_start(entry, qidx, packets, num,
+					     slot_idx);
+	if (num_slot)
+		_odp_pcapng_capture_end(entry, qidx, slot_idx, num_slot, num);
 }
 
 #endif /* _ODP_PCAPNG */
@@ -69,6 +69,28 @@
 /* Max inline timer resolution */
 #define MAX_INLINE_RES_NS 500
 
+/* Timer expiration engines */
+#define TIMER_ENGINE_SCAN  0
+#define TIMER_ENGINE_WHEEL 1
+
+/* Hierarchical timing wheel geometry. Each level has WHEEL_SLOTS slots and a
+ * slot on level N spans WHEEL_SLOTS^N scan ticks. Timers further away than
+ * the wheel range are kept on an overflow list. */
+#define WHEEL_SLOT_BITS  6
+#define WHEEL_SLOTS      (1 << WHEEL_SLOT_BITS)
+#define WHEEL_SLOT_MASK  (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS     6
+
+/* Wheel list indexes: level slots, overflow list and list of expiring timers */
+#define WHEEL_OVERFLOW   (WHEEL_LEVELS * WHEEL_SLOTS)
+#define WHEEL_DRAIN      (WHEEL_OVERFLOW + 1)
+#define WHEEL_NUM_LISTS  (WHEEL_DRAIN + 1)
+
+#define WHEEL_NOT_LINKED ((uint32_t)-1)
+
+/* Number of timers moved out of the wheel lock per expiration round */
+#define WHEEL_BURST      32
+
 /* Mutual exclusion in the absence of CAS16 */
 #ifndef ODP_ATOMIC_U128
 #define NUM_LOCKS 1024
@@ -111,6 +133,24 @@ typedef struct {
 
 } _odp_timer_t;
 
+/* Timing wheel list node. Timer nodes are followed by list head nodes in the
+ * node array. */
+typedef struct {
+	uint32_t next;
+	uint32_t prev;
+
+} wheel_node_t;
+
+typedef struct {
+	odp_spinlock_t lock;
+	/* Next scan tick to be processed */
+	uint64_t next_tick;
+	/* Number of timers linked into the wheel */
+	uint32_t num;
+	wheel_node_t *node;
+
+} timer_wheel_t;
+
 typedef struct timer_pool_s {
 	/* Put frequently accessed fields in the first cache line */
 	uint64_t nsec_per_scan;
@@ -136,6 +176,8 @@ typedef struct timer_pool_s {
 	int thr_warm_up; /* number of warm up rounds */
 	odp_atomic_u32_t thr_ready; /* thread ready from warm up */
 	int thr_exit; /* request to exit for timer thread */
+	int engine; /* Expiration engine: TIMER_ENGINE_xxx */
+	timer_wheel_t wheel; /* Used with TIMER_ENGINE_WHEEL */
 
 } timer_pool_t;
 
@@ -166,6 +208,7 @@ typedef struct timer_global_t {
 	int poll_interval;
 	int highest_tp_idx;
 	uint8_t thread_type;
+	uint8_t engine;
 
 } timer_global_t;
 
@@ -280,13 +323,219 @@ static odp_timeout_hdr_t *timeout_hdr(odp_timeout_t tmo)
 	return timeout_hdr_from_buf(buf);
 }
 
+/******************************************************************************
+ * Hierarchical timing wheel
+ * Wheel lists are circular, doubly linked lists of timer indexes. All list
+ * operations are done while holding the wheel lock. Timer state (expiration
+ * tick and timeout buffer) is still owned by tick_buf, the wheel only tracks
+ * which timers need to be checked on a scan tick.
+ *****************************************************************************/
+
+static void timer_wheel_init(timer_pool_t *tp, void *addr)
+{
+	timer_wheel_t *wheel = &tp->wheel;
+	uint32_t num_timers = tp->param.num_timers;
+	uint32_t i;
+
+	odp_spinlock_init(&wheel->lock);
+	wheel->next_tick = 0;
+	wheel->num = 0;
+	wheel->node = addr;
+
+	for (i = 0; i < num_timers; i++)
+		wheel->node[i].next = WHEEL_NOT_LINKED;
+
+	/* Empty lists point to themselves */
+	for (i = num_timers; i < num_timers + WHEEL_NUM_LISTS; i++) {
+		wheel->node[i].next = i;
+		wheel->node[i].prev = i;
+	}
+}
+
+static inline uint32_t wheel_head(timer_pool_t *tp, uint32_t list)
+{
+	return tp->param.num_timers + list;
+}
+
+static inline int wheel_list_empty(timer_pool_t *tp, uint32_t list)
+{
+	uint32_t head = wheel_head(tp, list);
+
+	return tp->wheel.node[head].next == head;
+}
+
+static inline void wheel_link(timer_pool_t *tp, uint32_t list, uint32_t idx)
+{
+	wheel_node_t *node = tp->wheel.node;
+	uint32_t head = wheel_head(tp, list);
+	uint32_t tail = node[head].prev;
+
+	node[idx].next  = head;
+	node[idx].prev  = tail;
+	node[tail].next = idx;
+	node[head].prev = idx;
+	tp->wheel.num++;
+}
+
+static inline void wheel_unlink(timer_pool_t *tp, uint32_t idx)
+{
+	wheel_node_t *node = tp->wheel.node;
+	uint32_t next = node[idx].next;
+	uint32_t prev = node[idx].prev;
+
+	node[prev].next = next;
+	node[next].prev = prev;
+	node[idx].next  = WHEEL_NOT_LINKED;
+	tp->wheel.num--;
+}
+
+/* Move all timers of a list to the tail of another list */
+static inline void wheel_splice(timer_pool_t *tp, uint32_t src, uint32_t dst)
+{
+	wheel_node_t *node = tp->wheel.node;
+	uint32_t src_head = wheel_head(tp, src);
+	uint32_t dst_head = wheel_head(tp, dst);
+	uint32_t first = node[src_head].next;
+	uint32_t last = node[src_head].prev;
+	uint32_t tail = node[dst_head].prev;
+
+	if (first == src_head)
+		return;
+
+	node[tail].next     = first;
+	node[first].prev    = tail;
+	node[last].next     = dst_head;
+	node[dst_head].prev = last;
+	node[src_head].next = src_head;
+	node[src_head].prev = src_head;
+}
+
+/* Select wheel list for a timer expiring on scan tick 'tick' */
+static inline uint32_t wheel_list(timer_pool_t *tp, uint64_t tick)
+{
+	uint64_t next_tick = tp->wheel.next_tick;
+	uint64_t delta;
+	int level;
+
+	/* Timer expires on the next scan tick, at the earliest */
+	if (tick < next_tick)
+		tick = next_tick;
+
+	delta = tick - next_tick;
+
+	for (level = 0; level < WHEEL_LEVELS; level++) {
+		int shift = WHEEL_SLOT_BITS * level;
+
+		if (delta < (1ULL << (shift + WHEEL_SLOT_BITS)))
+			return (level * WHEEL_SLOTS) +
+			       ((tick >> shift) & WHEEL_SLOT_MASK);
+	}
+
+	return WHEEL_OVERFLOW;
+}
+
+/* (Re)link timer into the wheel list that matches its expiration time.
+ * Called with the wheel lock held. */
+static inline void wheel_insert(timer_pool_t *tp, uint32_t idx, uint64_t nsec)
+{
+	if (tp->wheel.node[idx].next != WHEEL_NOT_LINKED)
+		wheel_unlink(tp, idx);
+
+	wheel_link(tp, wheel_list(tp, nsec / tp->nsec_per_scan), idx);
+}
+
+static inline void timer_wheel_set(timer_pool_t *tp, uint32_t idx,
+				   uint64_t abs_tck)
+{
+	odp_spinlock_lock(&tp->wheel.lock);
+	wheel_insert(tp, idx, abs_tck);
+	odp_spinlock_unlock(&tp->wheel.lock);
+}
+
+static inline void timer_wheel_remove(timer_pool_t *tp, uint32_t idx)
+{
+	odp_spinlock_lock(&tp->wheel.lock);
+	if (tp->wheel.node[idx].next != WHEEL_NOT_LINKED)
+		wheel_unlink(tp, idx);
+	odp_spinlock_unlock(&tp->wheel.lock);
+}
+
+/* Move timers of a wheel slot to lower levels (or to the drain list) */
+static inline void wheel_cascade(timer_pool_t *tp, uint32_t list)
+{
+	wheel_node_t *node = tp->wheel.node;
+	uint32_t head = wheel_head(tp, list);
+	uint32_t idx, next;
+	uint64_t exp_tck;
+
+	idx = node[head].next;
+	node[head].next = head;
+	node[head].prev = head;
+
+	while (idx != head) {
+		next = node[idx].next;
+		tp->wheel.num--;
+		exp_tck = tp->tick_buf[idx].exp_tck.v;
+
+		/* Drop inactive timers here. A racing timer set operation
+		 * links the timer again after updating tick_buf. */
+		if (exp_tck & TMO_INACTIVE) {
+			node[idx].next = WHEEL_NOT_LINKED;
+		} else {
+			wheel_link(tp, wheel_list(tp, exp_tck /
+						  tp->nsec_per_scan), idx);
+		}
+
+		idx = next;
+	}
+}
+
+/* Advance the wheel up to 'tick' and move timers of the passed level zero
+ * slots onto the drain list. Called with the wheel lock held. */
+static inline void wheel_advance(timer_pool_t *tp, uint64_t tick)
+{
+	timer_wheel_t *wheel = &tp->wheel;
+	uint64_t cur;
+	int level;
+
+	if (wheel->num == 0) {
+		/* Nothing to process on the passed ticks */
+		if (wheel->next_tick <= tick)
+			wheel->next_tick = tick + 1;
+		return;
+	}
+
+	while (wheel->next_tick <= tick) {
+		cur = wheel->next_tick;
+
+		/* Overflow list is checked every time the wheel wraps */
+		if ((cur & ((1ULL << (WHEEL_SLOT_BITS * WHEEL_LEVELS)) - 1))
+		    == 0)
+			wheel_cascade(tp, WHEEL_OVERFLOW);
+
+		/* Cascade higher level slots when lower levels wrap */
+		for (level = WHEEL_LEVELS - 1; level > 0; level--) {
+			int shift = WHEEL_SLOT_BITS * level;
+
+			if ((cur & ((1ULL << shift) - 1)) == 0)
+				wheel_cascade(tp, (level * WHEEL_SLOTS) +
+					      ((cur >> shift) &
+					       WHEEL_SLOT_MASK));
+		}
+
+		wheel_splice(tp, cur & WHEEL_SLOT_MASK, WHEEL_DRAIN);
+		wheel->next_tick = cur + 1;
+	}
+}
+
 static odp_timer_pool_t timer_pool_new(const char *name,
 				       const odp_timer_pool_param_t *param)
 {
 	uint32_t i;
 	int tp_idx;
-	size_t sz0, sz1, sz2;
+	size_t sz0, sz1, sz2, sz3;
 	uint64_t tp_size;
+	int engine = timer_global->engine;
 	uint64_t res_ns, nsec_per_scan;
 	uint32_t flags = ODP_SHM_SW_ONLY;
 
@@ -317,13 +566,17 @@ static odp_timer_pool_t timer_pool_new(const char *name,
 	sz1 = ROUNDUP_CACHE_LINE(sizeof(tick_buf_t) * param->num_timers);
 	sz2 = ROUNDUP_CACHE_LINE(sizeof(_odp_timer_t) *
 				 param->num_timers);
-	tp_size = sz0 + sz1 + sz2;
+	sz3 = 0;
+	if (engine == TIMER_ENGINE_WHEEL)
+		sz3 = ROUNDUP_CACHE_LINE(sizeof(wheel_node_t) *
+					 (param->num_timers + WHEEL_NUM_LISTS));
+	tp_size = sz0 + sz1 + sz2 + sz3;
 
 	odp_shm_t shm = odp_shm_reserve(name, tp_size, ODP_CACHE_LINE_SIZE,
 					flags);
 	if (odp_unlikely(shm == ODP_SHM_INVALID))
 		ODP_ABORT("%s: timer pool shm-alloc(%zuKB) failed\n",
-			  name, (sz0 + sz1 + sz2) / 1024);
+			  name, tp_size / 1024);
 	timer_pool_t *tp = (timer_pool_t *)odp_shm_addr(shm);
 
 	memset(tp, 0, tp_size);
@@ -382,6 +635,12 @@ static odp_timer_pool_t timer_pool_new(const char *name,
 	}
 	tp->tp_idx = tp_idx;
 	odp_spinlock_init(&tp->lock);
+
+	tp->engine = engine;
+	if (engine == TIMER_ENGINE_WHEEL)
+		timer_wheel_init(tp, (char *)odp_shm_addr(shm) + sz0 + sz1 +
+				 sz2);
+
 	tp->start_time = odp_time_global();
 
 	odp_ticketlock_lock(&timer_global->lock);
@@ -533,6 +792,9 @@ static inline odp_buffer_t timer_free(timer_pool_t *tp, uint32_t idx)
 	 * grab any timeout buffer */
 	odp_buffer_t old_buf = timer_set_unused(tp, idx);
 
+	if (tp->engine == TIMER_ENGINE_WHEEL)
+		timer_wheel_remove(tp, idx);
+
 	/* Remove timer from queue */
 	queue_fn->timer_rem(tim->queue);
 
@@ -909,6 +1171,64 @@ static inline void timer_pool_scan(timer_pool_t *tp, uint64_t tick)
 	}
 }
 
+static inline void timer_wheel_run(timer_pool_t *tp, uint64_t nsec)
+{
+	wheel_node_t *node = tp->wheel.node;
+	uint32_t head = wheel_head(tp, WHEEL_DRAIN);
+	uint32_t idx[WHEEL_BURST];
+	uint64_t exp_tck;
+	int num, i;
+
+	odp_spinlock_lock(&tp->wheel.lock);
+	wheel_advance(tp, nsec / tp->nsec_per_scan);
+
+	while (!wheel_list_empty(tp, WHEEL_DRAIN)) {
+		/* Expire timers outside of the lock, a burst at a time */
+		for (num = 0; num < WHEEL_BURST; num++) {
+			if (node[head].next == head)
+				break;
+
+			idx[num] = node[head].next;
+			wheel_unlink(tp, idx[num]);
+		}
+
+		odp_spinlock_unlock(&tp->wheel.lock);
+
+		for (i = 0; i < num; i++) {
+			exp_tck = tp->tick_buf[idx[i]].exp_tck.v;
+
+			if (odp_likely(exp_tck <= nsec))
+				timer_expire(tp, idx[i], nsec);
+		}
+
+		odp_spinlock_lock(&tp->wheel.lock);
+
+		/* Timers that were reset to a later time (or expire later
+		 * within the current scan tick) go back into the wheel.
+		 * Timers linked meanwhile by a set operation are already on
+		 * the correct list. */
+		for (i = 0; i < num; i++) {
+			exp_tck = tp->tick_buf[idx[i]].exp_tck.v;
+
+			if ((exp_tck & TMO_INACTIVE) == 0 &&
+			    node[idx[i]].next == WHEEL_NOT_LINKED)
+				wheel_link(tp, wheel_list(tp, exp_tck /
+							  tp->nsec_per_scan),
+					   idx[i]);
+		}
+	}
+
+	odp_spinlock_unlock(&tp->wheel.lock);
+}
+
+static inline void timer_pool_run(timer_pool_t *tp, uint64_t nsec)
+{
+	if (tp->engine == TIMER_ENGINE_WHEEL)
+		timer_wheel_run(tp, nsec);
+	else
+		timer_pool_scan(tp, nsec);
+}
+
 /******************************************************************************
  * Inline timer processing
  *****************************************************************************/
@@ -972,7 +1292,7 @@ static inline void timer_pool_scan_inline(int num, odp_time_t now)
 					tp->notify_overrun = 0;
 				}
 			}
-			timer_pool_scan(tp, nsec);
+			timer_pool_run(tp, nsec);
 		}
 	}
 }
@@ -1036,7 +1356,7 @@ static inline void timer_run_posix(timer_pool_t *tp)
 		__builtin_prefetch(&array[i], 0, 0);
 
 	nsec = current_nsec(tp);
-	timer_pool_scan(tp, nsec);
+	timer_pool_run(tp, nsec);
 }
 
 static void *timer_thread(void *arg)
@@ -1403,10 +1723,13 @@ int odp_timer_set_abs(odp_timer_t hdl,
 		return ODP_TIMER_TOOEARLY;
 	if (odp_unlikely(abs_tck > cur_tick + tp->max_rel_tck))
 		return ODP_TIMER_TOOLATE;
-	if (timer_reset(idx, abs_tck, (odp_buffer_t *)tmo_ev, tp))
-		return ODP_TIMER_SUCCESS;
-	else
+	if (!timer_reset(idx, abs_tck, (odp_buffer_t *)tmo_ev, tp))
 		return ODP_TIMER_NOEVENT;
+
+	if (tp->engine == TIMER_ENGINE_WHEEL)
+		timer_wheel_set(tp, idx, abs_tck);
+
+	return ODP_TIMER_SUCCESS;
 }
 
 int odp_timer_set_rel(odp_timer_t hdl,
@@ -1422,10 +1745,13 @@ int odp_timer_set_rel(odp_timer_t hdl,
 		return ODP_TIMER_TOOEARLY;
 	if (odp_unlikely(rel_tck > tp->max_rel_tck))
 		return ODP_TIMER_TOOLATE;
-	if (timer_reset(idx, abs_tck, (odp_buffer_t *)tmo_ev, tp))
-		return ODP_TIMER_SUCCESS;
-	else
+	if (!timer_reset(idx, abs_tck, (odp_buffer_t *)tmo_ev, tp))
 		return ODP_TIMER_NOEVENT;
+
+	if (tp->engine == TIMER_ENGINE_WHEEL)
+		timer_wheel_set(tp, idx, abs_tck);
+
+	return ODP_TIMER_SUCCESS;
 }
 
 int odp_timer_cancel(odp_timer_t hdl, odp_event_t *tmo_ev)
@@ -1580,6 +1906,18 @@ int _odp_timer_init_global(const odp_init_t *params)
 	}
 	timer_global->thread_type = val;
 
+	conf_str =  "timer.engine";
+	if (!_odp_libconfig_lookup_int(conf_str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", conf_str);
+		goto error;
+	}
+
+	if (val != TIMER_ENGINE_SCAN && val != TIMER_ENGINE_WHEEL) {
+		ODP_ERR("Bad value %s = %i\n", conf_str, val);
+		goto error;
+	}
+	timer_global->engine = val;
+
 	if (!timer_global->use_inline_timers) {
 		timer_res_init();
 		block_sigalarm();
@@ -16,6 +16,9 @@ const pktio_if_ops_t * const pktio_if_ops[]  = {
 #ifdef _ODP_PKTIO_DPDK
 	&dpdk_pktio_ops,
 #endif
+#ifdef _ODP_PKTIO_XDP
+	&sock_xdp_pktio_ops,
+#endif
 #ifdef _ODP_PKTIO_NETMAP
 	&netmap_pktio_ops,
 #endif
@@ -25,6 +28,9 @@ const pktio_if_ops_t * const pktio_if_ops[]  = {
 	&ipc_pktio_ops,
 	&tap_pktio_ops,
 	&null_pktio_ops,
+#ifdef _ODP_PKTIO_IO_URING
+	&sock_uring_pktio_ops,
+#endif
 	&sock_mmap_pktio_ops,
 	&sock_mmsg_pktio_ops,
 	NULL
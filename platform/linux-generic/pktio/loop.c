@@ -18,6 +18,8 @@
 #include <odp_queue_if.h>
 #include <odp/api/plat/queue_inlines.h>
 #include <odp_global_data.h>
+#include <odp_pool_internal.h>
+#include <odp_ring_spsc_internal.h>
 
 #include <protocols/eth.h>
 #include <protocols/ip.h>
@@ -30,8 +32,61 @@
 #define MAX_LOOP 16
 #define LOOP_MTU (64 * 1024)
 
+/* Maximum number of input and output queues */
+#define LOOP_MAX_QUEUES 32
+
+/* Number of packets buffered per input queue. Each input queue has a ring per
+ * output queue, and this space is divided evenly between those rings. */
+#define LOOP_QUEUE_SIZE 4096
+
+ODP_STATIC_ASSERT(CHECK_IS_POWER2(LOOP_QUEUE_SIZE) &&
+		  CHECK_IS_POWER2(LOOP_MAX_QUEUES) &&
+		  LOOP_QUEUE_SIZE / LOOP_MAX_QUEUES > QUEUE_MULTI_MAX,
+		  "Bad loop queue size");
+
+/* Input queue */
+typedef struct ODP_ALIGNED_CACHE {
+	odp_ticketlock_t lock;
+	/* Ring (output queue) to poll first */
+	uint32_t next;
+	uint64_t octets;
+	uint64_t packets;
+	uint64_t errors;
+} loop_rxq_t;
+
+/* Output queue */
+typedef struct ODP_ALIGNED_CACHE {
+	odp_ticketlock_t lock;
+	uint64_t octets;
+	uint64_t packets;
+} loop_txq_t;
+
+/* Single producer, single consumer ring from an output queue to an input
+ * queue. Ring data is packet buffer indexes. */
+typedef struct ODP_ALIGNED_CACHE {
+	ring_spsc_t hdr;
+	uint32_t *data;
+} loop_ring_t;
+
+typedef struct {
+	loop_rxq_t rxq[LOOP_MAX_QUEUES];
+	loop_txq_t txq[LOOP_MAX_QUEUES];
+	/* Ring from output queue 'o' to input queue 'i' is at index
+	 * (i * num_txq + o) */
+	loop_ring_t ring[LOOP_MAX_QUEUES * LOOP_MAX_QUEUES];
+	uint32_t ring_data[LOOP_MAX_QUEUES * LOOP_QUEUE_SIZE];
+} loop_shm_t;
+
 typedef struct {
-	odp_queue_t loopq;		/**< loopback queue for "loop" device */
+	loop_shm_t *shm_addr;		/**< rings and queue state */
+	odp_shm_t shm;			/**< shm of 'shm_addr' */
+	odp_cls_hash_proto_t hash_proto; /**< hash protocols */
+	uint32_t num_rxq;		/**< number of input queue rings */
+	uint32_t num_txq;		/**< number of output queue rings */
+	uint32_t ring_mask;		/**< ring size - 1 */
+	odp_bool_t hash;		/**< hash packets to input queues */
+	odp_bool_t lockless_rx;		/**< no locking for rx */
+	odp_bool_t lockless_tx;		/**< no locking for tx */
 	odp_bool_t promisc;		/**< promiscuous mode state */
 	uint8_t idx;			/**< index of "loop" device */
 } pkt_loop_t;
@@ -50,11 +105,71 @@ static const char pktio_loop_mac[] = {0x02, 0xe9, 0x34, 0x80, 0x73, 0x01};
 static int loopback_stats_reset(pktio_entry_t *pktio_entry);
 static int loopback_init_capability(pktio_entry_t *pktio_entry);
 
+static inline loop_ring_t *loop_ring(pkt_loop_t *pkt_loop, uint32_t rxq,
+				     uint32_t txq)
+{
+	return &pkt_loop->shm_addr->ring[rxq * pkt_loop->num_txq + txq];
+}
+
+/* Free all packets in the rings */
+static void loop_rings_flush(pkt_loop_t *pkt_loop)
+{
+	uint32_t buf_idx[QUEUE_MULTI_MAX];
+	odp_packet_t pkt[QUEUE_MULTI_MAX];
+	uint32_t i, o, j, num;
+
+	for (i = 0; i < pkt_loop->num_rxq; i++) {
+		for (o = 0; o < pkt_loop->num_txq; o++) {
+			loop_ring_t *ring = loop_ring(pkt_loop, i, o);
+
+			do {
+				num = ring_spsc_deq_multi(&ring->hdr,
+							  ring->data,
+							  pkt_loop->ring_mask,
+							  buf_idx,
+							  QUEUE_MULTI_MAX);
+				for (j = 0; j < num; j++)
+					pkt[j] = packet_from_buf_hdr(buf_hdr_from_index_u32(buf_idx[j]));
+
+				odp_packet_free_multi(pkt, num);
+			} while (num);
+		}
+	}
+}
+
+/* Create a ring for each input and output queue pair. Input queue space is
+ * divided between rings of the output queues. */
+static void loop_rings_init(pkt_loop_t *pkt_loop, uint32_t num_rxq,
+			    uint32_t num_txq)
+{
+	loop_shm_t *shm = pkt_loop->shm_addr;
+	uint32_t ring_size = LOOP_QUEUE_SIZE / ROUNDUP_POWER2_U32(num_txq);
+	uint32_t i, o;
+
+	pkt_loop->num_rxq = num_rxq;
+	pkt_loop->num_txq = num_txq;
+	pkt_loop->ring_mask = ring_size - 1;
+
+	for (i = 0; i < num_rxq; i++) {
+		shm->rxq[i].next = 0;
+
+		for (o = 0; o < num_txq; o++) {
+			loop_ring_t *ring = loop_ring(pkt_loop, i, o);
+
+			ring_spsc_init(&ring->hdr);
+			ring->data = &shm->ring_data[i * LOOP_QUEUE_SIZE +
+						     o * ring_size];
+		}
+	}
+}
+
 static int loopback_open(odp_pktio_t id, pktio_entry_t *pktio_entry,
 			 const char *devname, odp_pool_t pool ODP_UNUSED)
 {
+	pkt_loop_t *pkt_loop = pkt_priv(pktio_entry);
 	long idx;
-	char loopq_name[ODP_QUEUE_NAME_LEN];
+	char shm_name[ODP_SHM_NAME_LEN];
+	uint32_t i;
 
 	if (!strcmp(devname, "loop")) {
 		idx = 0;
@@ -68,15 +183,26 @@ static int loopback_open(odp_pktio_t id, pktio_entry_t *pktio_entry,
 		return -1;
 	}
 
-	snprintf(loopq_name, sizeof(loopq_name), "%" PRIu64 "-pktio_loopq",
-		 odp_pktio_to_u64(id));
-	pkt_priv(pktio_entry)->loopq =
-		odp_queue_create(loopq_name, NULL);
-	pkt_priv(pktio_entry)->idx = idx;
+	memset(pkt_loop, 0, sizeof(pkt_loop_t));
 
-	if (pkt_priv(pktio_entry)->loopq == ODP_QUEUE_INVALID)
+	snprintf(shm_name, sizeof(shm_name), "_odp_pktio_loop_%" PRIu64,
+		 odp_pktio_to_u64(id));
+	pkt_loop->shm = odp_shm_reserve(shm_name, sizeof(loop_shm_t),
+					ODP_CACHE_LINE_SIZE, 0);
+	if (pkt_loop->shm == ODP_SHM_INVALID) {
+		ODP_ERR("shm reserve failed\n");
 		return -1;
+	}
+
+	pkt_loop->shm_addr = odp_shm_addr(pkt_loop->shm);
+	pkt_loop->idx = idx;
+
+	for (i = 0; i < LOOP_MAX_QUEUES; i++) {
+		odp_ticketlock_init(&pkt_loop->shm_addr->rxq[i].lock);
+		odp_ticketlock_init(&pkt_loop->shm_addr->txq[i].lock);
+	}
 
+	loop_rings_init(pkt_loop, 1, 1);
 	loopback_stats_reset(pktio_entry);
 	loopback_init_capability(pktio_entry);
 
@@ -85,29 +211,74 @@ static int loopback_open(odp_pktio_t id, pktio_entry_t *pktio_entry,
 
 static int loopback_close(pktio_entry_t *pktio_entry)
 {
-	return odp_queue_destroy(pkt_priv(pktio_entry)->loopq);
+	pkt_loop_t *pkt_loop = pkt_priv(pktio_entry);
+
+	loop_rings_flush(pkt_loop);
+
+	return odp_shm_free(pkt_loop->shm);
+}
+
+static int loopback_start(pktio_entry_t *pktio_entry)
+{
+	pkt_loop_t *pkt_loop = pkt_priv(pktio_entry);
+	uint32_t num_rxq = 1;
+	uint32_t num_txq = 1;
+
+	if (pktio_entry->s.param.in_mode != ODP_PKTIN_MODE_DISABLED &&
+	    pktio_entry->s.num_in_queue > 1)
+		num_rxq = pktio_entry->s.num_in_queue;
+
+	if (pktio_entry->s.param.out_mode != ODP_PKTOUT_MODE_DISABLED &&
+	    pktio_entry->s.num_out_queue > 1)
+		num_txq = pktio_entry->s.num_out_queue;
+
+	/* Packets stay in the rings over stop and start, unless the number
+	 * of queues changes */
+	if (num_rxq != pkt_loop->num_rxq || num_txq != pkt_loop->num_txq) {
+		loop_rings_flush(pkt_loop);
+		loop_rings_init(pkt_loop, num_rxq, num_txq);
+	}
+
+	return 0;
 }
 
-static int loopback_recv(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
+static int loopback_recv(pktio_entry_t *pktio_entry, int index,
 			 odp_packet_t pkts[], int num)
 {
+	pkt_loop_t *pkt_loop = pkt_priv(pktio_entry);
+	loop_rxq_t *rxq = &pkt_loop->shm_addr->rxq[index];
+	uint32_t num_txq = pkt_loop->num_txq;
 	int nbr, i;
-	odp_buffer_hdr_t *hdr_tbl[QUEUE_MULTI_MAX];
-	odp_queue_t queue;
+	uint32_t buf_idx[QUEUE_MULTI_MAX];
+	uint32_t o, j;
 	odp_packet_hdr_t *pkt_hdr;
 	odp_packet_t pkt;
 	odp_time_t ts_val;
 	odp_time_t *ts = NULL;
 	int num_rx = 0;
 	int failed = 0;
+	uint64_t octets = 0;
 
 	if (odp_unlikely(num > QUEUE_MULTI_MAX))
 		num = QUEUE_MULTI_MAX;
 
-	odp_ticketlock_lock(&pktio_entry->s.rxl);
-
-	queue = pkt_priv(pktio_entry)->loopq;
-	nbr = odp_queue_deq_multi(queue, (odp_event_t *)hdr_tbl, num);
+	if (!pkt_loop->lockless_rx)
+		odp_ticketlock_lock(&rxq->lock);
+
+	/* Poll rings of all output queues. Start from a different ring on
+	 * each call, so that no output queue gets preference. */
+	nbr = 0;
+	o = rxq->next;
+	for (j = 0; j < num_txq && nbr < num; j++) {
+		loop_ring_t *ring = loop_ring(pkt_loop, index, o);
+
+		nbr += ring_spsc_deq_multi(&ring->hdr, ring->data,
+					   pkt_loop->ring_mask, &buf_idx[nbr],
+					   num - nbr);
+		if (++o == num_txq)
+			o = 0;
+	}
+	rxq->next = rxq->next + 1 < num_txq ? rxq->next + 1 : 0;
 
 	if (pktio_entry->s.config.pktin.bit.ts_all ||
 	    pktio_entry->s.config.pktin.bit.ts_ptp) {
@@ -118,10 +289,9 @@ static int loopback_recv(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 	for (i = 0; i < nbr; i++) {
 		uint32_t pkt_len;
 
-		pkt = packet_from_buf_hdr(hdr_tbl[i]);
+		pkt = packet_from_buf_hdr(buf_hdr_from_index_u32(buf_idx[i]));
 		pkt_len = odp_packet_len(pkt);
 		pkt_hdr = packet_hdr(pkt);
-
 		packet_parse_reset(pkt_hdr, 1);
 		if (pktio_cls_enabled(pktio_entry)) {
 			odp_packet_t new_pkt;
@@ -181,14 +351,16 @@ static int loopback_recv(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 		    odp_packet_has_ipsec(pkt))
 			_odp_ipsec_try_inline(&pkt);
 
-		pktio_entry->s.stats.in_octets += pkt_len;
+		octets += pkt_len;
 		pkts[num_rx++] = pkt;
 	}
 
-	pktio_entry->s.stats.in_errors += failed;
-	pktio_entry->s.stats.in_ucast_pkts += num_rx - failed;
+	rxq->octets += octets;
+	rxq->errors += failed;
+	rxq->packets += num_rx - failed;
 
-	odp_ticketlock_unlock(&pktio_entry->s.rxl);
+	if (!pkt_loop->lockless_rx)
+		odp_ticketlock_unlock(&rxq->lock);
 
 	return num_rx;
 }
@@ -281,11 +453,79 @@ static inline void loopback_fix_checksums(odp_packet_t pkt,
 		_odp_packet_sctp_chksum_insert(pkt);
 }
 
-static int loopback_send(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
+/* Calculate RSS hash of a packet. Uses the same hash function as the
+ * classifier. */
+static inline uint32_t loopback_hash(odp_packet_t pkt,
+				     odp_cls_hash_proto_t hash_proto)
+{
+	packet_parser_t prs;
+	odp_proto_chksums_t chksums;
+	uint8_t buf[PACKET_PARSE_SEG_LEN];
+	const uint8_t *pkt_addr = odp_packet_data(pkt);
+	uint32_t pkt_len = odp_packet_len(pkt);
+	uint32_t seg_len = odp_packet_seg_len(pkt);
+
+	/* Make sure there is enough data for the packet parser in the case
+	 * of a segmented packet. */
+	if (odp_unlikely(seg_len < PACKET_PARSE_SEG_LEN &&
+			 pkt_len > PACKET_PARSE_SEG_LEN)) {
+		odp_packet_copy_to_mem(pkt, 0, PACKET_PARSE_SEG_LEN, buf);
+		seg_len = PACKET_PARSE_SEG_LEN;
+		pkt_addr = buf;
+	}
+
+	prs.input_flags.all = 0;
+	prs.flags.all_flags = 0;
+	prs.l2_offset = ODP_PACKET_OFFSET_INVALID;
+	prs.l3_offset = ODP_PACKET_OFFSET_INVALID;
+	prs.l4_offset = ODP_PACKET_OFFSET_INVALID;
+	chksums.all_chksum = 0;
+
+	packet_parse_common(&prs, pkt_addr, pkt_len, seg_len,
+			    ODP_PROTO_LAYER_L4, chksums);
+
+	return packet_rss_hash(&prs, hash_proto, pkt_addr);
+}
+
+/* Enqueue packets into input queue rings of an output queue. Consecutive
+ * packets to the same input queue are enqueued together. Stops at the
+ * first ring that is full. */
+static inline int loopback_enq(pkt_loop_t *pkt_loop, uint32_t txq,
+			       const odp_packet_t pkt_tbl[],
+			       const uint32_t rxq_tbl[], int num)
+{
+	uint32_t buf_idx[QUEUE_MULTI_MAX];
+	int i, j, num_enq;
+	int ret = 0;
+
+	for (i = 0; i < num; i++)
+		buf_idx[i] = packet_to_buf_hdr(pkt_tbl[i])->index.u32;
+
+	for (i = 0; i < num; i = j) {
+		loop_ring_t *ring = loop_ring(pkt_loop, rxq_tbl[i], txq);
+
+		for (j = i + 1; j < num && rxq_tbl[j] == rxq_tbl[i]; j++)
+			;
+
+		num_enq = ring_spsc_enq_multi(&ring->hdr, ring->data,
+					      pkt_loop->ring_mask,
+					      &buf_idx[i], j - i);
+		ret += num_enq;
+
+		if (num_enq < j - i)
+			break;
+	}
+
+	return ret;
+}
+
+static int loopback_send(pktio_entry_t *pktio_entry, int index,
 			 const odp_packet_t pkt_tbl[], int num)
 {
-	odp_buffer_hdr_t *hdr_tbl[QUEUE_MULTI_MAX];
-	odp_queue_t queue;
+	pkt_loop_t *pkt_loop = pkt_priv(pktio_entry);
+	loop_txq_t *txq = &pkt_loop->shm_addr->txq[index];
+	uint32_t rxq_tbl[QUEUE_MULTI_MAX];
+	uint32_t num_rxq = pkt_loop->num_rxq;
 	int i;
 	int ret;
 	int nb_tx = 0;
@@ -310,10 +550,9 @@ static int loopback_send(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 			}
 			break;
 		}
-		hdr_tbl[i] = packet_to_buf_hdr(pkt_tbl[i]);
 		bytes += pkt_len;
 		/* Store cumulative byte counts to update 'stats.out_octets'
-		 * correctly in case enq_multi() fails to enqueue all packets.
+		 * correctly in case all packets are not enqueued.
 		 */
 		out_octets_tbl[i] = bytes;
 		nb_tx++;
@@ -340,23 +579,33 @@ static int loopback_send(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 	for (i = 0; i < nb_tx; ++i)
 		loopback_fix_checksums(pkt_tbl[i], pktout_cfg, pktout_capa);
 
-	odp_ticketlock_lock(&pktio_entry->s.txl);
+	/* Select input queues. Without hashing, output queues are mapped
+	 * to input queues one-to-one (modulo number of input queues). */
+	if (pkt_loop->hash && num_rxq > 1) {
+		for (i = 0; i < nb_tx; ++i)
+			rxq_tbl[i] = loopback_hash(pkt_tbl[i],
+						   pkt_loop->hash_proto) %
+				     num_rxq;
+	} else {
+		for (i = 0; i < nb_tx; ++i)
+			rxq_tbl[i] = index % num_rxq;
+	}
+
+	if (!pkt_loop->lockless_tx)
+		odp_ticketlock_lock(&txq->lock);
 
-	queue = pkt_priv(pktio_entry)->loopq;
-	ret = odp_queue_enq_multi(queue, (odp_event_t *)hdr_tbl, nb_tx);
+	ret = loopback_enq(pkt_loop, index, pkt_tbl, rxq_tbl, nb_tx);
 
 	if (ret > 0) {
 		if (odp_unlikely(tx_ts_idx) && ret >= tx_ts_idx)
 			_odp_pktio_tx_ts_set(pktio_entry);
 
-		pktio_entry->s.stats.out_ucast_pkts += ret;
-		pktio_entry->s.stats.out_octets += out_octets_tbl[ret - 1];
-	} else {
-		ODP_DBG("queue enqueue failed %i\n", ret);
-		ret = -1;
+		txq->packets += ret;
+		txq->octets += out_octets_tbl[ret - 1];
 	}
 
-	odp_ticketlock_unlock(&pktio_entry->s.txl);
+	if (!pkt_loop->lockless_tx)
+		odp_ticketlock_unlock(&txq->lock);
 
 	return ret;
 }
@@ -401,8 +650,8 @@ static int loopback_init_capability(pktio_entry_t *pktio_entry)
 
 	memset(capa, 0, sizeof(odp_pktio_capability_t));
 
-	capa->max_input_queues  = 1;
-	capa->max_output_queues = 1;
+	capa->max_input_queues  = LOOP_MAX_QUEUES;
+	capa->max_output_queues = LOOP_MAX_QUEUES;
 	capa->set_op.op.promisc_mode = 1;
 
 	odp_pktio_config_init(&capa->config);
@@ -454,16 +703,67 @@ static int loopback_promisc_mode_get(pktio_entry_t *pktio_entry)
 	return pkt_priv(pktio_entry)->promisc ? 1 : 0;
 }
 
+static int loopback_input_queues_config(pktio_entry_t *pktio_entry,
+					const odp_pktin_queue_param_t *p)
+{
+	pkt_loop_t *pkt_loop = pkt_priv(pktio_entry);
+	odp_pktin_mode_t mode = pktio_entry->s.param.in_mode;
+
+	/* Scheduler synchronizes input queue polls. Only single thread
+	 * at a time polls a queue */
+	if (mode == ODP_PKTIN_MODE_SCHED)
+		pkt_loop->lockless_rx = 1;
+	else
+		pkt_loop->lockless_rx = (p->op_mode == ODP_PKTIO_OP_MT_UNSAFE);
+
+	pkt_loop->hash = p->hash_enable;
+	pkt_loop->hash_proto.all = 0;
+	_odp_cls_update_hash_proto(&pkt_loop->hash_proto, p->hash_proto);
+
+	return 0;
+}
+
+static int loopback_output_queues_config(pktio_entry_t *pktio_entry,
+					 const odp_pktout_queue_param_t *p)
+{
+	pkt_priv(pktio_entry)->lockless_tx =
+		(p->op_mode == ODP_PKTIO_OP_MT_UNSAFE);
+
+	return 0;
+}
+
 static int loopback_stats(pktio_entry_t *pktio_entry,
 			  odp_pktio_stats_t *stats)
 {
-	memcpy(stats, &pktio_entry->s.stats, sizeof(odp_pktio_stats_t));
+	loop_shm_t *shm = pkt_priv(pktio_entry)->shm_addr;
+	int i;
+
+	memset(stats, 0, sizeof(odp_pktio_stats_t));
+
+	for (i = 0; i < LOOP_MAX_QUEUES; i++) {
+		stats->in_octets += shm->rxq[i].octets;
+		stats->in_ucast_pkts += shm->rxq[i].packets;
+		stats->in_errors += shm->rxq[i].errors;
+		stats->out_octets += shm->txq[i].octets;
+		stats->out_ucast_pkts += shm->txq[i].packets;
+	}
+
 	return 0;
 }
 
-static int loopback_stats_reset(pktio_entry_t *pktio_entry ODP_UNUSED)
+static int loopback_stats_reset(pktio_entry_t *pktio_entry)
 {
-	memset(&pktio_entry->s.stats, 0, sizeof(odp_pktio_stats_t));
+	loop_shm_t *shm = pkt_priv(pktio_entry)->shm_addr;
+	int i;
+
+	for (i = 0; i < LOOP_MAX_QUEUES; i++) {
+		shm->rxq[i].octets = 0;
+		shm->rxq[i].packets = 0;
+		shm->rxq[i].errors = 0;
+		shm->txq[i].octets = 0;
+		shm->txq[i].packets = 0;
+	}
+
 	return 0;
 }
 
@@ -481,7 +781,7 @@ const pktio_if_ops_t loopback_pktio_ops = {
 	.term = NULL,
 	.open = loopback_open,
 	.close = loopback_close,
-	.start = NULL,
+	.start = loopback_start,
 	.stop = NULL,
 	.stats = loopback_stats,
 	.stats_reset = loopback_stats_reset,
@@ -499,6 +799,6 @@ const pktio_if_ops_t loopback_pktio_ops = {
 	.pktio_ts_from_ns = NULL,
 	.pktio_time = NULL,
 	.config = NULL,
-	.input_queues_config = NULL,
-	.output_queues_config = NULL,
+	.input_queues_config = loopback_input_queues_config,
+	.output_queues_config = loopback_output_queues_config,
 };
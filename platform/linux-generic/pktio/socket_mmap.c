@@ -22,6 +22,7 @@
 #include <poll.h>
 #include <sys/ioctl.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <time.h>
 #include <linux/if_packet.h>
 
@@ -37,6 +38,7 @@
 #include <odp_classification_internal.h>
 #include <odp/api/hints.h>
 #include <odp_global_data.h>
+#include <odp_libconfig_internal.h>
 
 #include <protocols/eth.h>
 #include <protocols/ip.h>
@@ -52,43 +54,73 @@
 #define FRAME_MEM_SIZE (4 * 1024 * 1024)
 #define BLOCK_SIZE     (4 * 1024)
 
+/* Block size of TPACKET_V3 RX rings */
+#define BLOCK_SIZE_V3  (128 * 1024)
+
+/* Packet fanout modes selectable with pktio_socket_mmap.fanout_mode */
+#define FANOUT_MODE_QM  0
+#define FANOUT_MODE_CPU 1
+#define FANOUT_MODE_LB  2
+
+#ifndef PACKET_FANOUT_FLAG_UNIQUEID
+#define PACKET_FANOUT_FLAG_UNIQUEID 0x2000
+#endif
+
 /** packet mmap ring */
 struct ring {
 	odp_ticketlock_t lock;
-	struct iovec *rd;
+	/* Current frame (TPACKET_V2) or block (TPACKET_V3) */
 	unsigned int frame_num;
+	/* Number of frames (TPACKET_V2) or blocks (TPACKET_V3) */
 	int rd_num;
+	/* TPACKET_V3: packets left in the current block and pointer to
+	 * the next one */
+	unsigned int pkt_left;
+	uint8_t *next_pkt;
 
-	odp_shm_t shm;
 	int sock;
 	int type;
 	int version;
 	uint8_t *mm_space;
 	size_t mm_len;
-	size_t rd_len;
+	/* Frame (TPACKET_V2) or block (TPACKET_V3) size */
 	int flen;
 
-	struct tpacket_req req;
-};
+	struct tpacket_req3 req;
+} ODP_ALIGNED_CACHE;
 
 ODP_STATIC_ASSERT(offsetof(struct ring, mm_space) <= ODP_CACHE_LINE_SIZE,
 		  "ERR_STRUCT_RING");
 
-/** Packet socket using mmap rings for both Rx and Tx */
+/** Socket mmap runtime configuration options */
+typedef struct {
+	int rx_tpacket_version;
+	int rx_block_timeout_ms;
+	int fanout_mode;
+	int qdisc_bypass;
+} mmap_opt_t;
+
+/** Packet socket using mmap rings for both Rx and Tx. Each input and output
+ * queue has its own socket and ring. */
 typedef struct {
-	/** Packet mmap ring for Rx */
-	struct ring rx_ring ODP_ALIGNED_CACHE;
-	/** Packet mmap ring for Tx */
-	struct ring tx_ring ODP_ALIGNED_CACHE;
+	/** Packet mmap rings for Rx */
+	struct ring *rx_ring;
+	/** Packet mmap rings for Tx */
+	struct ring *tx_ring;
+	/** Ring table */
+	odp_shm_t shm;
+	uint32_t num_rx_ring;
+	uint32_t num_tx_ring;
 
-	int sockfd ODP_ALIGNED_CACHE;
+	int sockfd; /**< Control socket */
+	int if_idx;
 	odp_pool_t pool;
 	int mtu; /**< maximum transmission unit */
-	size_t frame_offset; /**< frame start offset from start of pkt buf */
-	uint8_t *mmap_base;
-	unsigned int mmap_len;
+	int fanout; /**< PACKET_FANOUT mode of multiple Rx rings */
+	odp_bool_t lockless_rx; /**< No locking for rx */
+	odp_bool_t lockless_tx; /**< No locking for tx */
+	mmap_opt_t opt;
 	unsigned char if_mac[ETH_ALEN];
-	struct sockaddr_ll ll;
 } pkt_sock_mmap_t;
 
 ODP_STATIC_ASSERT(PKTIO_PRIVATE_SIZE >= sizeof(pkt_sock_mmap_t),
@@ -101,12 +133,13 @@ static inline pkt_sock_mmap_t *pkt_priv(pktio_entry_t *pktio_entry)
 
 static int disable_pktio; /** !0 this pktio disabled, 0 enabled */
 
-static int mmap_pkt_socket(void)
+static int mmap_pkt_socket(int ver)
 {
-	int ver = TPACKET_V2;
-
-	int ret, sock = socket(PF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+	int ret, sock;
 
+	/* Protocol is set when binding the socket to the interface. Otherwise,
+	 * the socket would receive packets from all interfaces until then. */
+	sock = socket(PF_PACKET, SOCK_RAW, 0);
 	if (sock == -1) {
 		__odp_errno = errno;
 		ODP_ERR("socket(SOCK_RAW): %s\n", strerror(errno));
@@ -129,38 +162,148 @@ static inline unsigned next_frame(unsigned cur_frame, unsigned frame_count)
 	return odp_unlikely(cur_frame + 1 >= frame_count) ? 0 : cur_frame + 1;
 }
 
+static inline void *frame_addr(struct ring *ring, unsigned int idx)
+{
+	return ring->mm_space + (size_t)idx * ring->flen;
+}
+
+/* Copy a received frame into a new packet. Returns 1 when a packet was
+ * received, 0 when the frame was dropped and -1 when the pool is empty
+ * (frame should be left into the ring). */
+static inline int mmap_rx_pkt(pktio_entry_t *pktio_entry,
+			      pkt_sock_mmap_t *pkt_sock, uint8_t *pkt_buf,
+			      int pkt_len, int vlan_valid, uint16_t vlan_tci,
+			      uint16_t vlan_tpid ODP_UNUSED, odp_time_t *ts,
+			      odp_packet_t *pkt_out)
+{
+	odp_packet_t pkt;
+	odp_packet_hdr_t *hdr;
+	odp_packet_hdr_t parsed_hdr;
+	struct ethhdr *eth_hdr;
+	uint32_t alloc_len;
+	odp_pool_t pool = pkt_sock->pool;
+	uint16_t frame_offset = pktio_entry->s.pktin_frame_offset;
+	uint16_t vlan_len = vlan_valid ? 4 : 0;
+	int ret;
+
+	if (odp_unlikely(pkt_len > pkt_sock->mtu)) {
+		ODP_DBG("dropped oversized packet\n");
+		return 0;
+	}
+
+	alloc_len = pkt_len + frame_offset + vlan_len;
+	ret = packet_alloc_multi(pool, alloc_len, &pkt, 1);
+
+	if (odp_unlikely(ret != 1)) {
+		/* Stop receiving packets when pool is empty. Leave
+		 * the current frame into the ring. */
+		return -1;
+	}
+
+	/* Don't receive packets sent by ourselves */
+	eth_hdr = (struct ethhdr *)pkt_buf;
+	if (odp_unlikely(ethaddrs_equal(pkt_sock->if_mac,
+					eth_hdr->h_source))) {
+		odp_packet_free(pkt);
+		return 0;
+	}
+
+	if (pktio_cls_enabled(pktio_entry)) {
+		if (cls_classify_packet(pktio_entry, pkt_buf, pkt_len,
+					pkt_len, &pool, &parsed_hdr,
+					true)) {
+			odp_packet_free(pkt);
+			return 0;
+		}
+	}
+
+	hdr = packet_hdr(pkt);
+	if (frame_offset)
+		pull_head(hdr, frame_offset);
+
+	if (vlan_len)
+		pull_head(hdr, vlan_len);
+
+	ret = odp_packet_copy_from_mem(pkt, 0, pkt_len, pkt_buf);
+	if (ret != 0) {
+		odp_packet_free(pkt);
+		return 0;
+	}
+
+	if (vlan_len) {
+		/* Recreate VLAN header. Move MAC addresses and
+		 * insert a VLAN header in between source MAC address
+		 * and Ethernet type. */
+		uint8_t *mac;
+		uint16_t *type, *tci;
+
+		push_head(hdr, vlan_len);
+		mac = packet_data(hdr);
+		memmove(mac, mac + vlan_len, 2 * _ODP_ETHADDR_LEN);
+		type  = (uint16_t *)(uintptr_t)
+			(mac + 2 * _ODP_ETHADDR_LEN);
+
+		#ifdef TP_STATUS_VLAN_TPID_VALID
+		*type = odp_cpu_to_be_16(vlan_tpid);
+		#else
+		/* Fallback for old kernels (< v3.14) */
+		uint16_t *type2;
+		static int warning_printed;
+
+		if (warning_printed == 0) {
+			ODP_DBG("Original TPID value lost. Using 0x8100 for single tagged and 0x88a8 for double tagged.\n");
+			warning_printed = 1;
+		}
+		type2 = (uint16_t *)(uintptr_t)(mac + (2 * _ODP_ETHADDR_LEN) + vlan_len);
+		/* Recreate TPID 0x88a8 for double tagged and 0x8100 for single tagged */
+		if (*type2 == odp_cpu_to_be_16(0x8100))
+			*type = odp_cpu_to_be_16(0x88a8);
+		else
+			*type = odp_cpu_to_be_16(0x8100);
+		#endif
+
+		tci   = type + 1;
+		*tci  = odp_cpu_to_be_16(vlan_tci);
+	}
+
+	hdr->input = pktio_entry->s.handle;
+
+	if (pktio_cls_enabled(pktio_entry))
+		copy_packet_cls_metadata(&parsed_hdr, hdr);
+	else
+		packet_parse_layer(hdr,
+				   pktio_entry->s.config.parser.layer,
+				   pktio_entry->s.in_chksums);
+
+	packet_set_ts(hdr, ts);
+
+	*pkt_out = pkt;
+	return 1;
+}
+
 static inline unsigned pkt_mmap_v2_rx(pktio_entry_t *pktio_entry,
 				      pkt_sock_mmap_t *pkt_sock,
-				      odp_packet_t pkt_table[], unsigned num,
-				      unsigned char if_mac[])
+				      struct ring *ring,
+				      odp_packet_t pkt_table[], unsigned num)
 {
 	odp_time_t ts_val;
 	odp_time_t *ts = NULL;
 	unsigned frame_num, next_frame_num;
 	uint8_t *pkt_buf, *next_ptr;
-	int pkt_len;
-	uint32_t alloc_len;
-	struct ethhdr *eth_hdr;
 	unsigned i;
 	unsigned nb_rx;
-	struct ring *ring;
-	odp_pool_t pool = pkt_sock->pool;
-	uint16_t frame_offset = pktio_entry->s.pktin_frame_offset;
-	uint16_t vlan_len = 0;
 
 	if (pktio_entry->s.config.pktin.bit.ts_all ||
 	    pktio_entry->s.config.pktin.bit.ts_ptp)
 		ts = &ts_val;
 
-	ring  = &pkt_sock->rx_ring;
 	frame_num = ring->frame_num;
-	next_ptr = ring->rd[frame_num].iov_base;
+	next_ptr = frame_addr(ring, frame_num);
 
 	for (i = 0, nb_rx = 0; i < num; i++) {
 		struct tpacket2_hdr *tp_hdr;
-		odp_packet_t pkt;
-		odp_packet_hdr_t *hdr;
-		odp_packet_hdr_t parsed_hdr;
+		uint16_t vlan_tpid = 0;
+		int vlan_valid;
 		int ret;
 
 		tp_hdr = (void *)next_ptr;
@@ -169,7 +312,7 @@ static inline unsigned pkt_mmap_v2_rx(pktio_entry_t *pktio_entry,
 			break;
 
 		next_frame_num = next_frame(frame_num, ring->rd_num);
-		next_ptr = ring->rd[next_frame_num].iov_base;
+		next_ptr = frame_addr(ring, next_frame_num);
 		odp_prefetch(next_ptr);
 		odp_prefetch(next_ptr + ODP_CACHE_LINE_SIZE);
 
@@ -177,119 +320,108 @@ static inline unsigned pkt_mmap_v2_rx(pktio_entry_t *pktio_entry,
 			ts_val = odp_time_global();
 
 		pkt_buf = (uint8_t *)(void *)tp_hdr + tp_hdr->tp_mac;
-		pkt_len = tp_hdr->tp_snaplen;
-
-		if (odp_unlikely(pkt_len > pkt_sock->mtu)) {
-			tp_hdr->tp_status = TP_STATUS_KERNEL;
-			frame_num = next_frame_num;
-			ODP_DBG("dropped oversized packet\n");
-			continue;
-		}
 
 		/* Check if packet had a VLAN header */
-		if ((tp_hdr->tp_status & VLAN_VALID) == VLAN_VALID)
-			vlan_len = 4;
-
-		alloc_len = pkt_len + frame_offset + vlan_len;
-		ret = packet_alloc_multi(pool, alloc_len, &pkt, 1);
+		vlan_valid = (tp_hdr->tp_status & VLAN_VALID) == VLAN_VALID;
+#ifdef TP_STATUS_VLAN_TPID_VALID
+		vlan_tpid = tp_hdr->tp_vlan_tpid;
+#endif
 
-		if (odp_unlikely(ret != 1)) {
-			/* Stop receiving packets when pool is empty. Leave
-			 * the current frame into the ring. */
+		ret = mmap_rx_pkt(pktio_entry, pkt_sock, pkt_buf,
+				  tp_hdr->tp_snaplen, vlan_valid,
+				  tp_hdr->tp_vlan_tci, vlan_tpid, ts,
+				  &pkt_table[nb_rx]);
+		if (odp_unlikely(ret < 0))
 			break;
-		}
 
-		/* Don't receive packets sent by ourselves */
-		eth_hdr = (struct ethhdr *)pkt_buf;
-		if (odp_unlikely(ethaddrs_equal(if_mac,
-						eth_hdr->h_source))) {
-			odp_packet_free(pkt);
-			tp_hdr->tp_status = TP_STATUS_KERNEL;
-			frame_num = next_frame_num;
-			continue;
-		}
+		tp_hdr->tp_status = TP_STATUS_KERNEL;
+		frame_num = next_frame_num;
+		nb_rx += ret;
+	}
 
-		if (pktio_cls_enabled(pktio_entry)) {
-			if (cls_classify_packet(pktio_entry, pkt_buf, pkt_len,
-						pkt_len, &pool, &parsed_hdr,
-						true)) {
-				odp_packet_free(pkt);
-				tp_hdr->tp_status = TP_STATUS_KERNEL;
-				frame_num = next_frame_num;
-				continue;
-			}
-		}
+	ring->frame_num = frame_num;
+	return nb_rx;
+}
 
-		hdr = packet_hdr(pkt);
-		if (frame_offset)
-			pull_head(hdr, frame_offset);
+static inline void v3_block_release(struct ring *ring)
+{
+	struct tpacket_block_desc *block = frame_addr(ring, ring->frame_num);
 
-		if (vlan_len)
-			pull_head(hdr, vlan_len);
+	__atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL,
+			 __ATOMIC_RELEASE);
+	ring->frame_num = next_frame(ring->frame_num, ring->rd_num);
+}
 
-		ret = odp_packet_copy_from_mem(pkt, 0, pkt_len, pkt_buf);
-		if (ret != 0) {
-			odp_packet_free(pkt);
-			tp_hdr->tp_status = TP_STATUS_KERNEL;
-			frame_num = next_frame_num;
-			continue;
-		}
+static inline unsigned pkt_mmap_v3_rx(pktio_entry_t *pktio_entry,
+				      pkt_sock_mmap_t *pkt_sock,
+				      struct ring *ring,
+				      odp_packet_t pkt_table[], unsigned num)
+{
+	odp_time_t ts_val;
+	odp_time_t *ts = NULL;
+	struct tpacket_block_desc *block;
+	struct tpacket3_hdr *tp_hdr;
+	uint8_t *pkt_buf;
+	uint16_t vlan_tpid = 0;
+	unsigned nb_rx = 0;
+	int vlan_valid;
+	int ret;
+
+	if (pktio_entry->s.config.pktin.bit.ts_all ||
+	    pktio_entry->s.config.pktin.bit.ts_ptp)
+		ts = &ts_val;
+
+	while (nb_rx < num) {
+		/* Open the next block when the previous one has been
+		 * consumed */
+		if (ring->pkt_left == 0) {
+			block = frame_addr(ring, ring->frame_num);
 
-		if (vlan_len) {
-			/* Recreate VLAN header. Move MAC addresses and
-			 * insert a VLAN header in between source MAC address
-			 * and Ethernet type. */
-			uint8_t *mac;
-			uint16_t *type, *tci;
-
-			push_head(hdr, vlan_len);
-			mac = packet_data(hdr);
-			memmove(mac, mac + vlan_len, 2 * _ODP_ETHADDR_LEN);
-			type  = (uint16_t *)(uintptr_t)
-				(mac + 2 * _ODP_ETHADDR_LEN);
-
-			#ifdef TP_STATUS_VLAN_TPID_VALID
-			*type = odp_cpu_to_be_16(tp_hdr->tp_vlan_tpid);
-			#else
-			/* Fallback for old kernels (< v3.14) */
-			uint16_t *type2;
-			static int warning_printed;
-
-			if (warning_printed == 0) {
-				ODP_DBG("Original TPID value lost. Using 0x8100 for single tagged and 0x88a8 for double tagged.\n");
-				warning_printed = 1;
+			if (!(__atomic_load_n(&block->hdr.bh1.block_status,
+					      __ATOMIC_ACQUIRE) &
+			      TP_STATUS_USER))
+				break;
+
+			ring->pkt_left = block->hdr.bh1.num_pkts;
+			ring->next_pkt = (uint8_t *)block +
+					 block->hdr.bh1.offset_to_first_pkt;
+
+			if (odp_unlikely(ring->pkt_left == 0)) {
+				v3_block_release(ring);
+				continue;
 			}
-			type2 = (uint16_t *)(uintptr_t)(mac + (2 * _ODP_ETHADDR_LEN) + vlan_len);
-			/* Recreate TPID 0x88a8 for double tagged and 0x8100 for single tagged */
-			if (*type2 == odp_cpu_to_be_16(0x8100))
-				*type = odp_cpu_to_be_16(0x88a8);
-			else
-				*type = odp_cpu_to_be_16(0x8100);
-			#endif
-
-			tci   = type + 1;
-			*tci  = odp_cpu_to_be_16(tp_hdr->tp_vlan_tci);
 		}
 
-		hdr->input = pktio_entry->s.handle;
+		tp_hdr = (struct tpacket3_hdr *)(void *)ring->next_pkt;
 
-		if (pktio_cls_enabled(pktio_entry))
-			copy_packet_cls_metadata(&parsed_hdr, hdr);
-		else
-			packet_parse_layer(hdr,
-					   pktio_entry->s.config.parser.layer,
-					   pktio_entry->s.in_chksums);
+		if (ring->pkt_left > 1)
+			odp_prefetch(ring->next_pkt + tp_hdr->tp_next_offset);
 
-		packet_set_ts(hdr, ts);
+		if (ts != NULL)
+			ts_val = odp_time_global();
 
-		tp_hdr->tp_status = TP_STATUS_KERNEL;
-		frame_num = next_frame_num;
+		pkt_buf = ring->next_pkt + tp_hdr->tp_mac;
 
-		pkt_table[nb_rx] = pkt;
-		nb_rx++;
+		vlan_valid = (tp_hdr->tp_status & VLAN_VALID) == VLAN_VALID;
+#ifdef TP_STATUS_VLAN_TPID_VALID
+		vlan_tpid = tp_hdr->hv1.tp_vlan_tpid;
+#endif
+
+		ret = mmap_rx_pkt(pktio_entry, pkt_sock, pkt_buf,
+				  tp_hdr->tp_snaplen, vlan_valid,
+				  tp_hdr->hv1.tp_vlan_tci, vlan_tpid, ts,
+				  &pkt_table[nb_rx]);
+		if (odp_unlikely(ret < 0))
+			break;
+
+		nb_rx += ret;
+		ring->next_pkt += tp_hdr->tp_next_offset;
+
+		/* Give the block back to the kernel after the last packet */
+		if (--ring->pkt_left == 0)
+			v3_block_release(ring);
 	}
 
-	ring->frame_num = frame_num;
 	return nb_rx;
 }
 
@@ -310,7 +442,7 @@ static inline int pkt_mmap_v2_tx(pktio_entry_t *pktio_entry, int sock,
 	frame_num = ring->frame_num;
 	first_frame_num = frame_num;
 	frame_count = ring->rd_num;
-	next_ptr = ring->rd[frame_num].iov_base;
+	next_ptr = frame_addr(ring, frame_num);
 
 	if (num > frame_count)
 		num = frame_count;
@@ -329,7 +461,7 @@ static inline int pkt_mmap_v2_tx(pktio_entry_t *pktio_entry, int sock,
 		}
 
 		next_frame_num = next_frame(frame_num, frame_count);
-		next_ptr = ring->rd[next_frame_num].iov_base;
+		next_ptr = frame_addr(ring, next_frame_num);
 		odp_prefetch(next_ptr);
 
 		pkt_len = odp_packet_len(pkt_table[i]);
@@ -406,150 +538,257 @@ static inline int pkt_mmap_v2_tx(pktio_entry_t *pktio_entry, int sock,
 }
 
 static int mmap_setup_ring(pkt_sock_mmap_t *pkt_sock, struct ring *ring,
-			   int type)
+			   int type, int version)
 {
-	odp_shm_t shm;
 	uint32_t block_size, block_nr, frame_size, frame_nr;
-	uint32_t ring_size;
-	int flags;
-	int sock = pkt_sock->sockfd;
+	int sock = ring->sock;
 	int mtu = pkt_sock->mtu;
 	int ret = 0;
 
-	ring->sock = sock;
 	ring->type = type;
-	ring->version = TPACKET_V2;
+	ring->version = version;
 
 	frame_size = ROUNDUP_POWER2_U32(mtu + TPACKET_HDRLEN
 					+ TPACKET_ALIGNMENT);
-	block_size = BLOCK_SIZE;
+	block_size = version == TPACKET_V3 ? BLOCK_SIZE_V3 : BLOCK_SIZE;
 	if (frame_size > block_size)
 		block_size = frame_size;
 
 	block_nr   = FRAME_MEM_SIZE / block_size;
 	frame_nr   = (block_size / frame_size) * block_nr;
-	ring_size  = frame_nr * sizeof(struct iovec);
-	flags      = 0;
-
-	if (odp_global_ro.shm_single_va)
-		flags += ODP_SHM_SINGLE_VA;
-
-	shm = odp_shm_reserve(NULL, ring_size, ODP_CACHE_LINE_SIZE, flags);
-
-	if (shm == ODP_SHM_INVALID) {
-		ODP_ERR("Reserving shm failed\n");
-		return -1;
-	}
-	ring->shm = shm;
 
+	memset(&ring->req, 0, sizeof(ring->req));
 	ring->req.tp_block_size = block_size;
 	ring->req.tp_block_nr   = block_nr;
 	ring->req.tp_frame_size = frame_size;
 	ring->req.tp_frame_nr   = frame_nr;
 
 	ring->mm_len = ring->req.tp_block_size * ring->req.tp_block_nr;
-	ring->rd_num = ring->req.tp_frame_nr;
-	ring->flen   = ring->req.tp_frame_size;
-	ring->rd_len = ring_size;
+
+	if (version == TPACKET_V3) {
+		/* Rx ring is consumed block by block */
+		ring->req.tp_retire_blk_tov = pkt_sock->opt.rx_block_timeout_ms;
+		ring->rd_num = ring->req.tp_block_nr;
+		ring->flen   = ring->req.tp_block_size;
+	} else {
+		ring->rd_num = ring->req.tp_frame_nr;
+		ring->flen   = ring->req.tp_frame_size;
+	}
 
 	ODP_DBG("  tp_block_size %u\n", ring->req.tp_block_size);
 	ODP_DBG("  tp_block_nr   %u\n", ring->req.tp_block_nr);
 	ODP_DBG("  tp_frame_size %u\n", ring->req.tp_frame_size);
 	ODP_DBG("  tp_frame_nr   %u\n", ring->req.tp_frame_nr);
 
-	ret = setsockopt(sock, SOL_PACKET, type, &ring->req, sizeof(ring->req));
+	ret = setsockopt(sock, SOL_PACKET, type, &ring->req,
+			 version == TPACKET_V3 ? sizeof(struct tpacket_req3) :
+			 sizeof(struct tpacket_req));
 	if (ret == -1) {
 		__odp_errno = errno;
 		ODP_ERR("setsockopt(pkt mmap): %s\n", strerror(errno));
 		return -1;
 	}
 
-	ring->rd = odp_shm_addr(shm);
-	if (!ring->rd) {
-		ODP_ERR("Reading shm addr failed\n");
+	ring->mm_space = mmap(NULL, ring->mm_len, PROT_READ | PROT_WRITE,
+			      MAP_SHARED | MAP_LOCKED | MAP_POPULATE, sock, 0);
+	if (ring->mm_space == MAP_FAILED) {
+		__odp_errno = errno;
+		ODP_ERR("mmap %s buffer failed: %s\n",
+			type == PACKET_RX_RING ? "rx" : "tx", strerror(errno));
+		ring->mm_space = NULL;
 		return -1;
 	}
 
 	return 0;
 }
 
-static int mmap_sock(pkt_sock_mmap_t *pkt_sock)
+static int mmap_bind_sock(pkt_sock_mmap_t *pkt_sock, int sock,
+			  uint16_t protocol)
 {
-	int i;
-	int sock = pkt_sock->sockfd;
-
-	/* map rx + tx buffer to userspace : they are in this order */
-	pkt_sock->mmap_len =
-		pkt_sock->rx_ring.req.tp_block_size *
-		pkt_sock->rx_ring.req.tp_block_nr +
-		pkt_sock->tx_ring.req.tp_block_size *
-		pkt_sock->tx_ring.req.tp_block_nr;
+	struct sockaddr_ll ll;
+	int ret;
 
-	pkt_sock->mmap_base =
-		mmap(NULL, pkt_sock->mmap_len, PROT_READ | PROT_WRITE,
-		     MAP_SHARED | MAP_LOCKED | MAP_POPULATE, sock, 0);
+	memset(&ll, 0, sizeof(ll));
+	ll.sll_family = PF_PACKET;
+	ll.sll_protocol = htons(protocol);
+	ll.sll_ifindex = pkt_sock->if_idx;
 
-	if (pkt_sock->mmap_base == MAP_FAILED) {
+	ret = bind(sock, (struct sockaddr *)&ll, sizeof(ll));
+	if (ret == -1) {
 		__odp_errno = errno;
-		ODP_ERR("mmap rx&tx buffer failed: %s\n", strerror(errno));
+		ODP_ERR("bind(to IF): %s\n", strerror(errno));
 		return -1;
 	}
 
-	pkt_sock->rx_ring.mm_space = pkt_sock->mmap_base;
-	memset(pkt_sock->rx_ring.rd, 0, pkt_sock->rx_ring.rd_len);
-	for (i = 0; i < pkt_sock->rx_ring.rd_num; ++i) {
-		pkt_sock->rx_ring.rd[i].iov_base =
-			pkt_sock->rx_ring.mm_space
-			+ (i * pkt_sock->rx_ring.flen);
-		pkt_sock->rx_ring.rd[i].iov_len = pkt_sock->rx_ring.flen;
+	return 0;
+}
+
+static int mmap_fanout_join(pkt_sock_mmap_t *pkt_sock, struct ring *ring,
+			    uint32_t *fanout_id)
+{
+	uint32_t fanout_arg;
+	socklen_t len = sizeof(fanout_arg);
+
+	/* The first socket creates a new fanout group with an unique id */
+	if (ring == &pkt_sock->rx_ring[0])
+		fanout_arg = (pkt_sock->fanout | PACKET_FANOUT_FLAG_UNIQUEID) << 16;
+	else
+		fanout_arg = *fanout_id | (pkt_sock->fanout << 16);
+
+	if (setsockopt(ring->sock, SOL_PACKET, PACKET_FANOUT, &fanout_arg,
+		       sizeof(fanout_arg))) {
+		__odp_errno = errno;
+		ODP_ERR("setsockopt(PACKET_FANOUT): %s\n", strerror(errno));
+		return -1;
 	}
 
-	pkt_sock->tx_ring.mm_space =
-		pkt_sock->mmap_base + pkt_sock->rx_ring.mm_len;
-	memset(pkt_sock->tx_ring.rd, 0, pkt_sock->tx_ring.rd_len);
-	for (i = 0; i < pkt_sock->tx_ring.rd_num; ++i) {
-		pkt_sock->tx_ring.rd[i].iov_base =
-			pkt_sock->tx_ring.mm_space
-			+ (i * pkt_sock->tx_ring.flen);
-		pkt_sock->tx_ring.rd[i].iov_len = pkt_sock->tx_ring.flen;
+	if (ring == &pkt_sock->rx_ring[0]) {
+		if (getsockopt(ring->sock, SOL_PACKET, PACKET_FANOUT,
+			       &fanout_arg, &len)) {
+			__odp_errno = errno;
+			ODP_ERR("getsockopt(PACKET_FANOUT): %s\n",
+				strerror(errno));
+			return -1;
+		}
+		*fanout_id = fanout_arg & 0xffff;
 	}
 
 	return 0;
 }
 
-static int mmap_unmap_sock(pkt_sock_mmap_t *pkt_sock)
+static int mmap_rx_ring_open(pkt_sock_mmap_t *pkt_sock, struct ring *ring,
+			     uint32_t *fanout_id)
+{
+#ifdef PACKET_IGNORE_OUTGOING
+	int val = 1;
+#endif
+
+	ring->sock = mmap_pkt_socket(pkt_sock->opt.rx_tpacket_version);
+	if (ring->sock == -1)
+		return -1;
+
+	if (mmap_setup_ring(pkt_sock, ring, PACKET_RX_RING,
+			    pkt_sock->opt.rx_tpacket_version))
+		return -1;
+
+#ifdef PACKET_IGNORE_OUTGOING
+	/* Output queues use separate sockets. Do not receive packets
+	 * transmitted through those (or by anyone else). */
+	if (setsockopt(ring->sock, SOL_PACKET, PACKET_IGNORE_OUTGOING, &val,
+		       sizeof(val)))
+		ODP_DBG("setsockopt(PACKET_IGNORE_OUTGOING): %s\n",
+			strerror(errno));
+#endif
+
+	if (mmap_bind_sock(pkt_sock, ring->sock, ETH_P_ALL))
+		return -1;
+
+	if (pkt_sock->num_rx_ring > 1)
+		return mmap_fanout_join(pkt_sock, ring, fanout_id);
+
+	return 0;
+}
+
+static int mmap_tx_ring_open(pkt_sock_mmap_t *pkt_sock, struct ring *ring)
+{
+	int val = 1;
+
+	ring->sock = mmap_pkt_socket(TPACKET_V2);
+	if (ring->sock == -1)
+		return -1;
+
+	if (pkt_sock->opt.qdisc_bypass &&
+	    setsockopt(ring->sock, SOL_PACKET, PACKET_QDISC_BYPASS, &val,
+		       sizeof(val))) {
+		__odp_errno = errno;
+		ODP_ERR("setsockopt(PACKET_QDISC_BYPASS): %s\n",
+			strerror(errno));
+		return -1;
+	}
+
+	if (mmap_setup_ring(pkt_sock, ring, PACKET_TX_RING, TPACKET_V2))
+		return -1;
+
+	/* Zero protocol: transmit only, no packets are received into the
+	 * socket */
+	return mmap_bind_sock(pkt_sock, ring->sock, 0);
+}
+
+static int mmap_ring_close(struct ring *ring)
 {
 	int ret = 0;
 
-	if (pkt_sock->rx_ring.shm != ODP_SHM_INVALID)
-		odp_shm_free(pkt_sock->rx_ring.shm);
-	if (pkt_sock->tx_ring.shm != ODP_SHM_INVALID)
-		odp_shm_free(pkt_sock->tx_ring.shm);
+	if (ring->mm_space && munmap(ring->mm_space, ring->mm_len)) {
+		ODP_ERR("munmap(): %s\n", strerror(errno));
+		ret = -1;
+	}
+	ring->mm_space = NULL;
 
-	if (pkt_sock->mmap_base != MAP_FAILED)
-		ret = munmap(pkt_sock->mmap_base, pkt_sock->mmap_len);
+	if (ring->sock != -1 && close(ring->sock)) {
+		__odp_errno = errno;
+		ODP_ERR("close(ring sock): %s\n", strerror(errno));
+		ret = -1;
+	}
+	ring->sock = -1;
 
 	return ret;
 }
 
-static int mmap_bind_sock(pkt_sock_mmap_t *pkt_sock, const char *netdev)
+static int lookup_opt(const char *opt_name, const char *if_name, int *val)
 {
+	const char *base = "pktio_socket_mmap";
 	int ret;
 
-	pkt_sock->ll.sll_family = PF_PACKET;
-	pkt_sock->ll.sll_protocol = htons(ETH_P_ALL);
-	pkt_sock->ll.sll_ifindex = if_nametoindex(netdev);
-	pkt_sock->ll.sll_hatype = 0;
-	pkt_sock->ll.sll_pkttype = 0;
-	pkt_sock->ll.sll_halen = 0;
+	ret = _odp_libconfig_lookup_ext_int(base, if_name, opt_name, val);
+	if (ret == 0)
+		ODP_ERR("Unable to find socket mmap configuration option: %s\n",
+			opt_name);
 
-	ret = bind(pkt_sock->sockfd, (struct sockaddr *)&pkt_sock->ll,
-		   sizeof(pkt_sock->ll));
-	if (ret == -1) {
-		__odp_errno = errno;
-		ODP_ERR("bind(to IF): %s\n", strerror(errno));
+	return ret;
+}
+
+static int init_options(pkt_sock_mmap_t *pkt_sock, const char *if_name)
+{
+	mmap_opt_t *opt = &pkt_sock->opt;
+
+	if (!lookup_opt("rx_tpacket_version", if_name,
+			&opt->rx_tpacket_version))
+		return -1;
+	if (opt->rx_tpacket_version != 2 && opt->rx_tpacket_version != 3) {
+		ODP_ERR("Bad value pktio_socket_mmap.rx_tpacket_version = %i\n",
+			opt->rx_tpacket_version);
 		return -1;
 	}
+	opt->rx_tpacket_version = opt->rx_tpacket_version == 3 ? TPACKET_V3 :
+				  TPACKET_V2;
+
+	if (!lookup_opt("rx_block_timeout_ms", if_name,
+			&opt->rx_block_timeout_ms))
+		return -1;
+	if (opt->rx_block_timeout_ms < 0) {
+		ODP_ERR("Bad value pktio_socket_mmap.rx_block_timeout_ms = %i\n",
+			opt->rx_block_timeout_ms);
+		return -1;
+	}
+
+	if (!lookup_opt("fanout_mode", if_name, &opt->fanout_mode))
+		return -1;
+	if (opt->fanout_mode < FANOUT_MODE_QM ||
+	    opt->fanout_mode > FANOUT_MODE_LB) {
+		ODP_ERR("Bad value pktio_socket_mmap.fanout_mode = %i\n",
+			opt->fanout_mode);
+		return -1;
+	}
+
+	if (!lookup_opt("qdisc_bypass", if_name, &opt->qdisc_bypass))
+		return -1;
+
+	ODP_DBG("Socket mmap interface (%s):\n", if_name);
+	ODP_DBG("  rx_tpacket_version: %d\n",
+		opt->rx_tpacket_version == TPACKET_V3 ? 3 : 2);
+	ODP_DBG("  rx_block_timeout_ms: %d\n", opt->rx_block_timeout_ms);
+	ODP_DBG("  fanout_mode: %d\n", opt->fanout_mode);
+	ODP_DBG("  qdisc_bypass: %d\n", opt->qdisc_bypass);
 
 	return 0;
 }
@@ -557,19 +796,13 @@ static int mmap_bind_sock(pkt_sock_mmap_t *pkt_sock, const char *netdev)
 static int sock_mmap_close(pktio_entry_t *entry)
 {
 	pkt_sock_mmap_t *const pkt_sock = pkt_priv(entry);
-	int ret;
-
-	ret = mmap_unmap_sock(pkt_sock);
-	if (ret != 0) {
-		ODP_ERR("mmap_unmap_sock() %s\n", strerror(errno));
-		return -1;
-	}
 
 	if (pkt_sock->sockfd != -1 && close(pkt_sock->sockfd) != 0) {
 		__odp_errno = errno;
 		ODP_ERR("close(sockfd): %s\n", strerror(errno));
 		return -1;
 	}
+	pkt_sock->sockfd = -1;
 
 	return 0;
 }
@@ -578,7 +811,6 @@ static int sock_mmap_open(odp_pktio_t id ODP_UNUSED,
 			  pktio_entry_t *pktio_entry,
 			  const char *netdev, odp_pool_t pool)
 {
-	int if_idx;
 	int ret = 0;
 
 	if (disable_pktio)
@@ -590,26 +822,27 @@ static int sock_mmap_open(odp_pktio_t id ODP_UNUSED,
 	memset(pkt_sock, 0, sizeof(*pkt_sock));
 	/* set sockfd to -1, because a valid socked might be initialized to 0 */
 	pkt_sock->sockfd = -1;
-	pkt_sock->mmap_base = MAP_FAILED;
+	pkt_sock->shm = ODP_SHM_INVALID;
 
 	if (pool == ODP_POOL_INVALID)
 		return -1;
 
-	/* Store eth buffer offset for pkt buffers from this pool */
-	pkt_sock->frame_offset = 0;
-
 	pkt_sock->pool = pool;
-	odp_ticketlock_init(&pkt_sock->rx_ring.lock);
-	odp_ticketlock_init(&pkt_sock->tx_ring.lock);
-	pkt_sock->rx_ring.shm = ODP_SHM_INVALID;
-	pkt_sock->tx_ring.shm = ODP_SHM_INVALID;
-	pkt_sock->sockfd = mmap_pkt_socket();
+	pkt_sock->fanout = PACKET_FANOUT_HASH;
+
+	/* Packet sockets and rings of input and output queues are created
+	 * when the interface is started. This socket is used for interface
+	 * control. */
+	pkt_sock->sockfd = mmap_pkt_socket(TPACKET_V2);
 	if (pkt_sock->sockfd == -1)
 		goto error;
 
-	ret = mmap_bind_sock(pkt_sock, netdev);
-	if (ret != 0)
+	pkt_sock->if_idx = if_nametoindex(netdev);
+	if (pkt_sock->if_idx == 0) {
+		__odp_errno = errno;
+		ODP_ERR("if_nametoindex(): %s\n", strerror(errno));
 		goto error;
+	}
 
 	pkt_sock->mtu = mtu_get_fd(pkt_sock->sockfd, netdev);
 	if (!pkt_sock->mtu)
@@ -617,31 +850,13 @@ static int sock_mmap_open(odp_pktio_t id ODP_UNUSED,
 
 	ODP_DBG("MTU size: %i\n", pkt_sock->mtu);
 
-	ODP_DBG("TX ring setup:\n");
-	ret = mmap_setup_ring(pkt_sock, &pkt_sock->tx_ring, PACKET_TX_RING);
-	if (ret != 0)
-		goto error;
-
-	ODP_DBG("RX ring setup:\n");
-	ret = mmap_setup_ring(pkt_sock, &pkt_sock->rx_ring, PACKET_RX_RING);
-	if (ret != 0)
-		goto error;
-
-	ret = mmap_sock(pkt_sock);
-	if (ret != 0)
+	if (init_options(pkt_sock, netdev))
 		goto error;
 
 	ret = mac_addr_get_fd(pkt_sock->sockfd, netdev, pkt_sock->if_mac);
 	if (ret != 0)
 		goto error;
 
-	if_idx = if_nametoindex(netdev);
-	if (if_idx == 0) {
-		__odp_errno = errno;
-		ODP_ERR("if_nametoindex(): %s\n", strerror(errno));
-		goto error;
-	}
-
 	pktio_entry->s.stats_type = sock_stats_type_fd(pktio_entry,
 						       pkt_sock->sockfd);
 	if (pktio_entry->s.stats_type == STATS_UNSUPPORTED)
@@ -659,30 +874,149 @@ error:
 	return -1;
 }
 
-static int sock_mmap_fd_set(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
+static int sock_mmap_stop(pktio_entry_t *pktio_entry)
+{
+	pkt_sock_mmap_t *const pkt_sock = pkt_priv(pktio_entry);
+	uint32_t i;
+	int ret = 0;
+
+	for (i = 0; i < pkt_sock->num_rx_ring; i++)
+		ret |= mmap_ring_close(&pkt_sock->rx_ring[i]);
+
+	for (i = 0; i < pkt_sock->num_tx_ring; i++)
+		ret |= mmap_ring_close(&pkt_sock->tx_ring[i]);
+
+	pkt_sock->num_rx_ring = 0;
+	pkt_sock->num_tx_ring = 0;
+	pkt_sock->rx_ring = NULL;
+	pkt_sock->tx_ring = NULL;
+
+	if (pkt_sock->shm != ODP_SHM_INVALID) {
+		if (odp_shm_free(pkt_sock->shm)) {
+			ODP_ERR("shm free failed\n");
+			ret = -1;
+		}
+		pkt_sock->shm = ODP_SHM_INVALID;
+	}
+
+	return ret ? -1 : 0;
+}
+
+static int sock_mmap_start(pktio_entry_t *pktio_entry)
+{
+	pkt_sock_mmap_t *const pkt_sock = pkt_priv(pktio_entry);
+	odp_pktin_mode_t in_mode = pktio_entry->s.param.in_mode;
+	odp_pktout_mode_t out_mode = pktio_entry->s.param.out_mode;
+	char name[ODP_SHM_NAME_LEN];
+	uint32_t num_rx, num_tx, i;
+	uint32_t fanout_id = 0;
+	int flags = 0;
+
+	/* If no pktin/pktout queues have been configured. Configure one
+	 * for each direction. */
+	if (!pktio_entry->s.num_in_queue &&
+	    in_mode != ODP_PKTIN_MODE_DISABLED) {
+		odp_pktin_queue_param_t param;
+
+		odp_pktin_queue_param_init(&param);
+		param.num_queues = 1;
+		if (odp_pktin_queue_config(pktio_entry->s.handle, &param))
+			return -1;
+	}
+	if (!pktio_entry->s.num_out_queue &&
+	    out_mode == ODP_PKTOUT_MODE_DIRECT) {
+		odp_pktout_queue_param_t param;
+
+		odp_pktout_queue_param_init(&param);
+		param.num_queues = 1;
+		if (odp_pktout_queue_config(pktio_entry->s.handle, &param))
+			return -1;
+	}
+
+	num_rx = in_mode == ODP_PKTIN_MODE_DISABLED ? 0 :
+			pktio_entry->s.num_in_queue;
+	num_tx = out_mode == ODP_PKTOUT_MODE_DISABLED ? 0 :
+			pktio_entry->s.num_out_queue;
+
+	if (num_rx + num_tx == 0)
+		return 0;
+
+	if (odp_global_ro.shm_single_va)
+		flags += ODP_SHM_SINGLE_VA;
+
+	snprintf(name, sizeof(name), "_odp_pktio_mmap_%" PRIu64,
+		 odp_pktio_to_u64(pktio_entry->s.handle));
+	pkt_sock->shm = odp_shm_reserve(name,
+					(num_rx + num_tx) * sizeof(struct ring),
+					ODP_CACHE_LINE_SIZE, flags);
+	if (pkt_sock->shm == ODP_SHM_INVALID) {
+		ODP_ERR("Reserving shm failed\n");
+		return -1;
+	}
+
+	pkt_sock->rx_ring = odp_shm_addr(pkt_sock->shm);
+	pkt_sock->tx_ring = &pkt_sock->rx_ring[num_rx];
+	memset(pkt_sock->rx_ring, 0, (num_rx + num_tx) * sizeof(struct ring));
+
+	for (i = 0; i < num_rx + num_tx; i++) {
+		odp_ticketlock_init(&pkt_sock->rx_ring[i].lock);
+		pkt_sock->rx_ring[i].sock = -1;
+	}
+
+	pkt_sock->num_rx_ring = num_rx;
+	pkt_sock->num_tx_ring = num_tx;
+
+	ODP_DBG("RX ring setup:\n");
+	for (i = 0; i < num_rx; i++) {
+		if (mmap_rx_ring_open(pkt_sock, &pkt_sock->rx_ring[i],
+				      &fanout_id))
+			goto error;
+	}
+
+	ODP_DBG("TX ring setup:\n");
+	for (i = 0; i < num_tx; i++) {
+		if (mmap_tx_ring_open(pkt_sock, &pkt_sock->tx_ring[i]))
+			goto error;
+	}
+
+	return 0;
+
+error:
+	sock_mmap_stop(pktio_entry);
+	return -1;
+}
+
+static int sock_mmap_fd_set(pktio_entry_t *pktio_entry, int index,
 			    fd_set *readfds)
 {
 	pkt_sock_mmap_t *const pkt_sock = pkt_priv(pktio_entry);
 	int fd;
 
-	odp_ticketlock_lock(&pktio_entry->s.rxl);
-	fd = pkt_sock->sockfd;
+	fd = pkt_sock->rx_ring[index].sock;
 	FD_SET(fd, readfds);
-	odp_ticketlock_unlock(&pktio_entry->s.rxl);
 
 	return fd;
 }
 
-static int sock_mmap_recv(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
+static int sock_mmap_recv(pktio_entry_t *pktio_entry, int index,
 			  odp_packet_t pkt_table[], int num)
 {
 	pkt_sock_mmap_t *const pkt_sock = pkt_priv(pktio_entry);
+	struct ring *ring = &pkt_sock->rx_ring[index];
 	int ret;
 
-	odp_ticketlock_lock(&pkt_sock->rx_ring.lock);
-	ret = pkt_mmap_v2_rx(pktio_entry, pkt_sock, pkt_table, num,
-			     pkt_sock->if_mac);
-	odp_ticketlock_unlock(&pkt_sock->rx_ring.lock);
+	if (!pkt_sock->lockless_rx)
+		odp_ticketlock_lock(&ring->lock);
+
+	if (ring->version == TPACKET_V3)
+		ret = pkt_mmap_v3_rx(pktio_entry, pkt_sock, ring, pkt_table,
+				     num);
+	else
+		ret = pkt_mmap_v2_rx(pktio_entry, pkt_sock, ring, pkt_table,
+				     num);
+
+	if (!pkt_sock->lockless_rx)
+		odp_ticketlock_unlock(&ring->lock);
 
 	return ret;
 }
@@ -772,20 +1106,61 @@ static int sock_mmap_recv_mq_tmo(pktio_entry_t *pktio_entry[], int index[],
 	}
 }
 
-static int sock_mmap_send(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
+static int sock_mmap_send(pktio_entry_t *pktio_entry, int index,
 			  const odp_packet_t pkt_table[], int num)
 {
 	int ret;
 	pkt_sock_mmap_t *const pkt_sock = pkt_priv(pktio_entry);
+	struct ring *ring = &pkt_sock->tx_ring[index];
+
+	if (!pkt_sock->lockless_tx)
+		odp_ticketlock_lock(&ring->lock);
+
+	ret = pkt_mmap_v2_tx(pktio_entry, ring->sock, ring, pkt_table, num);
 
-	odp_ticketlock_lock(&pkt_sock->tx_ring.lock);
-	ret = pkt_mmap_v2_tx(pktio_entry, pkt_sock->tx_ring.sock,
-			     &pkt_sock->tx_ring, pkt_table, num);
-	odp_ticketlock_unlock(&pkt_sock->tx_ring.lock);
+	if (!pkt_sock->lockless_tx)
+		odp_ticketlock_unlock(&ring->lock);
 
 	return ret;
 }
 
+static int sock_mmap_input_queues_config(pktio_entry_t *pktio_entry,
+					 const odp_pktin_queue_param_t *p)
+{
+	pkt_sock_mmap_t *const pkt_sock = pkt_priv(pktio_entry);
+	odp_pktin_mode_t mode = pktio_entry->s.param.in_mode;
+
+	/* Scheduler synchronizes input queue polls. Only single thread
+	 * at a time polls a queue */
+	if (mode == ODP_PKTIN_MODE_SCHED)
+		pkt_sock->lockless_rx = 1;
+	else
+		pkt_sock->lockless_rx = (p->op_mode == ODP_PKTIO_OP_MT_UNSAFE);
+
+	/* Kernel distributes packets to the sockets of input queues. With
+	 * hashing, flows are spread with the kernel flow hash (L3 addresses
+	 * and L4 ports). */
+	if (p->hash_enable)
+		pkt_sock->fanout = PACKET_FANOUT_HASH;
+	else if (pkt_sock->opt.fanout_mode == FANOUT_MODE_CPU)
+		pkt_sock->fanout = PACKET_FANOUT_CPU;
+	else if (pkt_sock->opt.fanout_mode == FANOUT_MODE_LB)
+		pkt_sock->fanout = PACKET_FANOUT_LB;
+	else
+		pkt_sock->fanout = PACKET_FANOUT_QM;
+
+	return 0;
+}
+
+static int sock_mmap_output_queues_config(pktio_entry_t *pktio_entry,
+					  const odp_pktout_queue_param_t *p)
+{
+	pkt_priv(pktio_entry)->lockless_tx =
+		(p->op_mode == ODP_PKTIO_OP_MT_UNSAFE);
+
+	return 0;
+}
+
 static uint32_t sock_mmap_mtu_get(pktio_entry_t *pktio_entry)
 {
 	return mtu_get_fd(pkt_priv(pktio_entry)->sockfd,
@@ -827,8 +1202,8 @@ static int sock_mmap_capability(pktio_entry_t *pktio_entry ODP_UNUSED,
 {
 	memset(capa, 0, sizeof(odp_pktio_capability_t));
 
-	capa->max_input_queues  = 1;
-	capa->max_output_queues = 1;
+	capa->max_input_queues  = PKTIO_MAX_QUEUES;
+	capa->max_output_queues = PKTIO_MAX_QUEUES;
 	capa->set_op.op.promisc_mode = 1;
 
 	odp_pktio_config_init(&capa->config);
@@ -865,6 +1240,32 @@ static int sock_mmap_stats_reset(pktio_entry_t *pktio_entry)
 				   pkt_priv(pktio_entry)->sockfd);
 }
 
+static void sock_mmap_print(pktio_entry_t *pktio_entry)
+{
+	pkt_sock_mmap_t *const pkt_sock = pkt_priv(pktio_entry);
+	const char *fanout;
+
+	switch (pkt_sock->fanout) {
+	case PACKET_FANOUT_HASH:
+		fanout = "hash";
+		break;
+	case PACKET_FANOUT_CPU:
+		fanout = "cpu";
+		break;
+	case PACKET_FANOUT_LB:
+		fanout = "lb";
+		break;
+	default:
+		fanout = "qm";
+	}
+
+	ODP_PRINT("  rx tpacket version %i\n",
+		  pkt_sock->opt.rx_tpacket_version == TPACKET_V3 ? 3 : 2);
+	ODP_PRINT("  rx fanout mode    %s\n", fanout);
+	ODP_PRINT("  tx qdisc bypass   %s\n",
+		  pkt_sock->opt.qdisc_bypass ? "yes" : "no");
+}
+
 static int sock_mmap_init_global(void)
 {
 	if (getenv("ODP_PKTIO_DISABLE_SOCKET_MMAP")) {
@@ -880,14 +1281,14 @@ static int sock_mmap_init_global(void)
 
 const pktio_if_ops_t sock_mmap_pktio_ops = {
 	.name = "socket_mmap",
-	.print = NULL,
+	.print = sock_mmap_print,
 	.init_global = sock_mmap_init_global,
 	.init_local = NULL,
 	.term = NULL,
 	.open = sock_mmap_open,
 	.close = sock_mmap_close,
-	.start = NULL,
-	.stop = NULL,
+	.start = sock_mmap_start,
+	.stop = sock_mmap_stop,
 	.stats = sock_mmap_stats,
 	.stats_reset = sock_mmap_stats_reset,
 	.recv = sock_mmap_recv,
@@ -907,6 +1308,6 @@ const pktio_if_ops_t sock_mmap_pktio_ops = {
 	.pktio_ts_from_ns = NULL,
 	.pktio_time = NULL,
 	.config = NULL,
-	.input_queues_config = NULL,
-	.output_queues_config = NULL,
+	.input_queues_config = sock_mmap_input_queues_config,
+	.output_queues_config = sock_mmap_output_queues_config,
 };
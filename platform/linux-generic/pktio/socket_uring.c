@@ -0,0 +1,1575 @@
+/* Copyright (c) 2020, Nokia
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier:     BSD-3-Clause
+ */
+
+/**
+ * @file
+ *
+ * io_uring packet socket I/O
+ *
+ * Each pktin queue has a packet socket and an io_uring. A single multishot
+ * receive request stays armed on the socket and the kernel writes received
+ * frames directly into packets, which are provided to it through a buffer
+ * ring. Packets are received by reaping completions from shared memory,
+ * without system calls. The receive request is armed (and rearmed) by
+ * the thread receiving from the queue.
+ *
+ * Each pktout queue has a packet socket and an io_uring. A burst of packets
+ * is submitted with a single io_uring_enter() call. Packet pool memory is
+ * registered to the ring, so that transmits use fixed buffers. Packets are
+ * freed when their transmit completions are reaped.
+ *
+ * The driver uses kernel interfaces directly (no liburing dependency) and
+ * requires Linux kernel 6.0 or newer.
+ */
+
+#include <odp/autoheader_internal.h>
+
+#ifdef _ODP_PKTIO_IO_URING
+
+#include <odp_posix_extensions.h>
+
+#include <odp/api/packet.h>
+#include <odp/api/plat/packet_inlines.h>
+#include <odp/api/shared_memory.h>
+#include <odp/api/ticketlock.h>
+#include <odp/api/time.h>
+
+#include <odp_packet_io_internal.h>
+#include <odp_packet_internal.h>
+#include <odp_pool_internal.h>
+#include <odp_packet_io_stats.h>
+#include <odp_socket_common.h>
+#include <odp_debug_internal.h>
+#include <odp_errno_define.h>
+#include <odp_align_internal.h>
+#include <odp_classification_datamodel.h>
+#include <odp_classification_internal.h>
+#include <odp_libconfig_internal.h>
+
+#include <protocols/eth.h>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+
+#ifndef PACKET_FANOUT_FLAG_UNIQUEID
+#define PACKET_FANOUT_FLAG_UNIQUEID 0x2000
+#endif
+
+/* Maximum number of packets per buffer ring refill and completion reap */
+#define URING_BURST 64
+
+/* Limits for the number of receive buffers and transmit descriptors */
+#define URING_MIN_DESC URING_BURST
+#define URING_MAX_DESC (32 * 1024)
+
+/* Maximum number of pending requests in input queue submission rings.
+ * Only the multishot receive and its cancel request are submitted. */
+#define URING_RX_SQ_SIZE 4
+
+/* Buffer group of receive buffers */
+#define URING_RX_BGID 0
+
+/* Kernel limit for the length of a registered buffer */
+#define URING_MAX_FIXED_BUF_LEN (1024 * 1024 * 1024ULL)
+
+/* Maximum receive wait time in microseconds */
+#define URING_MAX_WAIT_US (UINT64_MAX / 1024)
+
+/* Maximum time to wait for pending requests when stopping */
+#define URING_DRAIN_TMO_NS (100 * ODP_TIME_MSEC_IN_NS)
+
+/* User data of input queue requests. Transmit requests carry the packet
+ * handle instead. */
+#define URING_UD_RECV   1
+#define URING_UD_CANCEL 2
+
+/** io_uring socket runtime configuration options */
+typedef struct {
+	int num_rx_buf;
+	int num_tx_desc;
+	int fixed_buf;
+} uring_opt_t;
+
+/** io_uring instance shared with the kernel */
+typedef struct {
+	/* Submission queue */
+	uint32_t *sq_head;
+	uint32_t *sq_tail;
+	struct io_uring_sqe *sqes;
+	uint32_t sq_mask;
+	uint32_t sq_size;
+	/* Tail index of prepared, but not yet published requests */
+	uint32_t sq_local_tail;
+
+	/* Completion queue */
+	uint32_t *cq_head;
+	uint32_t *cq_tail;
+	struct io_uring_cqe *cqes;
+	uint32_t cq_mask;
+	uint32_t cq_size;
+
+	void *sq_map;
+	size_t sq_map_len;
+	void *cq_map;
+	size_t cq_map_len;
+	size_t sqes_len;
+	int fd;
+} uring_t;
+
+/** Socket and io_uring of a pktin queue */
+typedef struct ODP_ALIGNED_CACHE {
+	odp_ticketlock_t lock;
+	uring_t ring;
+	/* Buffer ring of receive buffers. Tail index overlays reserved
+	 * field of the first buffer. */
+	struct io_uring_buf *bufs;
+	size_t bufs_len;
+	uint16_t *bufs_tail;
+	uint16_t bufs_local_tail;
+	/* Packets given to the kernel, indexed by buffer id */
+	odp_packet_t *pkt;
+	/* Free buffer ids */
+	uint16_t *free_bid;
+	uint32_t num_free;
+	/* Multishot receive is active */
+	int armed;
+	int sock;
+} uring_rxq_t;
+
+/** Socket and io_uring of a pktout queue */
+typedef struct ODP_ALIGNED_CACHE {
+	odp_ticketlock_t lock;
+	uring_t ring;
+	/* Number of transmits waiting for completion */
+	uint32_t inflight;
+	int sock;
+} uring_txq_t;
+
+/** Packet socket using io_uring for both Rx and Tx */
+typedef struct {
+	uring_rxq_t *rxq;		/**< Input queues */
+	uring_txq_t *txq;		/**< Output queues */
+	odp_shm_t shm;			/**< Queue tables and buffer id arrays */
+	uint32_t num_rxq;		/**< Number of input queues */
+	uint32_t num_txq;		/**< Number of output queues */
+	pool_t *pool;			/**< Pool to alloc packets from */
+	uint32_t mtu;			/**< Maximum transmission unit */
+	uint32_t max_frame_len;		/**< Maximum frame length by pool */
+	uint32_t num_fixed_buf;		/**< Number of registered buffers */
+	int fanout;			/**< Packet fanout mode */
+	int sockfd;			/**< Control socket */
+	int if_idx;			/**< Interface index */
+	odp_bool_t lockless_rx;		/**< No locking for rx */
+	odp_bool_t lockless_tx;		/**< No locking for tx */
+	uring_opt_t opt;		/**< Options */
+	unsigned char if_mac[ETH_ALEN]; /**< Interface MAC address */
+	char if_name[IF_NAMESIZE];	/**< Interface name */
+} pkt_uring_t;
+
+ODP_STATIC_ASSERT(PKTIO_PRIVATE_SIZE >= sizeof(pkt_uring_t),
+		  "PKTIO_PRIVATE_SIZE too small");
+
+static inline pkt_uring_t *pkt_priv(pktio_entry_t *pktio_entry)
+{
+	return (pkt_uring_t *)(uintptr_t)(pktio_entry->s.pkt_priv);
+}
+
+static int disable_pktio; /** !0 this pktio disabled, 0 enabled */
+
+static inline int sys_io_uring_setup(uint32_t entries,
+				     struct io_uring_params *p)
+{
+	return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static inline int sys_io_uring_enter(int fd, uint32_t to_submit,
+				     uint32_t min_complete, uint32_t flags,
+				     const void *arg, size_t argsz)
+{
+	return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+		       arg, argsz);
+}
+
+static inline int sys_io_uring_register(int fd, uint32_t opcode,
+					const void *arg, uint32_t nr_args)
+{
+	return syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+/* Get a submission queue entry. Returns NULL when the queue is full. */
+static inline struct io_uring_sqe *uring_get_sqe(uring_t *ring)
+{
+	uint32_t head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+	struct io_uring_sqe *sqe;
+
+	if (ring->sq_local_tail - head >= ring->sq_size)
+		return NULL;
+
+	sqe = &ring->sqes[ring->sq_local_tail & ring->sq_mask];
+	ring->sq_local_tail++;
+	memset(sqe, 0, sizeof(*sqe));
+
+	return sqe;
+}
+
+static inline uint32_t uring_sq_free(uring_t *ring)
+{
+	uint32_t head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+
+	return ring->sq_size - (ring->sq_local_tail - head);
+}
+
+/* Publish prepared requests and pass all unconsumed requests to the kernel
+ * with a single system call. Requests not consumed due to temporary
+ * resource shortage are passed again on the next call. */
+static inline int uring_submit(uring_t *ring)
+{
+	uint32_t to_submit;
+	int ret;
+
+	__atomic_store_n(ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+
+	to_submit = ring->sq_local_tail -
+		    __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+	if (to_submit == 0)
+		return 0;
+
+	ret = sys_io_uring_enter(ring->fd, to_submit, 0, 0, NULL, 0);
+	if (odp_unlikely(ret < 0)) {
+		if (errno == EAGAIN || errno == EBUSY || errno == EINTR)
+			return 0;
+
+		__odp_errno = errno;
+		ODP_ERR("io_uring_enter(): %s\n", strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Wait for at least one completion, or until timeout. Returns 0 on completion or timeout, and -1 on failure. */
+static inline int uring_wait(uring_t *ring, struct __kernel_timespec *ts)
+{
+	struct io_uring_getevents_arg arg;
+	int ret;
+
+	memset(&arg, 0, sizeof(arg));
+	arg.ts = (uint64_t)(uintptr_t)ts;
+
+	ret = sys_io_uring_enter(ring->fd, 0, 1,
+				 IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+				 &arg, sizeof(arg));
+	if (ret < 0 && errno != ETIME && errno != EINTR) {
+		__odp_errno = errno;
+		ODP_ERR("io_uring_enter(): %s\n", strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+static inline uint32_t uring_cq_avail(uring_t *ring)
+{
+	return __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE) -
+	       *ring->cq_head;
+}
+
+static inline struct io_uring_cqe *uring_cqe(uring_t *ring, uint32_t i)
+{
+	return &ring->cqes[(*ring->cq_head + i) & ring->cq_mask];
+}
+
+static inline void uring_cq_release(uring_t *ring, uint32_t num)
+{
+	__atomic_store_n(ring->cq_head, *ring->cq_head + num,
+			 __ATOMIC_RELEASE);
+}
+
+static int uring_open(uring_t *ring, uint32_t sq_size, uint32_t cq_size)
+{
+	struct io_uring_params p;
+	uint32_t *sq_array;
+	uint32_t i;
+	uint8_t *sq_map, *cq_map;
+	int fd;
+
+	memset(&p, 0, sizeof(p));
+	p.flags = IORING_SETUP_CQSIZE;
+	p.cq_entries = cq_size;
+
+	fd = sys_io_uring_setup(sq_size, &p);
+	if (fd < 0) {
+		__odp_errno = errno;
+		ODP_ERR("io_uring_setup(): %s\n", strerror(errno));
+		return -1;
+	}
+	ring->fd = fd;
+
+	if (!(p.features & IORING_FEAT_EXT_ARG) ||
+	    !(p.features & IORING_FEAT_NODROP)) {
+		ODP_ERR("io_uring: kernel too old\n");
+		return -1;
+	}
+
+	ring->sq_map_len = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+	ring->cq_map_len = p.cq_off.cqes +
+			   p.cq_entries * sizeof(struct io_uring_cqe);
+
+	/* Completion queue is in the same mapping with submission queue,
+	 * when the kernel supports it */
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		if (ring->cq_map_len > ring->sq_map_len)
+			ring->sq_map_len = ring->cq_map_len;
+		ring->cq_map_len = 0;
+	}
+
+	sq_map = mmap(NULL, ring->sq_map_len, PROT_READ | PROT_WRITE,
+		      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (sq_map == MAP_FAILED) {
+		__odp_errno = errno;
+		ODP_ERR("mmap(): %s\n", strerror(errno));
+		return -1;
+	}
+	ring->sq_map = sq_map;
+
+	if (ring->cq_map_len) {
+		cq_map = mmap(NULL, ring->cq_map_len, PROT_READ | PROT_WRITE,
+			      MAP_SHARED | MAP_POPULATE, fd,
+			      IORING_OFF_CQ_RING);
+		if (cq_map == MAP_FAILED) {
+			__odp_errno = errno;
+			ODP_ERR("mmap(): %s\n", strerror(errno));
+			return -1;
+		}
+		ring->cq_map = cq_map;
+	} else {
+		cq_map = sq_map;
+	}
+
+	ring->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap(NULL, ring->sqes_len, PROT_READ | PROT_WRITE,
+			  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED) {
+		__odp_errno = errno;
+		ring->sqes = NULL;
+		ODP_ERR("mmap(): %s\n", strerror(errno));
+		return -1;
+	}
+
+	ring->sq_head = (uint32_t *)(uintptr_t)(sq_map + p.sq_off.head);
+	ring->sq_tail = (uint32_t *)(uintptr_t)(sq_map + p.sq_off.tail);
+	ring->sq_mask = *(uint32_t *)(uintptr_t)(sq_map + p.sq_off.ring_mask);
+	ring->sq_size = p.sq_entries;
+	ring->sq_local_tail = *ring->sq_tail;
+
+	/* Submission queue entries are used in ring order */
+	sq_array = (uint32_t *)(uintptr_t)(sq_map + p.sq_off.array);
+	for (i = 0; i < p.sq_entries; i++)
+		sq_array[i] = i;
+
+	ring->cq_head = (uint32_t *)(uintptr_t)(cq_map + p.cq_off.head);
+	ring->cq_tail = (uint32_t *)(uintptr_t)(cq_map + p.cq_off.tail);
+	ring->cq_mask = *(uint32_t *)(uintptr_t)(cq_map + p.cq_off.ring_mask);
+	ring->cq_size = p.cq_entries;
+	ring->cqes = (struct io_uring_cqe *)(uintptr_t)(cq_map +
+							 p.cq_off.cqes);
+
+	return 0;
+}
+
+static void uring_close(uring_t *ring)
+{
+	if (ring->sqes && munmap(ring->sqes, ring->sqes_len))
+		ODP_ERR("munmap(): %s\n", strerror(errno));
+	if (ring->cq_map && munmap(ring->cq_map, ring->cq_map_len))
+		ODP_ERR("munmap(): %s\n", strerror(errno));
+	if (ring->sq_map && munmap(ring->sq_map, ring->sq_map_len))
+		ODP_ERR("munmap(): %s\n", strerror(errno));
+
+	if (ring->fd != -1 && close(ring->fd))
+		ODP_ERR("close(io_uring): %s\n", strerror(errno));
+
+	memset(ring, 0, sizeof(uring_t));
+	ring->fd = -1;
+}
+
+/* Request cancellation of all pending requests of a ring */
+static int uring_cancel_all(uring_t *ring)
+{
+	struct io_uring_sqe *sqe = uring_get_sqe(ring);
+
+	if (sqe == NULL)
+		return -1;
+
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = -1;
+	sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+	sqe->user_data = URING_UD_CANCEL;
+
+	return uring_submit(ring);
+}
+
+static int lookup_opt(const char *opt_name, const char *if_name, int *val)
+{
+	const char *base = "pktio_socket_uring";
+	int ret;
+
+	ret = _odp_libconfig_lookup_ext_int(base, if_name, opt_name, val);
+	if (ret == 0)
+		ODP_ERR("Unable to find io_uring socket configuration option: "
+			"%s\n", opt_name);
+
+	return ret;
+}
+
+static int init_options(pkt_uring_t *pkt_uring)
+{
+	uring_opt_t *opt = &pkt_uring->opt;
+
+	if (!lookup_opt("num_rx_buf", pkt_uring->if_name, &opt->num_rx_buf))
+		return -1;
+	if (opt->num_rx_buf < URING_MIN_DESC ||
+	    opt->num_rx_buf > URING_MAX_DESC ||
+	    !CHECK_IS_POWER2(opt->num_rx_buf)) {
+		ODP_ERR("Bad value pktio_socket_uring.num_rx_buf = %i\n",
+			opt->num_rx_buf);
+		return -1;
+	}
+
+	if (!lookup_opt("num_tx_desc", pkt_uring->if_name, &opt->num_tx_desc))
+		return -1;
+	if (opt->num_tx_desc < URING_MIN_DESC ||
+	    opt->num_tx_desc > URING_MAX_DESC ||
+	    !CHECK_IS_POWER2(opt->num_tx_desc)) {
+		ODP_ERR("Bad value pktio_socket_uring.num_tx_desc = %i\n",
+			opt->num_tx_desc);
+		return -1;
+	}
+
+	if (!lookup_opt("fixed_buf", pkt_uring->if_name, &opt->fixed_buf))
+		return -1;
+
+	ODP_DBG("io_uring socket interface (%s):\n", pkt_uring->if_name);
+	ODP_DBG("  num_rx_buf: %d\n", opt->num_rx_buf);
+	ODP_DBG("  num_tx_desc: %d\n", opt->num_tx_desc);
+	ODP_DBG("  fixed_buf: %d\n", opt->fixed_buf);
+
+	return 0;
+}
+
+static int uring_pkt_socket(void)
+{
+	int sock;
+
+	/* Zero protocol: no packets are received before bind */
+	sock = socket(PF_PACKET, SOCK_RAW, 0);
+	if (sock == -1) {
+		__odp_errno = errno;
+		ODP_ERR("socket(SOCK_RAW): %s\n", strerror(errno));
+	}
+
+	return sock;
+}
+
+static int uring_bind_sock(pkt_uring_t *pkt_uring, int sock, uint16_t protocol)
+{
+	struct sockaddr_ll ll;
+
+	memset(&ll, 0, sizeof(ll));
+	ll.sll_family = PF_PACKET;
+	ll.sll_protocol = htons(protocol);
+	ll.sll_ifindex = pkt_uring->if_idx;
+
+	if (bind(sock, (struct sockaddr *)&ll, sizeof(ll))) {
+		__odp_errno = errno;
+		ODP_ERR("bind(to IF): %s\n", strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+static int uring_fanout_join(pkt_uring_t *pkt_uring, uint32_t idx,
+			     uint32_t *fanout_id)
+{
+	int sock = pkt_uring->rxq[idx].sock;
+	uint32_t fanout_arg;
+	socklen_t len = sizeof(fanout_arg);
+
+	/* The first socket creates a new fanout group with an unique id */
+	if (idx == 0)
+		fanout_arg = (pkt_uring->fanout | PACKET_FANOUT_FLAG_UNIQUEID)
+			     << 16;
+	else
+		fanout_arg = *fanout_id | (pkt_uring->fanout << 16);
+
+	if (setsockopt(sock, SOL_PACKET, PACKET_FANOUT, &fanout_arg,
+		       sizeof(fanout_arg))) {
+		__odp_errno = errno;
+		ODP_ERR("setsockopt(PACKET_FANOUT): %s\n", strerror(errno));
+		return -1;
+	}
+
+	if (idx == 0) {
+		if (getsockopt(sock, SOL_PACKET, PACKET_FANOUT, &fanout_arg,
+			       &len)) {
+			__odp_errno = errno;
+			ODP_ERR("getsockopt(PACKET_FANOUT): %s\n",
+				strerror(errno));
+			return -1;
+		}
+		*fanout_id = fanout_arg & 0xffff;
+	}
+
+	return 0;
+}
+
+/* Give free packets to the kernel as receive buffers */
+static inline void uring_rx_refill(pktio_entry_t *pktio_entry,
+				   uring_rxq_t *rxq)
+{
+	pkt_uring_t *pkt_uring = pkt_priv(pktio_entry);
+	uint16_t frame_offset = pktio_entry->s.pktin_frame_offset;
+	odp_packet_t pkt[URING_BURST];
+	odp_packet_hdr_t *pkt_hdr;
+	uint32_t mask = pkt_uring->opt.num_rx_buf - 1;
+	uint32_t len = pkt_uring->max_frame_len;
+	uint32_t num;
+	int i, ret;
+
+	while (rxq->num_free) {
+		num = rxq->num_free > URING_BURST ? URING_BURST :
+						    rxq->num_free;
+
+		ret = packet_alloc_multi(pkt_uring->pool->pool_hdl,
+					 len + frame_offset, pkt, num);
+		if (odp_unlikely(ret <= 0))
+			break;
+
+		for (i = 0; i < ret; i++) {
+			uint16_t bid = rxq->free_bid[--rxq->num_free];
+			struct io_uring_buf *buf;
+
+			buf = &rxq->bufs[(rxq->bufs_local_tail + i) & mask];
+			pkt_hdr = packet_hdr(pkt[i]);
+			if (frame_offset)
+				pull_head(pkt_hdr, frame_offset);
+
+			buf->addr = (uint64_t)(uintptr_t)pkt_hdr->seg_data;
+			buf->len = len;
+			buf->bid = bid;
+			rxq->pkt[bid] = pkt[i];
+		}
+
+		rxq->bufs_local_tail += ret;
+		__atomic_store_n(rxq->bufs_tail, rxq->bufs_local_tail,
+				 __ATOMIC_RELEASE);
+	}
+}
+
+/* Arm multishot receive on the socket. Receive is disarmed by the kernel
+ * when it runs out of buffers, and when the thread which armed it exits. */
+static inline int uring_rx_arm(uring_rxq_t *rxq)
+{
+	struct io_uring_sqe *sqe;
+
+	sqe = uring_get_sqe(&rxq->ring);
+	if (odp_unlikely(sqe == NULL))
+		return -1;
+
+	sqe->opcode = IORING_OP_RECV;
+	sqe->fd = rxq->sock;
+	sqe->ioprio = IORING_RECV_MULTISHOT;
+	sqe->flags = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = URING_RX_BGID;
+	sqe->user_data = URING_UD_RECV;
+
+	if (uring_submit(&rxq->ring))
+		return -1;
+
+	rxq->armed = 1;
+	return 0;
+}
+
+static int uring_rxq_open(pktio_entry_t *pktio_entry, uint32_t idx,
+			  uint32_t *fanout_id)
+{
+	pkt_uring_t *pkt_uring = pkt_priv(pktio_entry);
+	uring_rxq_t *rxq = &pkt_uring->rxq[idx];
+	uint32_t num = pkt_uring->opt.num_rx_buf;
+	struct io_uring_buf_reg reg;
+	uint32_t i;
+#ifdef PACKET_IGNORE_OUTGOING
+	int val = 1;
+#endif
+
+	rxq->sock = uring_pkt_socket();
+	if (rxq->sock == -1)
+		return -1;
+
+#ifdef PACKET_IGNORE_OUTGOING
+	/* Output queues use separate sockets. Do not receive packets
+	 * transmitted through those (or by anyone else). */
+	if (setsockopt(rxq->sock, SOL_PACKET, PACKET_IGNORE_OUTGOING, &val,
+		       sizeof(val)))
+		ODP_DBG("setsockopt(PACKET_IGNORE_OUTGOING): %s\n",
+			strerror(errno));
+#endif
+
+	if (uring_bind_sock(pkt_uring, rxq->sock, ETH_P_ALL))
+		return -1;
+
+	if (pkt_uring->num_rxq > 1 &&
+	    uring_fanout_join(pkt_uring, idx, fanout_id))
+		return -1;
+
+	/* Every receive buffer may produce a completion, in addition to
+	 * receive termination and cancel completions */
+	if (uring_open(&rxq->ring, URING_RX_SQ_SIZE, 2 * num))
+		return -1;
+
+	rxq->bufs_len = ROUNDUP_ALIGN(num * sizeof(struct io_uring_buf),
+				      ODP_PAGE_SIZE);
+	rxq->bufs = mmap(NULL, rxq->bufs_len, PROT_READ | PROT_WRITE,
+			 MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+	if (rxq->bufs == MAP_FAILED) {
+		__odp_errno = errno;
+		rxq->bufs = NULL;
+		ODP_ERR("mmap(): %s\n", strerror(errno));
+		return -1;
+	}
+	rxq->bufs_tail = &rxq->bufs[0].resv;
+	rxq->bufs_local_tail = 0;
+
+	memset(&reg, 0, sizeof(reg));
+	reg.ring_addr = (uint64_t)(uintptr_t)rxq->bufs;
+	reg.ring_entries = num;
+	reg.bgid = URING_RX_BGID;
+
+	if (sys_io_uring_register(rxq->ring.fd, IORING_REGISTER_PBUF_RING,
+				  &reg, 1)) {
+		__odp_errno = errno;
+		ODP_ERR("io_uring_register(PBUF_RING): %s\n", strerror(errno));
+		return -1;
+	}
+
+	for (i = 0; i < num; i++) {
+		rxq->pkt[i] = ODP_PACKET_INVALID;
+		rxq->free_bid[i] = num - 1 - i;
+	}
+	rxq->num_free = num;
+
+	uring_rx_refill(pktio_entry, rxq);
+
+	/* Receive is armed by the first receive call. The kernel cancels the
+	 * request when the arming thread exits, so it should be armed by a
+	 * thread that polls the queue, rather than by the one starting the
+	 * interface. */
+	rxq->armed = 0;
+
+	return 0;
+}
+
+static void uring_rxq_close(pkt_uring_t *pkt_uring, uring_rxq_t *rxq)
+{
+	uint32_t num = pkt_uring->opt.num_rx_buf;
+	uint32_t i, j, n;
+	odp_time_t tmo;
+
+	/* Wait for termination of multishot receive, so that the kernel
+	 * does not write into the buffers anymore */
+	if (rxq->armed && uring_cancel_all(&rxq->ring) == 0) {
+		struct __kernel_timespec ts = { .tv_nsec = ODP_TIME_MSEC_IN_NS };
+
+		tmo = odp_time_sum(odp_time_local(),
+				   odp_time_local_from_ns(URING_DRAIN_TMO_NS));
+
+		while (rxq->armed && odp_time_cmp(odp_time_local(), tmo) < 0) {
+			uring_wait(&rxq->ring, &ts);
+
+			n = uring_cq_avail(&rxq->ring);
+			for (j = 0; j < n; j++) {
+				struct io_uring_cqe *cqe = uring_cqe(&rxq->ring,
+								     j);
+
+				if (cqe->user_data != URING_UD_RECV)
+					continue;
+
+				if (!(cqe->flags & IORING_CQE_F_MORE))
+					rxq->armed = 0;
+
+				/* Buffer is freed below */
+				if (cqe->flags & IORING_CQE_F_BUFFER)
+					rxq->free_bid[rxq->num_free++] =
+						cqe->flags >>
+						IORING_CQE_BUFFER_SHIFT;
+			}
+			uring_cq_release(&rxq->ring, n);
+		}
+
+		if (rxq->armed)
+			ODP_ERR("io_uring: receive cancel timeout\n");
+	}
+
+	if (rxq->bufs && rxq->ring.fd != -1) {
+		struct io_uring_buf_reg reg;
+
+		memset(&reg, 0, sizeof(reg));
+		reg.bgid = URING_RX_BGID;
+		sys_io_uring_register(rxq->ring.fd, IORING_UNREGISTER_PBUF_RING,
+				      &reg, 1);
+	}
+
+	uring_close(&rxq->ring);
+
+	if (rxq->bufs && munmap(rxq->bufs, rxq->bufs_len))
+		ODP_ERR("munmap(): %s\n", strerror(errno));
+	rxq->bufs = NULL;
+
+	if (rxq->sock != -1 && close(rxq->sock))
+		ODP_ERR("close(rx sock): %s\n", strerror(errno));
+	rxq->sock = -1;
+
+	/* Free packets which were left to the kernel */
+	for (i = 0; rxq->pkt && i < num; i++) {
+		if (rxq->pkt[i] != ODP_PACKET_INVALID)
+			odp_packet_free(rxq->pkt[i]);
+		rxq->pkt[i] = ODP_PACKET_INVALID;
+	}
+	rxq->num_free = 0;
+}
+
+/* Register packet pool memory as fixed buffers of a transmit ring. A buffer
+ * covers at most URING_MAX_FIXED_BUF_LEN bytes of the pool. */
+static void uring_fixed_buf_register(pkt_uring_t *pkt_uring, uring_txq_t *txq)
+{
+	pool_t *pool = pkt_uring->pool;
+	uint64_t len = ROUNDUP_ALIGN(pool->shm_size, ODP_PAGE_SIZE);
+	uint32_t num = (len + URING_MAX_FIXED_BUF_LEN - 1) /
+		       URING_MAX_FIXED_BUF_LEN;
+	struct iovec iov[num];
+	uint32_t i;
+
+	for (i = 0; i < num; i++) {
+		uint64_t offset = i * URING_MAX_FIXED_BUF_LEN;
+
+		iov[i].iov_base = pool->base_addr + offset;
+		iov[i].iov_len = len - offset;
+		if (iov[i].iov_len > URING_MAX_FIXED_BUF_LEN)
+			iov[i].iov_len = URING_MAX_FIXED_BUF_LEN;
+	}
+
+	if (sys_io_uring_register(txq->ring.fd, IORING_REGISTER_BUFFERS, iov,
+				  num)) {
+		/* Registration depends e.g. on locked memory limit.
+		 * Transmit without fixed buffers. */
+		ODP_DBG("%s: io_uring_register(BUFFERS): %s\n",
+			pkt_uring->if_name, strerror(errno));
+		pkt_uring->num_fixed_buf = 0;
+		return;
+	}
+
+	pkt_uring->num_fixed_buf = num;
+}
+
+static int uring_txq_open(pkt_uring_t *pkt_uring, uint32_t idx)
+{
+	uring_txq_t *txq = &pkt_uring->txq[idx];
+	uint32_t num = pkt_uring->opt.num_tx_desc;
+
+	txq->sock = uring_pkt_socket();
+	if (txq->sock == -1)
+		return -1;
+
+	/* Zero protocol: transmit only, no packets are received into the
+	 * socket */
+	if (uring_bind_sock(pkt_uring, txq->sock, 0))
+		return -1;
+
+	if (uring_open(&txq->ring, num, num))
+		return -1;
+
+	/* All rings register the same buffers, or none of them do */
+	if (pkt_uring->opt.fixed_buf && (idx == 0 || pkt_uring->num_fixed_buf))
+		uring_fixed_buf_register(pkt_uring, txq);
+
+	return 0;
+}
+
+/* Free transmitted packets. Packets of failed transmits are dropped. */
+static inline void uring_tx_reap(uring_txq_t *txq)
+{
+	odp_packet_t pkt[URING_BURST];
+	uint64_t user_data;
+	uint32_t i, num;
+	int num_pkt;
+
+	while (txq->inflight) {
+		num = uring_cq_avail(&txq->ring);
+		if (num == 0)
+			break;
+
+		if (num > URING_BURST)
+			num = URING_BURST;
+
+		num_pkt = 0;
+		for (i = 0; i < num; i++) {
+			user_data = uring_cqe(&txq->ring, i)->user_data;
+
+			if (odp_likely(user_data != URING_UD_CANCEL))
+				pkt[num_pkt++] = (odp_packet_t)(uintptr_t)
+						 user_data;
+		}
+
+		uring_cq_release(&txq->ring, num);
+		txq->inflight -= num;
+
+		odp_packet_free_multi(pkt, num_pkt);
+	}
+}
+
+static void uring_txq_close(uring_txq_t *txq)
+{
+	struct __kernel_timespec ts = { .tv_nsec = ODP_TIME_MSEC_IN_NS };
+	odp_time_t drain_tmo = odp_time_local_from_ns(URING_DRAIN_TMO_NS);
+	odp_time_t tmo = odp_time_sum(odp_time_local(), drain_tmo);
+	int cancel = 1;
+
+	while (txq->inflight) {
+		uring_tx_reap(txq);
+
+		if (txq->inflight == 0)
+			break;
+
+		if (odp_time_cmp(odp_time_local(), tmo) > 0) {
+			/* Cancelled transmits complete with an error. Cancel
+			 * request has a completion, too. */
+			if (!cancel || uring_cancel_all(&txq->ring)) {
+				ODP_ERR("io_uring: transmit drain timeout\n");
+				break;
+			}
+			txq->inflight++;
+			cancel = 0;
+			tmo = odp_time_sum(odp_time_local(), drain_tmo);
+		}
+
+		uring_wait(&txq->ring, &ts);
+	}
+
+	uring_close(&txq->ring);
+
+	if (txq->sock != -1 && close(txq->sock))
+		ODP_ERR("close(tx sock): %s\n", strerror(errno));
+	txq->sock = -1;
+	txq->inflight = 0;
+}
+
+static int sock_uring_stats_reset(pktio_entry_t *pktio_entry);
+
+static int sock_uring_close(pktio_entry_t *pktio_entry)
+{
+	pkt_uring_t *pkt_uring = pkt_priv(pktio_entry);
+
+	if (pkt_uring->sockfd != -1 && close(pkt_uring->sockfd) != 0) {
+		__odp_errno = errno;
+		ODP_ERR("close(sockfd): %s\n", strerror(errno));
+		return -1;
+	}
+	pkt_uring->sockfd = -1;
+
+	return 0;
+}
+
+static int sock_uring_open(odp_pktio_t id ODP_UNUSED,
+			   pktio_entry_t *pktio_entry, const char *devname,
+			   odp_pool_t pool_hdl)
+{
+	pkt_uring_t *pkt_uring = pkt_priv(pktio_entry);
+	uint16_t frame_offset = pktio_entry->s.pktin_frame_offset;
+	pool_t *pool;
+
+	if (disable_pktio)
+		return -1;
+
+	if (pool_hdl == ODP_POOL_INVALID)
+		return -1;
+
+	memset(pkt_uring, 0, sizeof(pkt_uring_t));
+	pkt_uring->sockfd = -1;
+	pkt_uring->shm = ODP_SHM_INVALID;
+	pkt_uring->fanout = PACKET_FANOUT_HASH;
+
+	pkt_uring->if_idx = if_nametoindex(devname);
+	if (pkt_uring->if_idx == 0)
+		return -1;
+
+	snprintf(pkt_uring->if_name, sizeof(pkt_uring->if_name), "%s",
+		 devname);
+
+	if (init_options(pkt_uring))
+		return -1;
+
+	/* Frames are received into the first segment, after frame offset.
+	 * One extra byte is reserved to detect frames larger than MTU, which
+	 * the kernel would otherwise truncate silently. */
+	pool = pool_entry_from_hdl(pool_hdl);
+	pkt_uring->pool = pool;
+
+	if (pool->seg_len < (uint32_t)frame_offset + _ODP_ETHHDR_LEN + 1) {
+		ODP_DBG("%s: packet pool not suitable for io_uring\n", devname);
+		return -1;
+	}
+
+	pkt_uring->sockfd = uring_pkt_socket();
+	if (pkt_uring->sockfd == -1)
+		goto error;
+
+	pkt_uring->mtu = mtu_get_fd(pkt_uring->sockfd, pkt_uring->if_name);
+	if (!pkt_uring->mtu)
+		goto error;
+
+	if (pkt_uring->mtu > pool->seg_len - frame_offset - 1) {
+		pkt_uring->mtu = pool->seg_len - frame_offset - 1;
+		ODP_DBG("%s: MTU limited by packet pool segment length to %u\n",
+			pkt_uring->if_name, pkt_uring->mtu);
+	}
+	pkt_uring->max_frame_len = pkt_uring->mtu + 1;
+
+	if (mac_addr_get_fd(pkt_uring->sockfd, pkt_uring->if_name,
+			    pkt_uring->if_mac))
+		goto error;
+
+	pktio_entry->s.stats_type = sock_stats_type_fd(pktio_entry,
+						       pkt_uring->sockfd);
+	if (pktio_entry->s.stats_type == STATS_UNSUPPORTED)
+		ODP_DBG("pktio: %s unsupported stats\n", pktio_entry->s.name);
+
+	if (sock_uring_stats_reset(pktio_entry))
+		goto error;
+
+	return 0;
+
+error:
+	sock_uring_close(pktio_entry);
+	return -1;
+}
+
+static int sock_uring_stop(pktio_entry_t *pktio_entry)
+{
+	pkt_uring_t *pkt_uring = pkt_priv(pktio_entry);
+	uint32_t i;
+
+	for (i = 0; i < pkt_uring->num_rxq; i++)
+		uring_rxq_close(pkt_uring, &pkt_uring->rxq[i]);
+
+	for (i = 0; i < pkt_uring->num_txq; i++)
+		uring_txq_close(&pkt_uring->txq[i]);
+
+	pkt_uring->num_rxq = 0;
+	pkt_uring->num_txq = 0;
+	pkt_uring->num_fixed_buf = 0;
+	pkt_uring->rxq = NULL;
+	pkt_uring->txq = NULL;
+
+	if (pkt_uring->shm != ODP_SHM_INVALID) {
+		if (odp_shm_free(pkt_uring->shm)) {
+			ODP_ERR("shm free failed\n");
+			return -1;
+		}
+		pkt_uring->shm = ODP_SHM_INVALID;
+	}
+
+	return 0;
+}
+
+static int sock_uring_start(pktio_entry_t *pktio_entry)
+{
+	pkt_uring_t *pkt_uring = pkt_priv(pktio_entry);
+	odp_pktin_mode_t in_mode = pktio_entry->s.param.in_mode;
+	odp_pktout_mode_t out_mode = pktio_entry->s.param.out_mode;
+	uint32_t num_buf = pkt_uring->opt.num_rx_buf;
+	char name[ODP_SHM_NAME_LEN];
+	uint32_t num_rx, num_tx, i;
+	uint32_t fanout_id = 0;
+	uint8_t *ptr;
+	uint64_t size;
+
+	/* If no pktin/pktout queues have been configured. Configure one
+	 * for each direction. */
+	if (!pktio_entry->s.num_in_queue &&
+	    in_mode != ODP_PKTIN_MODE_DISABLED) {
+		odp_pktin_queue_param_t param;
+
+		odp_pktin_queue_param_init(&param);
+		param.num_queues = 1;
+		if (odp_pktin_queue_config(pktio_entry->s.handle, &param))
+			return -1;
+	}
+	if (!pktio_entry->s.num_out_queue &&
+	    out_mode == ODP_PKTOUT_MODE_DIRECT) {
+		odp_pktout_queue_param_t param;
+
+		odp_pktout_queue_param_init(&param);
+		param.num_queues = 1;
+		if (odp_pktout_queue_config(pktio_entry->s.handle, &param))
+			return -1;
+	}
+
+	num_rx = in_mode == ODP_PKTIN_MODE_DISABLED ? 0 :
+			pktio_entry->s.num_in_queue;
+	num_tx = out_mode == ODP_PKTOUT_MODE_DISABLED ? 0 :
+			pktio_entry->s.num_out_queue;
+
+	if (num_rx + num_tx == 0)
+		return 0;
+
+	/* Queue tables are followed by packet and free buffer id arrays of
+	 * each input queue */
+	size = num_rx * sizeof(uring_rxq_t) + num_tx * sizeof(uring_txq_t) +
+	       num_rx * num_buf * (sizeof(odp_packet_t) + sizeof(uint16_t));
+
+	snprintf(name, sizeof(name), "_odp_pktio_uring_%" PRIu64,
+		 odp_pktio_to_u64(pktio_entry->s.handle));
+	pkt_uring->shm = odp_shm_reserve(name, size, ODP_CACHE_LINE_SIZE, 0);
+	if (pkt_uring->shm == ODP_SHM_INVALID) {
+		ODP_ERR("shm reserve failed\n");
+		return -1;
+	}
+
+	ptr = odp_shm_addr(pkt_uring->shm);
+	memset(ptr, 0, size);
+
+	pkt_uring->rxq = (uring_rxq_t *)(uintptr_t)ptr;
+	ptr += num_rx * sizeof(uring_rxq_t);
+	pkt_uring->txq = (uring_txq_t *)(uintptr_t)ptr;
+	ptr += num_tx * sizeof(uring_txq_t);
+
+	for (i = 0; i < num_rx; i++) {
+		uring_rxq_t *rxq = &pkt_uring->rxq[i];
+
+		odp_ticketlock_init(&rxq->lock);
+		rxq->sock = -1;
+		rxq->ring.fd = -1;
+		rxq->pkt = (odp_packet_t *)(uintptr_t)ptr;
+		ptr += num_buf * sizeof(odp_packet_t);
+	}
+
+	for (i = 0; i < num_rx; i++) {
+		pkt_uring->rxq[i].free_bid = (uint16_t *)(uintptr_t)ptr;
+		ptr += num_buf * sizeof(uint16_t);
+	}
+
+	for (i = 0; i < num_tx; i++) {
+		odp_ticketlock_init(&pkt_uring->txq[i].lock);
+		pkt_uring->txq[i].sock = -1;
+		pkt_uring->txq[i].ring.fd = -1;
+	}
+
+	pkt_uring->num_rxq = num_rx;
+	pkt_uring->num_txq = num_tx;
+
+	for (i = 0; i < num_rx; i++) {
+		if (uring_rxq_open(pktio_entry, i, &fanout_id))
+			goto error;
+	}
+
+	for (i = 0; i < num_tx; i++) {
+		if (uring_txq_open(pkt_uring, i))
+			goto error;
+	}
+
+	return 0;
+
+error:
+	sock_uring_stop(pktio_entry);
+	return -1;
+}
+
+static inline int uring_recv(pktio_entry_t *pktio_entry, uring_rxq_t *rxq,
+			     odp_packet_t pkt_table[], int num)
+{
+	pkt_uring_t *pkt_uring = pkt_priv(pktio_entry);
+	odp_pool_t pool_hdl = pkt_uring->pool->pool_hdl;
+	odp_time_t ts_val;
+	odp_time_t *ts = NULL;
+	uint32_t i, n;
+	int nb_rx = 0;
+
+	n = uring_cq_avail(&rxq->ring);
+	if (n > (uint32_t)num)
+		n = num;
+
+	if (n && (pktio_entry->s.config.pktin.bit.ts_all ||
+		  pktio_entry->s.config.pktin.bit.ts_ptp)) {
+		ts_val = odp_time_global();
+		ts = &ts_val;
+	}
+
+	for (i = 0; i < n; i++) {
+		struct io_uring_cqe *cqe = uring_cqe(&rxq->ring, i);
+		odp_packet_hdr_t *pkt_hdr;
+		odp_packet_t pkt;
+		struct ethhdr *eth_hdr;
+		uint8_t *data;
+		uint16_t bid;
+		int len = cqe->res;
+
+		if (odp_unlikely(cqe->user_data != URING_UD_RECV))
+			continue;
+
+		if (odp_unlikely(!(cqe->flags & IORING_CQE_F_MORE)))
+			rxq->armed = 0;
+
+		if (odp_unlikely(!(cqe->flags & IORING_CQE_F_BUFFER))) {
+			/* Receive buffers ran out (ENOBUFS), or receive was
+			 * cancelled when the arming thread exited */
+			if (len < 0 && len != -ENOBUFS && len != -ECANCELED)
+				ODP_DBG("%s: io_uring receive: %s\n",
+					pkt_uring->if_name, strerror(-len));
+			continue;
+		}
+
+		bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+		pkt = rxq->pkt[bid];
+		rxq->pkt[bid] = ODP_PACKET_INVALID;
+		rxq->free_bid[rxq->num_free++] = bid;
+
+		pkt_hdr = packet_hdr(pkt);
+		data = pkt_hdr->seg_data;
+		odp_prefetch(data);
+
+		if (odp_unlikely(len <= 0 || (uint32_t)len > pkt_uring->mtu)) {
+			ODP_DBG("dropped oversized packet\n");
+			odp_packet_free(pkt);
+			continue;
+		}
+
+		/* Don't receive packets sent by ourselves */
+		eth_hdr = (struct ethhdr *)data;
+		if (odp_unlikely(ethaddrs_equal(pkt_uring->if_mac,
+						eth_hdr->h_source))) {
+			odp_packet_free(pkt);
+			continue;
+		}
+
+		pull_tail(pkt_hdr, pkt_uring->max_frame_len - len);
+
+		if (pktio_cls_enabled(pktio_entry)) {
+			odp_pool_t new_pool;
+
+			if (cls_classify_packet(pktio_entry, data, len, len,
+						&new_pool, pkt_hdr, true)) {
+				odp_packet_free(pkt);
+				continue;
+			}
+
+			if (odp_unlikely(new_pool != pool_hdl)) {
+				odp_packet_t new_pkt;
+
+				new_pkt = odp_packet_copy(pkt, new_pool);
+				odp_packet_free(pkt);
+
+				if (new_pkt == ODP_PACKET_INVALID)
+					continue;
+
+				pkt = new_pkt;
+				pkt_hdr = packet_hdr(new_pkt);
+			}
+		} else {
+			packet_parse_layer(pkt_hdr,
+					   pktio_entry->s.config.parser.layer,
+					   pktio_entry->s.in_chksums);
+		}
+
+		packet_set_ts(pkt_hdr, ts);
+		pkt_hdr->input = pktio_entry->s.handle;
+
+		pkt_table[nb_rx++] = pkt;
+	}
+
+	if (n)
+		uring_cq_release(&rxq->ring, n);
+
+	if (rxq->num_free >= URING_BURST || !rxq->armed)
+		uring_rx_refill(pktio_entry, rxq);
+
+	/* Rearm receive, unless all buffers are still free */
+	if (odp_unlikely(!rxq->armed) &&
+	    rxq->num_free < (uint32_t)pkt_uring->opt.num_rx_buf)
+		uring_rx_arm(rxq);
+
+	return nb_rx;
+}
+
+static int sock_uring_recv(pktio_entry_t *pktio_entry, int index,
+			   odp_packet_t pkt_table[], int num)
+{
+	pkt_uring_t *pkt_uring = pkt_priv(pktio_entry);
+	uring_rxq_t *rxq = &pkt_uring->rxq[index];
+	int ret;
+
+	if (!pkt_uring->lockless_rx)
+		odp_ticketlock_lock(&rxq->lock);
+
+	ret = uring_recv(pktio_entry, rxq, pkt_table, num);
+
+	if (!pkt_uring->lockless_rx)
+		odp_ticketlock_unlock(&rxq->lock);
+
+	return ret;
+}
+
+static int sock_uring_fd_set(pktio_entry_t *pktio_entry, int index,
+			     fd_set *readfds)
+{
+	pkt_uring_t *pkt_uring = pkt_priv(pktio_entry);
+	int fd;
+
+	if (pktio_entry->s.state != PKTIO_STATE_STARTED)
+		return -1;
+
+	/* Ring file descriptor is readable when completions are available */
+	fd = pkt_uring->rxq[index].ring.fd;
+	FD_SET(fd, readfds);
+
+	return fd;
+}
+
+/* Wait on the completion queue of the input queue ring, instead of polling
+ * the socket */
+static int sock_uring_recv_tmo(pktio_entry_t *pktio_entry, int index,
+			       odp_packet_t pkt_table[], int num,
+			       uint64_t usecs)
+{
+	pkt_uring_t *pkt_uring = pkt_priv(pktio_entry);
+	uring_rxq_t *rxq = &pkt_uring->rxq[index];
+	struct __kernel_timespec ts;
+	odp_time_t tmo, cur;
+	uint64_t ns;
+	int ret;
+
+	/* Avoid overflow issues for large wait times */
+	if (usecs > URING_MAX_WAIT_US)
+		usecs = URING_MAX_WAIT_US;
+
+	tmo = odp_time_sum(odp_time_local(),
+			   odp_time_local_from_ns(usecs * 1000));
+
+	while (1) {
+		ret = sock_uring_recv(pktio_entry, index, pkt_table, num);
+		if (ret != 0)
+			return ret;
+
+		cur = odp_time_local();
+		if (odp_time_cmp(cur, tmo) >= 0)
+			return 0;
+
+		ns = odp_time_to_ns(odp_time_diff(tmo, cur));
+		ts.tv_sec = ns / ODP_TIME_SEC_IN_NS;
+		ts.tv_nsec = ns - ts.tv_sec * ODP_TIME_SEC_IN_NS;
+
+		/* Completions are reaped above, the lock is not needed */
+		if (uring_wait(&rxq->ring, &ts))
+			return -1;
+	}
+}
+
+static inline int uring_send(pktio_entry_t *pktio_entry, uring_txq_t *txq,
+			     const odp_packet_t pkt_table[], int num)
+{
+	pkt_uring_t *pkt_uring = pkt_priv(pktio_entry);
+	pool_t *pool = pkt_uring->pool;
+	uint8_t tx_ts_enabled = _odp_pktio_tx_ts_enabled(pktio_entry);
+	struct io_uring_sqe *sqe = NULL;
+	int tx_ts_idx = 0;
+	uint32_t free;
+	int i;
+
+	uring_tx_reap(txq);
+
+	free = pkt_uring->opt.num_tx_desc - txq->inflight;
+	if (free > uring_sq_free(&txq->ring))
+		free = uring_sq_free(&txq->ring);
+	if ((uint32_t)num > free)
+		num = free;
+
+	for (i = 0; i < num; i++) {
+		odp_packet_t pkt = pkt_table[i];
+		odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
+		uint32_t len = pkt_hdr->frame_len;
+		uint8_t *data;
+
+		if (odp_unlikely(len > pkt_uring->mtu)) {
+			if (i == 0) {
+				__odp_errno = EMSGSIZE;
+				return -1;
+			}
+			break;
+		}
+
+		if (tx_ts_enabled && tx_ts_idx == 0) {
+			if (odp_unlikely(pkt_hdr->p.flags.ts_set))
+				tx_ts_idx = i + 1;
+		}
+
+		/* Frame is sent from a single segment. Copy segmented
+		 * packets. */
+		if (odp_unlikely(pkt_hdr->seg_count > 1)) {
+			odp_packet_t new_pkt;
+
+			if (packet_alloc_multi(pool->pool_hdl, len, &new_pkt,
+					       1) != 1)
+				break;
+
+			pkt_hdr = packet_hdr(new_pkt);
+			odp_packet_copy_to_mem(pkt, 0, len, pkt_hdr->seg_data);
+			odp_packet_free(pkt);
+			pkt = new_pkt;
+		}
+
+		data = pkt_hdr->seg_data;
+		sqe = uring_get_sqe(&txq->ring);
+		sqe->fd = txq->sock;
+		sqe->addr = (uint64_t)(uintptr_t)data;
+		sqe->len = len;
+		sqe->user_data = (uint64_t)(uintptr_t)pkt;
+
+		/* Link requests to keep packet order, also when the socket
+		 * send buffer is full and the kernel retries a transmit */
+		sqe->flags = IOSQE_IO_LINK;
+
+		if (pkt_uring->num_fixed_buf &&
+		    pkt_hdr->buf_hdr.pool_ptr == pool) {
+			uint64_t offset = data - pool->base_addr;
+			uint32_t idx = offset / URING_MAX_FIXED_BUF_LEN;
+
+			if (odp_likely(idx == (offset + len - 1) /
+					      URING_MAX_FIXED_BUF_LEN)) {
+				sqe->opcode = IORING_OP_WRITE_FIXED;
+				sqe->buf_index = idx;
+				continue;
+			}
+		}
+
+		sqe->opcode = IORING_OP_SEND;
+	}
+
+	if (odp_unlikely(i == 0))
+		return 0;
+
+	/* Last request ends the link */
+	sqe->flags = 0;
+	txq->inflight += i;
+
+	/* Requests stay in the ring and are submitted again on the next
+	 * call, if the kernel fails to consume them now */
+	uring_submit(&txq->ring);
+
+	if (odp_unlikely(tx_ts_idx && i >= tx_ts_idx))
+		_odp_pktio_tx_ts_set(pktio_entry);
+
+	return i;
+}
+
+static int sock_uring_send(pktio_entry_t *pktio_entry, int index,
+			   const odp_packet_t pkt_table[], int num)
+{
+	pkt_uring_t *pkt_uring = pkt_priv(pktio_entry);
+	uring_txq_t *txq = &pkt_uring->txq[index];
+	int ret;
+
+	if (!pkt_uring->lockless_tx)
+		odp_ticketlock_lock(&txq->lock);
+
+	ret = uring_send(pktio_entry, txq, pkt_table, num);
+
+	if (!pkt_uring->lockless_tx)
+		odp_ticketlock_unlock(&txq->lock);
+
+	return ret;
+}
+
+static int sock_uring_input_queues_config(pktio_entry_t *pktio_entry,
+					  const odp_pktin_queue_param_t *p)
+{
+	pkt_uring_t *pkt_uring = pkt_priv(pktio_entry);
+	odp_pktin_mode_t mode = pktio_entry->s.param.in_mode;
+
+	/* Scheduler synchronizes input queue polls. Only single thread
+	 * at a time polls a queue */
+	if (mode == ODP_PKTIN_MODE_SCHED)
+		pkt_uring->lockless_rx = 1;
+	else
+		pkt_uring->lockless_rx = (p->op_mode == ODP_PKTIO_OP_MT_UNSAFE);
+
+	/* Kernel distributes packets to the sockets of input queues. With
+	 * hashing, flows are spread with the kernel flow hash (L3 addresses
+	 * and L4 ports). Otherwise, by interface receive queue. */
+	pkt_uring->fanout = p->hash_enable ? PACKET_FANOUT_HASH :
+					     PACKET_FANOUT_QM;
+
+	return 0;
+}
+
+static int sock_uring_output_queues_config(pktio_entry_t *pktio_entry,
+					   const odp_pktout_queue_param_t *p)
+{
+	pkt_priv(pktio_entry)->lockless_tx =
+		(p->op_mode == ODP_PKTIO_OP_MT_UNSAFE);
+
+	return 0;
+}
+
+static uint32_t sock_uring_mtu_get(pktio_entry_t *pktio_entry)
+{
+	return pkt_priv(pktio_entry)->mtu;
+}
+
+static int sock_uring_mac_addr_get(pktio_entry_t *pktio_entry,
+				   void *mac_addr)
+{
+	memcpy(mac_addr, pkt_priv(pktio_entry)->if_mac, ETH_ALEN);
+	return ETH_ALEN;
+}
+
+static int sock_uring_promisc_mode_set(pktio_entry_t *pktio_entry,
+				       odp_bool_t enable)
+{
+	return promisc_mode_set_fd(pkt_priv(pktio_entry)->sockfd,
+				   pkt_priv(pktio_entry)->if_name, enable);
+}
+
+static int sock_uring_promisc_mode_get(pktio_entry_t *pktio_entry)
+{
+	return promisc_mode_get_fd(pkt_priv(pktio_entry)->sockfd,
+				   pkt_priv(pktio_entry)->if_name);
+}
+
+static int sock_uring_link_status(pktio_entry_t *pktio_entry)
+{
+	return link_status_fd(pkt_priv(pktio_entry)->sockfd,
+			      pkt_priv(pktio_entry)->if_name);
+}
+
+static int sock_uring_link_info(pktio_entry_t *pktio_entry,
+				odp_pktio_link_info_t *info)
+{
+	return link_info_fd(pkt_priv(pktio_entry)->sockfd,
+			    pkt_priv(pktio_entry)->if_name, info);
+}
+
+static int sock_uring_capability(pktio_entry_t *pktio_entry ODP_UNUSED,
+				 odp_pktio_capability_t *capa)
+{
+	memset(capa, 0, sizeof(odp_pktio_capability_t));
+
+	capa->max_input_queues  = PKTIO_MAX_QUEUES;
+	capa->max_output_queues = PKTIO_MAX_QUEUES;
+	capa->set_op.op.promisc_mode = 1;
+
+	odp_pktio_config_init(&capa->config);
+	capa->config.pktin.bit.ts_all = 1;
+	capa->config.pktin.bit.ts_ptp = 1;
+
+	capa->config.pktout.bit.ts_ena = 1;
+
+	return 0;
+}
+
+static int sock_uring_stats(pktio_entry_t *pktio_entry,
+			    odp_pktio_stats_t *stats)
+{
+	if (pktio_entry->s.stats_type == STATS_UNSUPPORTED) {
+		memset(stats, 0, sizeof(*stats));
+		return 0;
+	}
+
+	return sock_stats_fd(pktio_entry, stats, pkt_priv(pktio_entry)->sockfd);
+}
+
+static int sock_uring_stats_reset(pktio_entry_t *pktio_entry)
+{
+	if (pktio_entry->s.stats_type == STATS_UNSUPPORTED) {
+		memset(&pktio_entry->s.stats, 0, sizeof(odp_pktio_stats_t));
+		return 0;
+	}
+
+	return sock_stats_reset_fd(pktio_entry, pkt_priv(pktio_entry)->sockfd);
+}
+
+static void sock_uring_print(pktio_entry_t *pktio_entry)
+{
+	pkt_uring_t *pkt_uring = pkt_priv(pktio_entry);
+
+	ODP_PRINT("  rx fanout mode    %s\n",
+		  pkt_uring->fanout == PACKET_FANOUT_HASH ? "hash" : "qm");
+	ODP_PRINT("  rx buffers        %i\n", pkt_uring->opt.num_rx_buf);
+	ODP_PRINT("  tx descriptors    %i\n", pkt_uring->opt.num_tx_desc);
+	ODP_PRINT("  tx fixed buffers  %u\n", pkt_uring->num_fixed_buf);
+	ODP_PRINT("  max frame len     %u\n", pkt_uring->mtu);
+}
+
+static int sock_uring_init_global(void)
+{
+	if (getenv("ODP_PKTIO_DISABLE_SOCKET_URING")) {
+		ODP_PRINT("PKTIO: socket io_uring skipped,"
+			  " enabled export ODP_PKTIO_DISABLE_SOCKET_URING=1.\n");
+		disable_pktio = 1;
+	} else {
+		ODP_PRINT("PKTIO: initialized socket io_uring,"
+			  " use export ODP_PKTIO_DISABLE_SOCKET_URING=1 to disable.\n");
+	}
+	return 0;
+}
+
+const pktio_if_ops_t sock_uring_pktio_ops = {
+	.name = "socket_uring",
+	.print = sock_uring_print,
+	.init_global = sock_uring_init_global,
+	.init_local = NULL,
+	.term = NULL,
+	.open = sock_uring_open,
+	.close = sock_uring_close,
+	.start = sock_uring_start,
+	.stop = sock_uring_stop,
+	.stats = sock_uring_stats,
+	.stats_reset = sock_uring_stats_reset,
+	.recv = sock_uring_recv,
+	.recv_tmo = sock_uring_recv_tmo,
+	.recv_mq_tmo = NULL,
+	.send = sock_uring_send,
+	.fd_set = sock_uring_fd_set,
+	.mtu_get = sock_uring_mtu_get,
+	.promisc_mode_set = sock_uring_promisc_mode_set,
+	.promisc_mode_get = sock_uring_promisc_mode_get,
+	.mac_get = sock_uring_mac_addr_get,
+	.mac_set = NULL,
+	.link_status = sock_uring_link_status,
+	.link_info = sock_uring_link_info,
+	.capability = sock_uring_capability,
+	.pktio_ts_res = NULL,
+	.pktio_ts_from_ns = NULL,
+	.pktio_time = NULL,
+	.config = NULL,
+	.input_queues_config = sock_uring_input_queues_config,
+	.output_queues_config = sock_uring_output_queues_config,
+};
+
+#endif /* _ODP_PKTIO_IO_URING */
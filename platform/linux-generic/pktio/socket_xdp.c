@@ -0,0 +1,1393 @@
+/* Copyright (c) 2020, Nokia
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier:     BSD-3-Clause
+ */
+
+/**
+ * @file
+ *
+ * AF_XDP socket packet I/O
+ *
+ * Packet pool memory is registered as AF_XDP UMEM, so packets are received
+ * directly into and transmitted directly from packet buffers. Each
+ * pktin/pktout queue pair uses its own AF_XDP socket, which is bound to the
+ * interface queue of the same index. A small XDP program redirects received
+ * packets to the sockets through an XSKMAP. Packets of interface queues
+ * without a socket are passed to the kernel network stack.
+ *
+ * The driver uses kernel interfaces directly (no libbpf / libxdp
+ * dependency) and requires Linux kernel 5.9 or newer.
+ */
+
+#include <odp/autoheader_internal.h>
+
+#ifdef _ODP_PKTIO_XDP
+
+#include <odp_posix_extensions.h>
+
+#include <odp/api/packet.h>
+#include <odp/api/plat/packet_inlines.h>
+#include <odp/api/shared_memory.h>
+#include <odp/api/ticketlock.h>
+#include <odp/api/time.h>
+
+#include <odp_packet_io_internal.h>
+#include <odp_packet_internal.h>
+#include <odp_pool_internal.h>
+#include <odp_packet_io_stats.h>
+#include <odp_ethtool_stats.h>
+#include <odp_ethtool_rss.h>
+#include <odp_socket_common.h>
+#include <odp_debug_internal.h>
+#include <odp_errno_define.h>
+#include <odp_align_internal.h>
+#include <odp_classification_datamodel.h>
+#include <odp_classification_internal.h>
+#include <odp_libconfig_internal.h>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/bpf.h>
+#include <linux/ethtool.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+#include <linux/sockios.h>
+
+#ifndef AF_XDP
+#define AF_XDP 44
+#endif
+
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+/* Minimum UMEM chunk size accepted by the kernel */
+#define XDP_CHUNK_SIZE_MIN 2048
+
+/* Maximum number of packets per fill ring refill and completion ring reap */
+#define XDP_BURST 64
+
+/* Fill ring is refilled when at least this many slots are free */
+#define XDP_FILL_THRESHOLD 32
+
+/* In generic mode, kernel transmits at most this many packets per wakeup */
+#define XDP_TX_WAKEUP_BATCH 32
+
+/* Limits for the number of ring descriptors */
+#define XDP_MIN_DESC XDP_BURST
+#define XDP_MAX_DESC (32 * 1024)
+
+/* Maximum time to wait for transmit completions when stopping */
+#define XDP_TX_DRAIN_TMO_NS (100 * ODP_TIME_MSEC_IN_NS)
+
+/* Maximum time to wait for the kernel to release the interface queue of a
+ * previously closed socket */
+#define XDP_BIND_TMO_NS (1000 * ODP_TIME_MSEC_IN_NS)
+
+/* XDP program attach modes */
+#define XDP_ATTACH_NATIVE  0
+#define XDP_ATTACH_GENERIC 1
+
+/** AF_XDP socket runtime configuration options */
+typedef struct {
+	int attach_mode;
+	int num_desc;
+} xdp_opt_t;
+
+/** AF_XDP ring (fill, completion, RX or TX) shared with the kernel */
+typedef struct {
+	uint32_t *producer;
+	uint32_t *consumer;
+	uint32_t *flags;
+	void *desc;
+	uint32_t mask;
+	uint32_t size;
+	/* Local copies of the producer and consumer indexes */
+	uint32_t cached_prod;
+	uint32_t cached_cons;
+	void *map;
+	size_t map_len;
+} xdp_ring_t;
+
+/** AF_XDP socket of a pktin/pktout queue pair */
+typedef struct ODP_ALIGNED_CACHE {
+	/* Receive side: fill and RX rings */
+	odp_ticketlock_t rx_lock;
+	xdp_ring_t fill;
+	xdp_ring_t rx;
+	/* Packets given to the kernel through the fill ring. A bit per
+	 * pool buffer. */
+	uint64_t *rx_owned;
+
+	/* Transmit side: TX and completion rings */
+	odp_ticketlock_t tx_lock ODP_ALIGNED_CACHE;
+	xdp_ring_t tx;
+	xdp_ring_t comp;
+	/* Packets given to the kernel through the TX ring */
+	uint64_t *tx_owned;
+	uint32_t tx_pending;
+
+	int fd;
+} xdp_sock_t;
+
+/** Packet socket using AF_XDP sockets for both Rx and Tx */
+typedef struct {
+	xdp_sock_t *sock;		/**< Sockets, one per queue index */
+	odp_shm_t shm;			/**< Socket table and bitmaps */
+	uint32_t num_sock;		/**< Number of sockets */
+	uint32_t bitmap_words;		/**< Packet bitmap size in words */
+	pool_t *pool;			/**< Pool to alloc packets from */
+	uint8_t *umem;			/**< UMEM start (pool base address) */
+	uint64_t umem_len;		/**< UMEM length */
+	uint32_t chunk_size;		/**< UMEM chunk size */
+	uint32_t max_frame_len;		/**< Maximum frame length */
+	uint32_t mtu;			/**< Maximum transmission unit */
+	uint32_t num_rx_queues;		/**< Number of interface RX queues */
+	uint32_t num_tx_queues;		/**< Number of interface TX queues */
+	int sockfd;			/**< Control socket */
+	int ifindex;			/**< Interface index */
+	int map_fd;			/**< XSKMAP */
+	int prog_fd;			/**< XDP program */
+	int link_fd;			/**< XDP program link to interface */
+	odp_bool_t copy_mode;		/**< Force copy mode */
+	odp_bool_t lockless_rx;		/**< No locking for rx */
+	odp_bool_t lockless_tx;		/**< No locking for tx */
+	xdp_opt_t opt;			/**< Options */
+	unsigned char if_mac[ETH_ALEN]; /**< Interface MAC address */
+	char if_name[IF_NAMESIZE];	/**< Interface name */
+} pkt_xdp_t;
+
+ODP_STATIC_ASSERT(PKTIO_PRIVATE_SIZE >= sizeof(pkt_xdp_t),
+		  "PKTIO_PRIVATE_SIZE too small");
+
+static inline pkt_xdp_t *pkt_priv(pktio_entry_t *pktio_entry)
+{
+	return (pkt_xdp_t *)(uintptr_t)(pktio_entry->s.pkt_priv);
+}
+
+static int disable_pktio; /** !0 this pktio disabled, 0 enabled */
+
+static inline uint32_t ring_prod_free(xdp_ring_t *ring, uint32_t num)
+{
+	uint32_t free = ring->size - (ring->cached_prod - ring->cached_cons);
+
+	if (free >= num)
+		return free;
+
+	ring->cached_cons = __atomic_load_n(ring->consumer, __ATOMIC_ACQUIRE);
+
+	return ring->size - (ring->cached_prod - ring->cached_cons);
+}
+
+static inline void ring_prod_submit(xdp_ring_t *ring, uint32_t num)
+{
+	ring->cached_prod += num;
+	__atomic_store_n(ring->producer, ring->cached_prod, __ATOMIC_RELEASE);
+}
+
+static inline uint32_t ring_cons_avail(xdp_ring_t *ring, uint32_t num)
+{
+	uint32_t avail = ring->cached_prod - ring->cached_cons;
+
+	if (avail == 0) {
+		ring->cached_prod = __atomic_load_n(ring->producer,
+						    __ATOMIC_ACQUIRE);
+		avail = ring->cached_prod - ring->cached_cons;
+	}
+
+	return avail < num ? avail : num;
+}
+
+static inline void ring_cons_release(xdp_ring_t *ring, uint32_t num)
+{
+	ring->cached_cons += num;
+	__atomic_store_n(ring->consumer, ring->cached_cons, __ATOMIC_RELEASE);
+}
+
+static inline int ring_needs_wakeup(xdp_ring_t *ring)
+{
+	return __atomic_load_n(ring->flags, __ATOMIC_RELAXED) &
+		XDP_RING_NEED_WAKEUP;
+}
+
+static inline void owned_set(uint64_t *bitmap, uint32_t idx)
+{
+	bitmap[idx / 64] |= (1ULL << (idx % 64));
+}
+
+static inline void owned_clr(uint64_t *bitmap, uint32_t idx)
+{
+	bitmap[idx / 64] &= ~(1ULL << (idx % 64));
+}
+
+/* UMEM address of a pointer into pool memory */
+static inline uint64_t umem_addr(pkt_xdp_t *pkt_xdp, const uint8_t *ptr)
+{
+	return (uint64_t)(uintptr_t)(ptr - pkt_xdp->umem);
+}
+
+/* Packet header of a packet buffer containing an UMEM address */
+static inline odp_packet_hdr_t *umem_pkt_hdr(pkt_xdp_t *pkt_xdp,
+					     uint64_t addr)
+{
+	pool_t *pool = pkt_xdp->pool;
+	uint32_t idx = (addr - pool->block_offset) / pool->block_size;
+
+	return (odp_packet_hdr_t *)(uintptr_t)buf_hdr_from_index(pool, idx);
+}
+
+static inline uint32_t pkt_idx(odp_packet_hdr_t *pkt_hdr)
+{
+	return pkt_hdr->buf_hdr.index.buffer;
+}
+
+static int lookup_opt(const char *opt_name, const char *if_name, int *val)
+{
+	const char *base = "pktio_xdp";
+	int ret;
+
+	ret = _odp_libconfig_lookup_ext_int(base, if_name, opt_name, val);
+	if (ret == 0)
+		ODP_ERR("Unable to find AF_XDP configuration option: %s\n",
+			opt_name);
+
+	return ret;
+}
+
+static int init_options(pkt_xdp_t *pkt_xdp)
+{
+	xdp_opt_t *opt = &pkt_xdp->opt;
+
+	if (!lookup_opt("attach_mode", pkt_xdp->if_name, &opt->attach_mode))
+		return -1;
+	if (opt->attach_mode != XDP_ATTACH_NATIVE &&
+	    opt->attach_mode != XDP_ATTACH_GENERIC) {
+		ODP_ERR("Bad value pktio_xdp.attach_mode = %i\n",
+			opt->attach_mode);
+		return -1;
+	}
+
+	if (!lookup_opt("num_desc", pkt_xdp->if_name, &opt->num_desc))
+		return -1;
+	if (opt->num_desc < XDP_MIN_DESC || opt->num_desc > XDP_MAX_DESC ||
+	    !CHECK_IS_POWER2(opt->num_desc)) {
+		ODP_ERR("Bad value pktio_xdp.num_desc = %i\n", opt->num_desc);
+		return -1;
+	}
+
+	ODP_DBG("AF_XDP interface (%s):\n", pkt_xdp->if_name);
+	ODP_DBG("  attach_mode: %d\n", opt->attach_mode);
+	ODP_DBG("  num_desc: %d\n", opt->num_desc);
+
+	return 0;
+}
+
+/* Number of interface queues from ethtool channel configuration */
+static void queue_count_get(pkt_xdp_t *pkt_xdp)
+{
+	struct ethtool_channels channels;
+	struct ifreq ifr;
+	uint32_t num_rx = 1;
+	uint32_t num_tx = 1;
+
+	memset(&channels, 0, sizeof(channels));
+	channels.cmd = ETHTOOL_GCHANNELS;
+	snprintf(ifr.ifr_name, IF_NAMESIZE, "%s", pkt_xdp->if_name);
+	ifr.ifr_data = (void *)&channels;
+
+	if (ioctl(pkt_xdp->sockfd, SIOCETHTOOL, &ifr) == 0) {
+		num_rx = channels.rx_count + channels.combined_count;
+		num_tx = channels.tx_count + channels.combined_count;
+	}
+
+	if (num_rx == 0)
+		num_rx = 1;
+	if (num_tx == 0)
+		num_tx = 1;
+
+	pkt_xdp->num_rx_queues = num_rx;
+	pkt_xdp->num_tx_queues = num_tx;
+}
+
+static int sock_xdp_stats_reset(pktio_entry_t *pktio_entry);
+
+static int sock_xdp_close(pktio_entry_t *pktio_entry)
+{
+	pkt_xdp_t *pkt_xdp = pkt_priv(pktio_entry);
+
+	if (pkt_xdp->sockfd != -1 && close(pkt_xdp->sockfd) != 0) {
+		__odp_errno = errno;
+		ODP_ERR("close(sockfd): %s\n", strerror(errno));
+		return -1;
+	}
+	pkt_xdp->sockfd = -1;
+
+	return 0;
+}
+
+static int sock_xdp_open(odp_pktio_t id ODP_UNUSED, pktio_entry_t *pktio_entry,
+			 const char *devname, odp_pool_t pool_hdl)
+{
+	pkt_xdp_t *pkt_xdp = pkt_priv(pktio_entry);
+	odp_pktio_capability_t *capa = &pktio_entry->s.capa;
+	odp_pktin_hash_proto_t hash_proto;
+	odp_pktio_stats_t cur_stats;
+	pool_t *pool;
+	uint32_t mtu;
+
+	if (disable_pktio)
+		return -1;
+
+	if (pool_hdl == ODP_POOL_INVALID)
+		return -1;
+
+	memset(pkt_xdp, 0, sizeof(pkt_xdp_t));
+	pkt_xdp->sockfd = -1;
+	pkt_xdp->map_fd = -1;
+	pkt_xdp->prog_fd = -1;
+	pkt_xdp->link_fd = -1;
+	pkt_xdp->shm = ODP_SHM_INVALID;
+
+	pkt_xdp->ifindex = if_nametoindex(devname);
+	if (pkt_xdp->ifindex == 0)
+		return -1;
+
+	snprintf(pkt_xdp->if_name, sizeof(pkt_xdp->if_name), "%s", devname);
+
+	if (init_options(pkt_xdp))
+		return -1;
+
+	/* Whole pool memory is registered as UMEM. A chunk starts from packet
+	 * headroom and covers also the first segment. Kernel places frame
+	 * data XDP_PACKET_HEADROOM bytes after the chunk start. */
+	pool = pool_entry_from_hdl(pool_hdl);
+	pkt_xdp->pool = pool;
+	pkt_xdp->umem = pool->base_addr;
+	pkt_xdp->umem_len = ROUNDUP_ALIGN(pool->shm_size, ODP_PAGE_SIZE);
+	pkt_xdp->chunk_size = pool->headroom + pool->seg_len;
+	if (pkt_xdp->chunk_size > ODP_PAGE_SIZE)
+		pkt_xdp->chunk_size = ODP_PAGE_SIZE;
+
+	if (pkt_xdp->chunk_size < XDP_CHUNK_SIZE_MIN ||
+	    pool->headroom > XDP_PACKET_HEADROOM) {
+		ODP_DBG("%s: packet pool not suitable for AF_XDP\n", devname);
+		return -1;
+	}
+
+	pkt_xdp->max_frame_len = pkt_xdp->chunk_size - XDP_PACKET_HEADROOM;
+
+	/* Zero-copy mode requires that a chunk does not cross a page
+	 * boundary, unless pages are physically contiguous. Packet pools
+	 * skip buffers crossing huge page boundaries. */
+	pkt_xdp->copy_mode = !pool->mem_from_huge_pages;
+
+	pkt_xdp->sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (pkt_xdp->sockfd < 0) {
+		__odp_errno = errno;
+		ODP_ERR("Cannot get device control socket\n");
+		goto error;
+	}
+
+	mtu = mtu_get_fd(pkt_xdp->sockfd, pkt_xdp->if_name);
+	if (!mtu)
+		goto error;
+
+	if (mtu > pkt_xdp->max_frame_len) {
+		ODP_DBG("%s: MTU limited by packet pool segment length to %u\n",
+			pkt_xdp->if_name, pkt_xdp->max_frame_len);
+		mtu = pkt_xdp->max_frame_len;
+	}
+	pkt_xdp->mtu = mtu;
+
+	if (mac_addr_get_fd(pkt_xdp->sockfd, pkt_xdp->if_name,
+			    pkt_xdp->if_mac))
+		goto error;
+
+	queue_count_get(pkt_xdp);
+
+	memset(capa, 0, sizeof(odp_pktio_capability_t));
+	capa->max_input_queues = pkt_xdp->num_rx_queues;
+	if (capa->max_input_queues > PKTIO_MAX_QUEUES)
+		capa->max_input_queues = PKTIO_MAX_QUEUES;
+	capa->max_output_queues = pkt_xdp->num_tx_queues;
+	if (capa->max_output_queues > PKTIO_MAX_QUEUES)
+		capa->max_output_queues = PKTIO_MAX_QUEUES;
+
+	/* Check if RSS is supported. If not, set 'max_input_queues' to 1. */
+	if (rss_conf_get_supported_fd(pkt_xdp->sockfd, pkt_xdp->if_name,
+				      &hash_proto) == 0) {
+		ODP_DBG("RSS not supported\n");
+		capa->max_input_queues = 1;
+	}
+
+	capa->set_op.op.promisc_mode = 1;
+
+	odp_pktio_config_init(&capa->config);
+	capa->config.pktin.bit.ts_all = 1;
+	capa->config.pktin.bit.ts_ptp = 1;
+	capa->config.pktout.bit.ts_ena = 1;
+
+	if (ethtool_stats_get_fd(pkt_xdp->sockfd, pkt_xdp->if_name,
+				 &cur_stats)) {
+		ODP_DBG("pktio %s: unsupported stats\n", pkt_xdp->if_name);
+		pktio_entry->s.stats_type = STATS_UNSUPPORTED;
+	} else {
+		pktio_entry->s.stats_type = STATS_ETHTOOL;
+	}
+
+	(void)sock_xdp_stats_reset(pktio_entry);
+
+	return 0;
+
+error:
+	sock_xdp_close(pktio_entry);
+	return -1;
+}
+
+static int ring_map(xdp_ring_t *ring, int fd, const struct xdp_ring_offset *off,
+		    uint32_t num, uint32_t desc_size, uint64_t pgoff)
+{
+	size_t len = off->desc + (size_t)num * desc_size;
+	uint8_t *map;
+
+	map = mmap(NULL, len, PROT_READ | PROT_WRITE,
+		   MAP_SHARED | MAP_POPULATE, fd, pgoff);
+	if (map == MAP_FAILED) {
+		__odp_errno = errno;
+		ODP_ERR("mmap(): %s\n", strerror(errno));
+		return -1;
+	}
+
+	ring->map = map;
+	ring->map_len = len;
+	ring->producer = (uint32_t *)(uintptr_t)(map + off->producer);
+	ring->consumer = (uint32_t *)(uintptr_t)(map + off->consumer);
+	ring->flags = (uint32_t *)(uintptr_t)(map + off->flags);
+	ring->desc = map + off->desc;
+	ring->size = num;
+	ring->mask = num - 1;
+	ring->cached_prod = *ring->producer;
+	ring->cached_cons = *ring->consumer;
+
+	return 0;
+}
+
+static void ring_unmap(xdp_ring_t *ring)
+{
+	if (ring->map && munmap(ring->map, ring->map_len))
+		ODP_ERR("munmap(): %s\n", strerror(errno));
+
+	memset(ring, 0, sizeof(xdp_ring_t));
+}
+
+static int xdp_sock_open(pkt_xdp_t *pkt_xdp, uint32_t idx, int rx, int tx)
+{
+	xdp_sock_t *xsk = &pkt_xdp->sock[idx];
+	struct xdp_mmap_offsets off;
+	struct sockaddr_xdp sxdp;
+	socklen_t optlen = sizeof(off);
+	int num = pkt_xdp->opt.num_desc;
+	odp_time_t tmo;
+	int fd;
+
+	fd = socket(AF_XDP, SOCK_RAW, 0);
+	if (fd < 0) {
+		__odp_errno = errno;
+		ODP_ERR("socket(AF_XDP): %s\n", strerror(errno));
+		return -1;
+	}
+	xsk->fd = fd;
+
+	/* The first socket registers UMEM, others share it */
+	if (idx == 0) {
+		struct xdp_umem_reg reg;
+
+		memset(&reg, 0, sizeof(reg));
+		reg.addr = (uint64_t)(uintptr_t)pkt_xdp->umem;
+		reg.len = pkt_xdp->umem_len;
+		reg.chunk_size = pkt_xdp->chunk_size;
+		reg.headroom = 0;
+		reg.flags = XDP_UMEM_UNALIGNED_CHUNK_FLAG;
+
+		if (setsockopt(fd, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg))) {
+			__odp_errno = errno;
+			ODP_ERR("setsockopt(XDP_UMEM_REG): %s\n",
+				strerror(errno));
+			return -1;
+		}
+	}
+
+	/* Each socket has its own fill and completion rings, also when UMEM
+	 * is shared */
+	if (setsockopt(fd, SOL_XDP, XDP_UMEM_FILL_RING, &num, sizeof(num)) ||
+	    setsockopt(fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &num,
+		       sizeof(num)) ||
+	    (rx && setsockopt(fd, SOL_XDP, XDP_RX_RING, &num, sizeof(num))) ||
+	    (tx && setsockopt(fd, SOL_XDP, XDP_TX_RING, &num, sizeof(num)))) {
+		__odp_errno = errno;
+		ODP_ERR("setsockopt(SOL_XDP): %s\n", strerror(errno));
+		return -1;
+	}
+
+	if (getsockopt(fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen)) {
+		__odp_errno = errno;
+		ODP_ERR("getsockopt(XDP_MMAP_OFFSETS): %s\n", strerror(errno));
+		return -1;
+	}
+
+	if (ring_map(&xsk->fill, fd, &off.fr, num, sizeof(uint64_t),
+		     XDP_UMEM_PGOFF_FILL_RING) ||
+	    ring_map(&xsk->comp, fd, &off.cr, num, sizeof(uint64_t),
+		     XDP_UMEM_PGOFF_COMPLETION_RING))
+		return -1;
+
+	if (rx && ring_map(&xsk->rx, fd, &off.rx, num, sizeof(struct xdp_desc),
+			   XDP_PGOFF_RX_RING))
+		return -1;
+
+	if (tx && ring_map(&xsk->tx, fd, &off.tx, num, sizeof(struct xdp_desc),
+			   XDP_PGOFF_TX_RING))
+		return -1;
+
+	memset(&sxdp, 0, sizeof(sxdp));
+	sxdp.sxdp_family = AF_XDP;
+	sxdp.sxdp_ifindex = pkt_xdp->ifindex;
+	sxdp.sxdp_queue_id = idx;
+
+	/* Sockets sharing UMEM inherit mode flags from the first socket */
+	if (idx == 0) {
+		sxdp.sxdp_flags = XDP_USE_NEED_WAKEUP;
+		if (pkt_xdp->copy_mode)
+			sxdp.sxdp_flags |= XDP_COPY;
+	} else {
+		sxdp.sxdp_flags = XDP_SHARED_UMEM;
+		sxdp.sxdp_shared_umem_fd = pkt_xdp->sock[0].fd;
+	}
+
+	/* Kernel detaches UMEM of a closed socket from the interface queue
+	 * asynchronously. Retry while the queue is still busy after a
+	 * restart. */
+	tmo = odp_time_sum(odp_time_local(),
+			   odp_time_local_from_ns(XDP_BIND_TMO_NS));
+
+	while (bind(fd, (struct sockaddr *)&sxdp, sizeof(sxdp))) {
+		if (errno == EBUSY && odp_time_cmp(odp_time_local(), tmo) < 0) {
+			odp_time_wait_ns(ODP_TIME_MSEC_IN_NS);
+			continue;
+		}
+
+		__odp_errno = errno;
+		ODP_ERR("bind(AF_XDP, %s, queue %u): %s\n", pkt_xdp->if_name,
+			idx, strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Free packets which were left to the kernel */
+static void owned_free(pkt_xdp_t *pkt_xdp, uint64_t *bitmap)
+{
+	odp_packet_t pkt[XDP_BURST];
+	odp_buffer_hdr_t *buf_hdr;
+	uint64_t word;
+	uint32_t i;
+	int num = 0;
+
+	for (i = 0; i < pkt_xdp->bitmap_words; i++) {
+		word = bitmap[i];
+
+		while (word) {
+			int bit = __builtin_ctzll(word);
+
+			word &= word - 1;
+			buf_hdr = buf_hdr_from_index(pkt_xdp->pool,
+						     i * 64 + bit);
+			pkt[num++] = packet_from_buf_hdr(buf_hdr);
+
+			if (num == XDP_BURST) {
+				odp_packet_free_multi(pkt, num);
+				num = 0;
+			}
+		}
+
+		bitmap[i] = 0;
+	}
+
+	if (num)
+		odp_packet_free_multi(pkt, num);
+}
+
+static inline void xdp_reap(pkt_xdp_t *pkt_xdp, xdp_sock_t *xsk)
+{
+	odp_packet_t pkt[XDP_BURST];
+	odp_packet_hdr_t *pkt_hdr;
+	uint64_t *desc = xsk->comp.desc;
+	uint32_t i, num;
+
+	while (xsk->tx_pending) {
+		num = ring_cons_avail(&xsk->comp, XDP_BURST);
+		if (num == 0)
+			break;
+
+		for (i = 0; i < num; i++) {
+			pkt_hdr = umem_pkt_hdr(pkt_xdp,
+					       desc[(xsk->comp.cached_cons + i) &
+						    xsk->comp.mask]);
+			owned_clr(xsk->tx_owned, pkt_idx(pkt_hdr));
+			pkt[i] = packet_handle(pkt_hdr);
+		}
+
+		ring_cons_release(&xsk->comp, num);
+		xsk->tx_pending -= num;
+
+		odp_packet_free_multi(pkt, num);
+	}
+}
+
+static inline void xdp_tx_kick(xdp_sock_t *xsk, uint32_t num)
+{
+	uint32_t retry = (num / XDP_TX_WAKEUP_BATCH) + 1;
+
+	if (!ring_needs_wakeup(&xsk->tx))
+		return;
+
+	/* Retry while kernel runs out of its transmit budget */
+	while (retry--) {
+		if (sendto(xsk->fd, NULL, 0, MSG_DONTWAIT, NULL, 0) >= 0 ||
+		    errno != EAGAIN)
+			break;
+	}
+}
+
+static void xdp_sock_close(pkt_xdp_t *pkt_xdp, xdp_sock_t *xsk)
+{
+	odp_time_t tmo;
+
+	if (xsk->tx.map && xsk->tx_pending) {
+		tmo = odp_time_sum(odp_time_local(),
+				   odp_time_local_from_ns(XDP_TX_DRAIN_TMO_NS));
+
+		while (1) {
+			xdp_reap(pkt_xdp, xsk);
+
+			if (xsk->tx_pending == 0 ||
+			    odp_time_cmp(odp_time_local(), tmo) > 0)
+				break;
+
+			xdp_tx_kick(xsk, xsk->tx_pending);
+		}
+	}
+
+	ring_unmap(&xsk->fill);
+	ring_unmap(&xsk->comp);
+	ring_unmap(&xsk->rx);
+	ring_unmap(&xsk->tx);
+
+	if (xsk->fd != -1 && close(xsk->fd))
+		ODP_ERR("close(AF_XDP): %s\n", strerror(errno));
+	xsk->fd = -1;
+
+	/* Socket has been released, kernel does not access the remaining
+	 * packets anymore */
+	owned_free(pkt_xdp, xsk->rx_owned);
+	owned_free(pkt_xdp, xsk->tx_owned);
+	xsk->tx_pending = 0;
+}
+
+static inline int sys_bpf(enum bpf_cmd cmd, union bpf_attr *attr)
+{
+	return syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+/* Create XSKMAP of RX sockets, load XDP program and attach it to the
+ * interface */
+static int xdp_attach(pkt_xdp_t *pkt_xdp, uint32_t num_rx)
+{
+	union bpf_attr attr;
+	uint32_t key;
+	int fd;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.map_type = BPF_MAP_TYPE_XSKMAP;
+	attr.key_size = sizeof(uint32_t);
+	attr.value_size = sizeof(int);
+	attr.max_entries = pkt_xdp->num_rx_queues;
+
+	pkt_xdp->map_fd = sys_bpf(BPF_MAP_CREATE, &attr);
+	if (pkt_xdp->map_fd < 0) {
+		__odp_errno = errno;
+		ODP_ERR("bpf(BPF_MAP_CREATE): %s\n", strerror(errno));
+		return -1;
+	}
+
+	for (key = 0; key < num_rx; key++) {
+		fd = pkt_xdp->sock[key].fd;
+
+		memset(&attr, 0, sizeof(attr));
+		attr.map_fd = pkt_xdp->map_fd;
+		attr.key = (uint64_t)(uintptr_t)&key;
+		attr.value = (uint64_t)(uintptr_t)&fd;
+		attr.flags = BPF_ANY;
+
+		if (sys_bpf(BPF_MAP_UPDATE_ELEM, &attr)) {
+			__odp_errno = errno;
+			ODP_ERR("bpf(BPF_MAP_UPDATE_ELEM): %s\n",
+				strerror(errno));
+			return -1;
+		}
+	}
+
+	/* return bpf_redirect_map(&xsks, ctx->rx_queue_index, XDP_PASS); */
+	struct bpf_insn prog[] = {
+		{ .code = BPF_LDX | BPF_MEM | BPF_W, .dst_reg = BPF_REG_2,
+		  .src_reg = BPF_REG_1,
+		  .off = offsetof(struct xdp_md, rx_queue_index) },
+		{ .code = BPF_LD | BPF_DW | BPF_IMM, .dst_reg = BPF_REG_1,
+		  .src_reg = BPF_PSEUDO_MAP_FD, .imm = pkt_xdp->map_fd },
+		{ .code = 0 },
+		{ .code = BPF_ALU64 | BPF_MOV | BPF_K, .dst_reg = BPF_REG_3,
+		  .imm = XDP_PASS },
+		{ .code = BPF_JMP | BPF_CALL, .imm = BPF_FUNC_redirect_map },
+		{ .code = BPF_JMP | BPF_EXIT }
+	};
+	const char *license = "Dual BSD/GPL";
+
+	memset(&attr, 0, sizeof(attr));
+	attr.prog_type = BPF_PROG_TYPE_XDP;
+	attr.expected_attach_type = BPF_XDP;
+	attr.insns = (uint64_t)(uintptr_t)prog;
+	attr.insn_cnt = sizeof(prog) / sizeof(prog[0]);
+	attr.license = (uint64_t)(uintptr_t)license;
+
+	pkt_xdp->prog_fd = sys_bpf(BPF_PROG_LOAD, &attr);
+	if (pkt_xdp->prog_fd < 0) {
+		__odp_errno = errno;
+		ODP_ERR("bpf(BPF_PROG_LOAD): %s\n", strerror(errno));
+		return -1;
+	}
+
+	memset(&attr, 0, sizeof(attr));
+	attr.link_create.prog_fd = pkt_xdp->prog_fd;
+	attr.link_create.target_ifindex = pkt_xdp->ifindex;
+	attr.link_create.attach_type = BPF_XDP;
+
+	if (pkt_xdp->opt.attach_mode == XDP_ATTACH_NATIVE) {
+		attr.link_create.flags = XDP_FLAGS_DRV_MODE;
+		pkt_xdp->link_fd = sys_bpf(BPF_LINK_CREATE, &attr);
+		if (pkt_xdp->link_fd >= 0)
+			return 0;
+
+		ODP_DBG("%s: native XDP not supported (%s), using generic "
+			"mode\n", pkt_xdp->if_name, strerror(errno));
+	}
+
+	attr.link_create.flags = XDP_FLAGS_SKB_MODE;
+	pkt_xdp->link_fd = sys_bpf(BPF_LINK_CREATE, &attr);
+	if (pkt_xdp->link_fd < 0) {
+		__odp_errno = errno;
+		ODP_ERR("bpf(BPF_LINK_CREATE, %s): %s\n", pkt_xdp->if_name,
+			strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+static void xdp_detach(pkt_xdp_t *pkt_xdp)
+{
+	/* Closing the link detaches the program from the interface */
+	if (pkt_xdp->link_fd >= 0)
+		close(pkt_xdp->link_fd);
+	if (pkt_xdp->prog_fd >= 0)
+		close(pkt_xdp->prog_fd);
+	if (pkt_xdp->map_fd >= 0)
+		close(pkt_xdp->map_fd);
+
+	pkt_xdp->link_fd = -1;
+	pkt_xdp->prog_fd = -1;
+	pkt_xdp->map_fd = -1;
+}
+
+/* Give free packets to the kernel for packet input */
+static inline void xdp_fill(pkt_xdp_t *pkt_xdp, xdp_sock_t *xsk)
+{
+	odp_packet_t pkt[XDP_BURST];
+	odp_packet_hdr_t *pkt_hdr;
+	uint64_t *desc = xsk->fill.desc;
+	uint32_t headroom;
+	uint32_t num;
+	int i, ret;
+
+	num = ring_prod_free(&xsk->fill, XDP_FILL_THRESHOLD);
+	if (num < XDP_FILL_THRESHOLD)
+		return;
+
+	if (num > XDP_BURST)
+		num = XDP_BURST;
+
+	ret = packet_alloc_multi(pkt_xdp->pool->pool_hdl,
+				 pkt_xdp->max_frame_len, pkt, num);
+	if (odp_unlikely(ret <= 0))
+		return;
+
+	for (i = 0; i < ret; i++) {
+		pkt_hdr = packet_hdr(pkt[i]);
+
+		/* Chunk starts from headroom, or from XDP_PACKET_HEADROOM
+		 * bytes before data when headroom is larger than that */
+		headroom = pkt_hdr->seg_data - pkt_hdr->data;
+		if (headroom > XDP_PACKET_HEADROOM)
+			headroom = XDP_PACKET_HEADROOM;
+
+		desc[(xsk->fill.cached_prod + i) & xsk->fill.mask] =
+			umem_addr(pkt_xdp, pkt_hdr->seg_data - headroom);
+		owned_set(xsk->rx_owned, pkt_idx(pkt_hdr));
+	}
+
+	ring_prod_submit(&xsk->fill, ret);
+}
+
+static int sock_xdp_stop(pktio_entry_t *pktio_entry)
+{
+	pkt_xdp_t *pkt_xdp = pkt_priv(pktio_entry);
+	uint32_t i;
+
+	xdp_detach(pkt_xdp);
+
+	for (i = 0; i < pkt_xdp->num_sock; i++)
+		xdp_sock_close(pkt_xdp, &pkt_xdp->sock[i]);
+
+	pkt_xdp->num_sock = 0;
+	pkt_xdp->sock = NULL;
+
+	if (pkt_xdp->shm != ODP_SHM_INVALID) {
+		if (odp_shm_free(pkt_xdp->shm)) {
+			ODP_ERR("shm free failed\n");
+			return -1;
+		}
+		pkt_xdp->shm = ODP_SHM_INVALID;
+	}
+
+	return 0;
+}
+
+static int sock_xdp_start(pktio_entry_t *pktio_entry)
+{
+	pkt_xdp_t *pkt_xdp = pkt_priv(pktio_entry);
+	pool_t *pool = pkt_xdp->pool;
+	odp_pktin_mode_t in_mode = pktio_entry->s.param.in_mode;
+	odp_pktout_mode_t out_mode = pktio_entry->s.param.out_mode;
+	char name[ODP_SHM_NAME_LEN];
+	uint32_t num_rx, num_tx, num_sock, i, j;
+	uint64_t *bitmap;
+	uint64_t size;
+
+	/* If no pktin/pktout queues have been configured. Configure one
+	 * for each direction. */
+	if (!pktio_entry->s.num_in_queue &&
+	    in_mode != ODP_PKTIN_MODE_DISABLED) {
+		odp_pktin_queue_param_t param;
+
+		odp_pktin_queue_param_init(&param);
+		param.num_queues = 1;
+		if (odp_pktin_queue_config(pktio_entry->s.handle, &param))
+			return -1;
+	}
+	if (!pktio_entry->s.num_out_queue &&
+	    out_mode == ODP_PKTOUT_MODE_DIRECT) {
+		odp_pktout_queue_param_t param;
+
+		odp_pktout_queue_param_init(&param);
+		param.num_queues = 1;
+		if (odp_pktout_queue_config(pktio_entry->s.handle, &param))
+			return -1;
+	}
+
+	num_rx = in_mode == ODP_PKTIN_MODE_DISABLED ? 0 :
+			pktio_entry->s.num_in_queue;
+	num_tx = out_mode == ODP_PKTOUT_MODE_DISABLED ? 0 :
+			pktio_entry->s.num_out_queue;
+	num_sock = num_rx > num_tx ? num_rx : num_tx;
+
+	if (num_sock == 0)
+		return 0;
+
+	/* Socket table is followed by RX and TX bitmaps of each socket */
+	pkt_xdp->bitmap_words = (pool->num + pool->skipped_blocks + 63) / 64;
+	size = num_sock * sizeof(xdp_sock_t) +
+		2 * num_sock * pkt_xdp->bitmap_words * sizeof(uint64_t);
+
+	snprintf(name, sizeof(name), "_odp_pktio_xdp_%" PRIu64,
+		 odp_pktio_to_u64(pktio_entry->s.handle));
+	pkt_xdp->shm = odp_shm_reserve(name, size, ODP_CACHE_LINE_SIZE, 0);
+	if (pkt_xdp->shm == ODP_SHM_INVALID) {
+		ODP_ERR("shm reserve failed\n");
+		return -1;
+	}
+
+	pkt_xdp->sock = odp_shm_addr(pkt_xdp->shm);
+	memset(pkt_xdp->sock, 0, size);
+	bitmap = (uint64_t *)(uintptr_t)&pkt_xdp->sock[num_sock];
+
+	for (i = 0; i < num_sock; i++) {
+		xdp_sock_t *xsk = &pkt_xdp->sock[i];
+
+		odp_ticketlock_init(&xsk->rx_lock);
+		odp_ticketlock_init(&xsk->tx_lock);
+		xsk->fd = -1;
+		xsk->rx_owned = &bitmap[(2 * i) * pkt_xdp->bitmap_words];
+		xsk->tx_owned = &bitmap[(2 * i + 1) * pkt_xdp->bitmap_words];
+	}
+
+	pkt_xdp->num_sock = num_sock;
+
+	for (i = 0; i < num_sock; i++) {
+		if (xdp_sock_open(pkt_xdp, i, i < num_rx, i < num_tx))
+			goto error;
+	}
+
+	for (i = 0; i < num_rx; i++) {
+		for (j = 0; j < pkt_xdp->sock[i].fill.size / XDP_BURST; j++)
+			xdp_fill(pkt_xdp, &pkt_xdp->sock[i]);
+	}
+
+	if (num_rx && xdp_attach(pkt_xdp, num_rx))
+		goto error;
+
+	ODP_DBG("%s: %u AF_XDP sockets in %s mode\n", pkt_xdp->if_name,
+		num_sock, pkt_xdp->copy_mode ? "copy" : "default");
+
+	return 0;
+
+error:
+	sock_xdp_stop(pktio_entry);
+	return -1;
+}
+
+static inline int xdp_recv(pktio_entry_t *pktio_entry, xdp_sock_t *xsk,
+			   odp_packet_t pkt_table[], int num)
+{
+	pkt_xdp_t *pkt_xdp = pkt_priv(pktio_entry);
+	odp_pool_t pool_hdl = pkt_xdp->pool->pool_hdl;
+	struct xdp_desc *desc = xsk->rx.desc;
+	odp_time_t ts_val;
+	odp_time_t *ts = NULL;
+	uint32_t i, n;
+	int nb_rx = 0;
+
+	n = ring_cons_avail(&xsk->rx, num);
+
+	if (n == 0) {
+		if (ring_needs_wakeup(&xsk->fill))
+			recvfrom(xsk->fd, NULL, 0, MSG_DONTWAIT, NULL, NULL);
+
+		xdp_fill(pkt_xdp, xsk);
+		return 0;
+	}
+
+	if (pktio_entry->s.config.pktin.bit.ts_all ||
+	    pktio_entry->s.config.pktin.bit.ts_ptp) {
+		ts_val = odp_time_global();
+		ts = &ts_val;
+	}
+
+	for (i = 0; i < n; i++) {
+		struct xdp_desc *d = &desc[(xsk->rx.cached_cons + i) &
+					   xsk->rx.mask];
+		uint64_t base = d->addr & XSK_UNALIGNED_BUF_ADDR_MASK;
+		uint64_t offset = d->addr >> XSK_UNALIGNED_BUF_OFFSET_SHIFT;
+		uint8_t *data = pkt_xdp->umem + base + offset;
+		uint32_t len = d->len;
+		odp_packet_hdr_t *pkt_hdr = umem_pkt_hdr(pkt_xdp, base);
+		odp_packet_t pkt = packet_handle(pkt_hdr);
+		uint32_t data_offset;
+
+		odp_prefetch(data);
+		owned_clr(xsk->rx_owned, pkt_idx(pkt_hdr));
+
+		/* Frame was written into the packet after
+		 * XDP_PACKET_HEADROOM */
+		data_offset = data - pkt_hdr->seg_data;
+		packet_init(pkt_hdr, data_offset + len);
+		pull_head(pkt_hdr, data_offset);
+
+		if (pktio_cls_enabled(pktio_entry)) {
+			odp_pool_t new_pool;
+
+			if (cls_classify_packet(pktio_entry, data, len, len,
+						&new_pool, pkt_hdr, true)) {
+				odp_packet_free(pkt);
+				continue;
+			}
+
+			if (odp_unlikely(new_pool != pool_hdl)) {
+				odp_packet_t new_pkt;
+
+				new_pkt = odp_packet_copy(pkt, new_pool);
+				odp_packet_free(pkt);
+
+				if (new_pkt == ODP_PACKET_INVALID)
+					continue;
+
+				pkt = new_pkt;
+				pkt_hdr = packet_hdr(new_pkt);
+			}
+		} else {
+			packet_parse_layer(pkt_hdr,
+					   pktio_entry->s.config.parser.layer,
+					   pktio_entry->s.in_chksums);
+		}
+
+		packet_set_ts(pkt_hdr, ts);
+		pkt_hdr->input = pktio_entry->s.handle;
+
+		pkt_table[nb_rx++] = pkt;
+	}
+
+	ring_cons_release(&xsk->rx, n);
+
+	xdp_fill(pkt_xdp, xsk);
+
+	return nb_rx;
+}
+
+static int sock_xdp_recv(pktio_entry_t *pktio_entry, int index,
+			 odp_packet_t pkt_table[], int num)
+{
+	pkt_xdp_t *pkt_xdp = pkt_priv(pktio_entry);
+	xdp_sock_t *xsk = &pkt_xdp->sock[index];
+	int ret;
+
+	if (!pkt_xdp->lockless_rx)
+		odp_ticketlock_lock(&xsk->rx_lock);
+
+	ret = xdp_recv(pktio_entry, xsk, pkt_table, num);
+
+	if (!pkt_xdp->lockless_rx)
+		odp_ticketlock_unlock(&xsk->rx_lock);
+
+	return ret;
+}
+
+static int sock_xdp_fd_set(pktio_entry_t *pktio_entry, int index,
+			   fd_set *readfds)
+{
+	pkt_xdp_t *pkt_xdp = pkt_priv(pktio_entry);
+	int fd;
+
+	if (pktio_entry->s.state != PKTIO_STATE_STARTED)
+		return -1;
+
+	fd = pkt_xdp->sock[index].fd;
+	FD_SET(fd, readfds);
+
+	return fd;
+}
+
+static int sock_xdp_recv_tmo(pktio_entry_t *pktio_entry, int index,
+			     odp_packet_t pkt_table[], int num, uint64_t usecs)
+{
+	struct timeval timeout;
+	int ret;
+	int maxfd;
+	fd_set readfds;
+
+	ret = sock_xdp_recv(pktio_entry, index, pkt_table, num);
+	if (ret != 0)
+		return ret;
+
+	timeout.tv_sec = usecs / (1000 * 1000);
+	timeout.tv_usec = usecs - timeout.tv_sec * (1000ULL * 1000ULL);
+
+	FD_ZERO(&readfds);
+	maxfd = sock_xdp_fd_set(pktio_entry, index, &readfds);
+	if (maxfd < 0)
+		return -1;
+
+	while (1) {
+		ret = select(maxfd + 1, &readfds, NULL, NULL, &timeout);
+
+		if (ret <= 0)
+			return ret;
+
+		ret = sock_xdp_recv(pktio_entry, index, pkt_table, num);
+
+		if (ret)
+			return ret;
+
+		/* If no packets, continue wait until timeout expires */
+	}
+}
+
+static inline int xdp_send(pktio_entry_t *pktio_entry, xdp_sock_t *xsk,
+			   const odp_packet_t pkt_table[], int num)
+{
+	pkt_xdp_t *pkt_xdp = pkt_priv(pktio_entry);
+	struct xdp_desc *desc = xsk->tx.desc;
+	uint8_t tx_ts_enabled = _odp_pktio_tx_ts_enabled(pktio_entry);
+	int tx_ts_idx = 0;
+	uint32_t free;
+	int i;
+
+	xdp_reap(pkt_xdp, xsk);
+
+	free = ring_prod_free(&xsk->tx, num);
+	if ((uint32_t)num > free)
+		num = free;
+
+	for (i = 0; i < num; i++) {
+		odp_packet_t pkt = pkt_table[i];
+		odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
+		uint32_t len = pkt_hdr->frame_len;
+		struct xdp_desc *d;
+
+		if (odp_unlikely(len > pkt_xdp->mtu)) {
+			if (i == 0) {
+				__odp_errno = EMSGSIZE;
+				return -1;
+			}
+			break;
+		}
+
+		if (tx_ts_enabled && tx_ts_idx == 0) {
+			if (odp_unlikely(pkt_hdr->p.flags.ts_set))
+				tx_ts_idx = i + 1;
+		}
+
+		/* Packet data must be in a single segment of UMEM owned only
+		 * by this packet. Otherwise, copy it. */
+		if (odp_unlikely(pkt_hdr->buf_hdr.pool_ptr != pkt_xdp->pool ||
+				 pkt_hdr->seg_count > 1 ||
+				 odp_packet_has_ref(pkt))) {
+			odp_packet_t new_pkt;
+
+			if (packet_alloc_multi(pkt_xdp->pool->pool_hdl, len,
+					       &new_pkt, 1) != 1)
+				break;
+
+			pkt_hdr = packet_hdr(new_pkt);
+			odp_packet_copy_to_mem(pkt, 0, len, pkt_hdr->seg_data);
+			odp_packet_free(pkt);
+		}
+
+		d = &desc[(xsk->tx.cached_prod + i) & xsk->tx.mask];
+		d->addr = umem_addr(pkt_xdp, pkt_hdr->seg_data);
+		d->len = len;
+		d->options = 0;
+		owned_set(xsk->tx_owned, pkt_idx(pkt_hdr));
+	}
+
+	if (odp_unlikely(i == 0))
+		return 0;
+
+	ring_prod_submit(&xsk->tx, i);
+	xsk->tx_pending += i;
+
+	xdp_tx_kick(xsk, i);
+
+	if (odp_unlikely(tx_ts_idx && i >= tx_ts_idx))
+		_odp_pktio_tx_ts_set(pktio_entry);
+
+	return i;
+}
+
+static int sock_xdp_send(pktio_entry_t *pktio_entry, int index,
+			 const odp_packet_t pkt_table[], int num)
+{
+	pkt_xdp_t *pkt_xdp = pkt_priv(pktio_entry);
+	xdp_sock_t *xsk = &pkt_xdp->sock[index];
+	int ret;
+
+	if (!pkt_xdp->lockless_tx)
+		odp_ticketlock_lock(&xsk->tx_lock);
+
+	ret = xdp_send(pktio_entry, xsk, pkt_table, num);
+
+	if (!pkt_xdp->lockless_tx)
+		odp_ticketlock_unlock(&xsk->tx_lock);
+
+	return ret;
+}
+
+static int sock_xdp_input_queues_config(pktio_entry_t *pktio_entry,
+					const odp_pktin_queue_param_t *p)
+{
+	pkt_xdp_t *pkt_xdp = pkt_priv(pktio_entry);
+	odp_pktin_mode_t mode = pktio_entry->s.param.in_mode;
+
+	/* Scheduler synchronizes input queue polls. Only single thread
+	 * at a time polls a queue */
+	if (mode == ODP_PKTIN_MODE_SCHED)
+		pkt_xdp->lockless_rx = 1;
+	else
+		pkt_xdp->lockless_rx = (p->op_mode == ODP_PKTIO_OP_MT_UNSAFE);
+
+	if (p->hash_enable && p->num_queues > 1) {
+		if (rss_conf_set_fd(pkt_xdp->sockfd, pkt_xdp->if_name,
+				    &p->hash_proto)) {
+			ODP_ERR("Failed to configure input hash\n");
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int sock_xdp_output_queues_config(pktio_entry_t *pktio_entry,
+					 const odp_pktout_queue_param_t *p)
+{
+	pkt_priv(pktio_entry)->lockless_tx =
+		(p->op_mode == ODP_PKTIO_OP_MT_UNSAFE);
+
+	return 0;
+}
+
+static uint32_t sock_xdp_mtu_get(pktio_entry_t *pktio_entry)
+{
+	pkt_xdp_t *pkt_xdp = pkt_priv(pktio_entry);
+	uint32_t mtu;
+
+	mtu = mtu_get_fd(pkt_xdp->sockfd, pkt_xdp->if_name);
+	if (mtu > pkt_xdp->max_frame_len)
+		mtu = pkt_xdp->max_frame_len;
+
+	if (mtu)
+		pkt_xdp->mtu = mtu;
+
+	return mtu;
+}
+
+static int sock_xdp_mac_addr_get(pktio_entry_t *pktio_entry, void *mac_addr)
+{
+	memcpy(mac_addr, pkt_priv(pktio_entry)->if_mac, ETH_ALEN);
+	return ETH_ALEN;
+}
+
+static int sock_xdp_promisc_mode_set(pktio_entry_t *pktio_entry,
+				     odp_bool_t enable)
+{
+	return promisc_mode_set_fd(pkt_priv(pktio_entry)->sockfd,
+				   pkt_priv(pktio_entry)->if_name, enable);
+}
+
+static int sock_xdp_promisc_mode_get(pktio_entry_t *pktio_entry)
+{
+	return promisc_mode_get_fd(pkt_priv(pktio_entry)->sockfd,
+				   pkt_priv(pktio_entry)->if_name);
+}
+
+static int sock_xdp_link_status(pktio_entry_t *pktio_entry)
+{
+	return link_status_fd(pkt_priv(pktio_entry)->sockfd,
+			      pkt_priv(pktio_entry)->if_name);
+}
+
+static int sock_xdp_link_info(pktio_entry_t *pktio_entry,
+			      odp_pktio_link_info_t *info)
+{
+	return link_info_fd(pkt_priv(pktio_entry)->sockfd,
+			    pkt_priv(pktio_entry)->if_name, info);
+}
+
+static int sock_xdp_capability(pktio_entry_t *pktio_entry,
+			       odp_pktio_capability_t *capa)
+{
+	*capa = pktio_entry->s.capa;
+	return 0;
+}
+
+static int sock_xdp_stats(pktio_entry_t *pktio_entry,
+			  odp_pktio_stats_t *stats)
+{
+	if (pktio_entry->s.stats_type == STATS_UNSUPPORTED) {
+		memset(stats, 0, sizeof(*stats));
+		return 0;
+	}
+
+	return sock_stats_fd(pktio_entry, stats, pkt_priv(pktio_entry)->sockfd);
+}
+
+static int sock_xdp_stats_reset(pktio_entry_t *pktio_entry)
+{
+	if (pktio_entry->s.stats_type == STATS_UNSUPPORTED) {
+		memset(&pktio_entry->s.stats, 0, sizeof(odp_pktio_stats_t));
+		return 0;
+	}
+
+	return sock_stats_reset_fd(pktio_entry, pkt_priv(pktio_entry)->sockfd);
+}
+
+static void sock_xdp_print(pktio_entry_t *pktio_entry)
+{
+	pkt_xdp_t *pkt_xdp = pkt_priv(pktio_entry);
+
+	ODP_PRINT("  attach mode       %s\n",
+		  pkt_xdp->opt.attach_mode == XDP_ATTACH_NATIVE ?
+		  "native" : "generic");
+	ODP_PRINT("  copy mode         %s\n",
+		  pkt_xdp->copy_mode ? "forced" : "kernel selected");
+	ODP_PRINT("  descriptors       %i\n", pkt_xdp->opt.num_desc);
+	ODP_PRINT("  umem chunk size   %u\n", pkt_xdp->chunk_size);
+	ODP_PRINT("  max frame len     %u\n", pkt_xdp->max_frame_len);
+	ODP_PRINT("  sockets           %u\n", pkt_xdp->num_sock);
+}
+
+static int sock_xdp_init_global(void)
+{
+	if (getenv("ODP_PKTIO_DISABLE_SOCKET_XDP")) {
+		ODP_PRINT("PKTIO: socket xdp skipped,"
+			  " enabled export ODP_PKTIO_DISABLE_SOCKET_XDP=1.\n");
+		disable_pktio = 1;
+	} else {
+		ODP_PRINT("PKTIO: initialized socket xdp,"
+			  " use export ODP_PKTIO_DISABLE_SOCKET_XDP=1 to disable.\n");
+	}
+	return 0;
+}
+
+const pktio_if_ops_t sock_xdp_pktio_ops = {
+	.name = "socket_xdp",
+	.print = sock_xdp_print,
+	.init_global = sock_xdp_init_global,
+	.init_local = NULL,
+	.term = NULL,
+	.open = sock_xdp_open,
+	.close = sock_xdp_close,
+	.start = sock_xdp_start,
+	.stop = sock_xdp_stop,
+	.stats = sock_xdp_stats,
+	.stats_reset = sock_xdp_stats_reset,
+	.recv = sock_xdp_recv,
+	.recv_tmo = sock_xdp_recv_tmo,
+	.recv_mq_tmo = NULL,
+	.send = sock_xdp_send,
+	.fd_set = sock_xdp_fd_set,
+	.mtu_get = sock_xdp_mtu_get,
+	.promisc_mode_set = sock_xdp_promisc_mode_set,
+	.promisc_mode_get = sock_xdp_promisc_mode_get,
+	.mac_get = sock_xdp_mac_addr_get,
+	.mac_set = NULL,
+	.link_status = sock_xdp_link_status,
+	.link_info = sock_xdp_link_info,
+	.capability = sock_xdp_capability,
+	.pktio_ts_res = NULL,
+	.pktio_ts_from_ns = NULL,
+	.pktio_time = NULL,
+	.config = NULL,
+	.input_queues_config = sock_xdp_input_queues_config,
+	.output_queues_config = sock_xdp_output_queues_config,
+};
+
+#endif /* _ODP_PKTIO_XDP */
@@ -58,7 +58,7 @@ run_test()
 
 	# environment variables are used to control which socket method is
 	# used, so try each combination to ensure decent coverage.
-	for distype in MMAP MMSG; do
+	for distype in MMAP MMSG XDP URING; do
 		unset ODP_PKTIO_DISABLE_SOCKET_${distype}
 	done
 
@@ -28,6 +28,17 @@
  */
 #define POOL_NUM_PKT  64
 
+/** @def POOL_NUM_PKT_THROUGHPUT
+ * Number of packets in the pool in async throughput mode
+ */
+#define POOL_NUM_PKT_THROUGHPUT  4096
+
+/** @def MAX_BURST
+ * Maximum number of operations submitted or completed at once in async
+ * throughput mode
+ */
+#define MAX_BURST  32
+
 static uint8_t test_iv[16] = "0123456789abcdef";
 
 static uint8_t test_key16[16] = { 0x01, 0x02, 0x03, 0x04, 0x05,
@@ -121,7 +132,9 @@ typedef struct {
 	int iteration_count;
 
 	/**
-	 * Maximum sessions. Currently is not used.
+	 * Number of sessions in session test. When non-zero, session create
+	 * and destroy rate, and operation cost with many active sessions are
+	 * measured. Specified through -m or --sessions option.
 	 */
 	int max_sessions;
 
@@ -149,6 +162,13 @@ typedef struct {
 	 * Specified through -p argument.
 	 */
 	int poll;
+
+	/*
+	 * Async throughput mode. Operations are submitted and completion
+	 * events received in bursts, while keeping up to in_flight operations
+	 * outstanding. Specified through -t argument.
+	 */
+	int throughput;
 } crypto_args_t;
 
 /*
@@ -862,6 +882,142 @@ run_measure_one(crypto_args_t *cargs,
 	return rc < 0 ? rc : 0;
 }
 
+/**
+ * Run measurement iterations in async throughput mode. Result of run returned
+ * in 'result' out parameter.
+ */
+static int
+run_measure_one_burst(crypto_args_t *cargs,
+		      odp_crypto_session_t *session,
+		      unsigned int payload_length,
+		      crypto_run_result_t *result)
+{
+	odp_crypto_packet_op_param_t params[MAX_BURST];
+	odp_packet_t pkt[MAX_BURST];
+	odp_packet_t out_pkt[MAX_BURST];
+	odp_event_t ev[MAX_BURST];
+	odp_crypto_packet_result_t op_result;
+	odp_pool_t pkt_pool;
+	odp_queue_t out_queue;
+	time_record_t start, end;
+	int packets_sent = 0;
+	int packets_received = 0;
+	int i, num;
+	int rc = 0;
+
+	pkt_pool = odp_pool_lookup("packet_pool");
+	if (pkt_pool == ODP_POOL_INVALID) {
+		app_err("pkt_pool not found\n");
+		return -1;
+	}
+
+	out_queue = odp_queue_lookup("crypto-out");
+	if (out_queue == ODP_QUEUE_INVALID) {
+		app_err("crypto-out queue not found\n");
+		return -1;
+	}
+
+	/* Initialize parameters blocks */
+	memset(params, 0, sizeof(params));
+	for (i = 0; i < MAX_BURST; i++) {
+		params[i].session = *session;
+		params[i].cipher_range.offset = 0;
+		params[i].cipher_range.length = payload_length;
+		params[i].auth_range.offset = 0;
+		params[i].auth_range.length = payload_length;
+		params[i].hash_result_offset = payload_length;
+	}
+
+	fill_time_record(&start);
+
+	while (packets_received < cargs->iteration_count) {
+		num = cargs->in_flight - (packets_sent - packets_received);
+		if (num > cargs->iteration_count - packets_sent)
+			num = cargs->iteration_count - packets_sent;
+		if (num > MAX_BURST)
+			num = MAX_BURST;
+
+		for (i = 0; i < num; i++) {
+			pkt[i] = make_packet(pkt_pool, payload_length);
+			if (ODP_PACKET_INVALID == pkt[i])
+				break;
+
+			out_pkt[i] = cargs->in_place ? pkt[i] :
+						       ODP_PACKET_INVALID;
+		}
+
+		/* Pool may run out of packets while completions are
+		 * outstanding */
+		num = i;
+
+		if (num > 0) {
+			rc = odp_crypto_op_enq(pkt, out_pkt, params, num);
+			if (rc < 0) {
+				app_err("failed odp_crypto_op_enq: rc = %d\n",
+					rc);
+				odp_packet_free_multi(pkt, num);
+				break;
+			}
+
+			/* Free packets the implementation did not consume */
+			if (rc < num)
+				odp_packet_free_multi(&pkt[rc], num - rc);
+
+			packets_sent += rc;
+		}
+
+		if (cargs->schedule)
+			num = odp_schedule_multi_no_wait(NULL, ev, MAX_BURST);
+		else
+			num = odp_queue_deq_multi(out_queue, ev, MAX_BURST);
+
+		for (i = 0; i < num; i++) {
+			pkt[i] = odp_crypto_packet_from_event(ev[i]);
+			odp_crypto_result(&op_result, pkt[i]);
+		}
+
+		if (num > 0) {
+			odp_packet_free_multi(pkt, num);
+			packets_received += num;
+		}
+	}
+
+	fill_time_record(&end);
+
+	{
+		double count;
+
+		count = get_elapsed_usec(&start, &end);
+		result->elapsed = count /
+				  cargs->iteration_count;
+
+		count = get_rusage_self_diff(&start, &end);
+		result->rusage_self = count /
+				      cargs->iteration_count;
+
+		count = get_rusage_thread_diff(&start, &end);
+		result->rusage_thread = count /
+					cargs->iteration_count;
+	}
+
+	return rc < 0 ? rc : 0;
+}
+
+static int
+run_measure(crypto_args_t *cargs,
+	    crypto_alg_config_t *config,
+	    odp_crypto_session_t *session,
+	    unsigned int payload_length,
+	    crypto_run_result_t *result)
+{
+	if (cargs->throughput)
+		return run_measure_one_burst(cargs, session, payload_length,
+					     result);
+
+	return run_measure_one(cargs, config, session, payload_length,
+			       result);
+}
+
 static int check_cipher_alg(odp_crypto_capability_t *capa,
 			    odp_cipher_alg_t alg)
 {
@@ -956,6 +1112,121 @@ static int check_auth_alg(odp_crypto_capability_t *capa,
 	return -1;
 }
 
+/**
+ * Measure session create and destroy rate, and synchronous operation cost
+ * when operations are spread over many active sessions.
+ */
+static int run_session_test(crypto_args_t *cargs,
+			    crypto_alg_config_t *config,
+			    odp_crypto_capability_t *capa)
+{
+	odp_crypto_packet_op_param_t params;
+	odp_crypto_session_t *session;
+	odp_packet_t pkt, out_pkt;
+	odp_pool_t pkt_pool;
+	odp_time_t t1, t2;
+	uint64_t nsec;
+	unsigned int payload_length;
+	int num, num_active, i, rc = 0;
+
+	num = cargs->max_sessions;
+	if ((uint32_t)num > capa->max_sessions) {
+		printf("    Max sessions limited to %u\n", capa->max_sessions);
+		num = capa->max_sessions;
+	}
+
+	payload_length = cargs->payload_length ? cargs->payload_length : 64;
+
+	pkt_pool = odp_pool_lookup("packet_pool");
+	if (pkt_pool == ODP_POOL_INVALID) {
+		app_err("pkt_pool not found\n");
+		return -1;
+	}
+
+	session = malloc(num * sizeof(odp_crypto_session_t));
+	if (session == NULL) {
+		app_err("session table alloc failed\n");
+		return -1;
+	}
+
+	pkt = make_packet(pkt_pool, payload_length);
+	if (pkt == ODP_PACKET_INVALID) {
+		free(session);
+		return -1;
+	}
+
+	printf("\nSession test: %s, %i sessions, payload %u bytes\n",
+	       config->name, num, payload_length);
+
+	t1 = odp_time_local();
+	for (i = 0; i < num; i++) {
+		if (create_session_from_config(&session[i], config, cargs))
+			break;
+	}
+	t2 = odp_time_local();
+
+	num_active = i;
+	if (num_active == 0) {
+		rc = -1;
+		goto free_pkt;
+	}
+
+	nsec = odp_time_diff_ns(t2, t1);
+	printf("  create:  %10.3f us per session\n",
+	       (double)nsec / num_active / 1000);
+
+	memset(&params, 0, sizeof(params));
+	params.cipher_range.offset = 0;
+	params.cipher_range.length = payload_length;
+	params.auth_range.offset = 0;
+	params.auth_range.length = payload_length;
+	params.hash_result_offset = payload_length;
+
+	/* Operations are spread round robin over 1, 10, 100, ... sessions */
+	printf("  %10s %15s\n", "sessions", "op (us)");
+	num = 1;
+	while (1) {
+		t1 = odp_time_local();
+		for (i = 0; i < cargs->iteration_count; i++) {
+			params.session = session[i % num];
+			out_pkt = pkt;
+
+			if (odp_crypto_op(&pkt, &out_pkt, &params, 1) != 1) {
+				app_err("failed odp_crypto_op\n");
+				rc = -1;
+				break;
+			}
+		}
+		t2 = odp_time_local();
+
+		if (rc)
+			break;
+
+		nsec = odp_time_diff_ns(t2, t1);
+		printf("  %10i %15.3f\n", num,
+		       (double)nsec / cargs->iteration_count / 1000);
+
+		if (num == num_active)
+			break;
+
+		num = num * 10 < num_active ? num * 10 : num_active;
+	}
+
+	t1 = odp_time_local();
+	for (i = 0; i < num_active; i++)
+		odp_crypto_session_destroy(session[i]);
+	t2 = odp_time_local();
+
+	nsec = odp_time_diff_ns(t2, t1);
+	printf("  destroy: %10.3f us per session\n\n",
+	       (double)nsec / num_active / 1000);
+
+free_pkt:
+	odp_packet_free(pkt);
+	free(session);
+	return rc;
+}
+
 /**
  * Process one algorithm. Note if paload size is specicified it is
  * only one run. Or iterate over set of predefined payloads.
@@ -984,12 +1255,15 @@ static int run_measure_one_config(test_run_arg_t *arg)
 		return 0;
 	}
 
+	if (cargs->max_sessions)
+		return run_session_test(cargs, config, &crypto_capa);
+
 	if (create_session_from_config(&session, config, cargs))
 		return -1;
 
 	if (cargs->payload_length) {
-		rc = run_measure_one(cargs, config, &session,
-				     cargs->payload_length, &result);
+		rc = run_measure(cargs, config, &session,
+				 cargs->payload_length, &result);
 		if (!rc) {
 			print_result_header();
 			print_result(cargs, cargs->payload_length,
@@ -1000,8 +1274,8 @@ static int run_measure_one_config(test_run_arg_t *arg)
 
 		print_result_header();
 		for (i = 0; i < num_payloads; i++) {
-			rc = run_measure_one(cargs, config, &session,
-					     payloads[i], &result);
+			rc = run_measure(cargs, config, &session,
+					 payloads[i], &result);
 			if (rc)
 				break;
 			print_result(cargs, payloads[i],
@@ -1089,7 +1363,10 @@ int main(int argc, char *argv[])
 	odp_pool_param_init(&params);
 	params.pkt.seg_len = max_seg_len;
 	params.pkt.len	   = max_seg_len;
-	params.pkt.num	   = POOL_NUM_PKT;
+	params.pkt.num	   = cargs.throughput ? POOL_NUM_PKT_THROUGHPUT :
+						    POOL_NUM_PKT;
+	if (pool_capa.pkt.max_num && params.pkt.num > pool_capa.pkt.max_num)
+		params.pkt.num = pool_capa.pkt.max_num;
 	params.type	   = ODP_POOL_PACKET;
 	pool = odp_pool_create("packet_pool", &params);
 
@@ -1136,6 +1413,10 @@ int main(int argc, char *argv[])
 		printf("Run in sync mode\n");
 	}
 
+	if (cargs.throughput)
+		printf("Async throughput mode, max %i operations in flight\n",
+		       cargs.in_flight);
+
 	memset(thr, 0, sizeof(thr));
 
 	test_run_arg.crypto_args       = cargs;
@@ -1204,10 +1485,11 @@ static void parse_args(int argc, char *argv[], crypto_args_t *cargs)
 		{"reuse", no_argument, NULL, 'r'},
 		{"poll", no_argument, NULL, 'p'},
 		{"schedule", no_argument, NULL, 's'},
+		{"throughput", no_argument, NULL, 't'},
 		{NULL, 0, NULL, 0}
 	};
 
-	static const char *shortopts = "+a:c:df:hi:m:nl:spr";
+	static const char *shortopts = "+a:c:df:hi:m:nl:sprt";
 
 	cargs->in_place = 0;
 	cargs->in_flight = 1;
@@ -1217,6 +1499,7 @@ static void parse_args(int argc, char *argv[], crypto_args_t *cargs)
 	cargs->alg_config = NULL;
 	cargs->reuse_packet = 0;
 	cargs->schedule = 0;
+	cargs->throughput = 0;
 
 	while (1) {
 		opt = getopt_long(argc, argv, shortopts, longopts, &long_index);
@@ -1265,6 +1548,9 @@ static void parse_args(int argc, char *argv[], crypto_args_t *cargs)
 		case 'p':
 			cargs->poll = 1;
 			break;
+		case 't':
+			cargs->throughput = 1;
+			break;
 		default:
 			break;
 		}
@@ -1282,6 +1568,21 @@ static void parse_args(int argc, char *argv[], crypto_args_t *cargs)
 		usage(argv[0]);
 		exit(-1);
 	}
+	if (cargs->throughput && !(cargs->schedule || cargs->poll)) {
+		printf("-t (throughput) option requires -s (schedule) or -p (poll) option\n");
+		usage(argv[0]);
+		exit(-1);
+	}
+	if (cargs->max_sessions && (cargs->schedule || cargs->poll)) {
+		printf("-m (sessions) option is not compatible with -s (schedule) and -p (poll) options\n");
+		usage(argv[0]);
+		exit(-1);
+	}
+	if (cargs->throughput && cargs->reuse_packet) {
+		printf("-t (throughput) and -r (reuse packet) options are not compatible\n");
+		usage(argv[0]);
+		exit(-1);
+	}
 }
 
 /**
@@ -1305,10 +1606,16 @@ static void usage(char *progname)
 	       "  -i, --iterations <number> Number of iterations.\n"
 	       "  -n, --inplace	       Encrypt on place.\n"
 	       "  -l, --payload	       Payload length.\n"
+	       "  -m, --sessions <number> Session test. Measure session create and\n"
+	       "                       destroy rate, and operation cost when operations\n"
+	       "                       are spread over 1, 10, 100, ... <number> sessions.\n"
 	       "  -r, --reuse	       Output encrypted packet is passed as input\n"
 	       "		       to next encrypt iteration.\n"
 	       "  -s, --schedule       Use scheduler for completion events.\n"
 	       "  -p, --poll           Poll completion queue for completion events.\n"
+	       "  -t, --throughput     Async throughput mode. Submit operations and receive\n"
+	       "                       completion events in bursts, while keeping up to\n"
+	       "                       -f operations in flight. Use with -s or -p.\n"
 	       "  -h, --help	       Display help and exit.\n"
 	       "\n");
 }
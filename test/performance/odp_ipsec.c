@@ -143,6 +143,12 @@ typedef struct {
 	 * Specified through -u argument.
 	 */
 	int ah;
+
+	/*
+	 * Measure inbound SA lookup cost with up to this many SAs instead of
+	 * running algorithm tests. Specified through -r argument.
+	 */
+	unsigned int lookup_num_sa;
 } ipsec_args_t;
 
 /*
@@ -860,6 +866,193 @@ run_measure_one_config(ipsec_args_t *cargs,
 	return rc;
 }
 
+/** IPv4 + ESP header + ESP payload and trailer of SA lookup test packets */
+#define LOOKUP_PKT_LEN (20 + 8 + 16)
+
+/** First SPI of SA lookup test SAs */
+#define LOOKUP_SPI_BASE 0x1000
+
+static uint32_t lookup_dst_addr(uint32_t idx)
+{
+	return IPV4ADDR(10, (idx >> 16) & 0xff, (idx >> 8) & 0xff, idx & 0xff);
+}
+
+/**
+ * Create an inbound SA that is found with (SPI, destination address) lookup.
+ */
+static odp_ipsec_sa_t
+create_lookup_sa(uint32_t idx)
+{
+	odp_ipsec_sa_param_t param;
+	uint32_t dst = lookup_dst_addr(idx);
+
+	odp_ipsec_sa_param_init(&param);
+	param.proto = ODP_IPSEC_ESP;
+	param.dir = ODP_IPSEC_DIR_INBOUND;
+	param.mode = ODP_IPSEC_MODE_TRANSPORT;
+	param.spi = LOOKUP_SPI_BASE + idx;
+	param.crypto.cipher_alg = ODP_CIPHER_ALG_NULL;
+	param.crypto.auth_alg = ODP_AUTH_ALG_NULL;
+	param.inbound.lookup_mode = ODP_IPSEC_LOOKUP_DSTADDR_SPI;
+	param.inbound.lookup_param.ip_version = ODP_IPSEC_IPV4;
+	param.inbound.lookup_param.dst_addr = &dst;
+
+	return odp_ipsec_sa_create(&param);
+}
+
+/**
+ * Make ESP transport mode packet that matches SA lookup test SA 'idx'.
+ */
+static odp_packet_t
+make_lookup_packet(odp_pool_t pkt_pool, uint32_t idx)
+{
+	odp_packet_t pkt;
+	uint8_t *mem;
+	odph_ipv4hdr_t *ip;
+	odph_esphdr_t *esp;
+
+	pkt = odp_packet_alloc(pkt_pool, LOOKUP_PKT_LEN);
+	if (pkt == ODP_PACKET_INVALID) {
+		app_err("failed to allocate buffer\n");
+		return pkt;
+	}
+
+	mem = odp_packet_data(pkt);
+	memset(mem, 0, LOOKUP_PKT_LEN);
+
+	ip = (odph_ipv4hdr_t *)mem;
+	ip->ver_ihl = (ODPH_IPV4 << 4) | ODPH_IPV4HDR_IHL_MIN;
+	ip->tot_len = odp_cpu_to_be_16(LOOKUP_PKT_LEN);
+	ip->ttl = 64;
+	ip->proto = ODPH_IPPROTO_ESP;
+	ip->src_addr = IPV4ADDR(10, 255, 0, 1);
+	ip->dst_addr = lookup_dst_addr(idx);
+	odph_ipv4_csum_update(pkt);
+
+	esp = (odph_esphdr_t *)(mem + ODPH_IPV4HDR_LEN);
+	esp->spi = odp_cpu_to_be_32(LOOKUP_SPI_BASE + idx);
+	esp->seq_no = odp_cpu_to_be_32(1);
+
+	/* ESP trailer: no padding, next header is ICMP */
+	mem[LOOKUP_PKT_LEN - 1] = ODPH_IPPROTO_ICMPV4;
+
+	odp_packet_l3_offset_set(pkt, 0);
+
+	return pkt;
+}
+
+/**
+ * Measure inbound processing time with SA lookup as the number of SAs
+ * grows. Packets are spread over all SAs of the round.
+ */
+static int
+run_lookup_test(ipsec_args_t *cargs)
+{
+	odp_ipsec_in_param_t param;
+	odp_pool_t pkt_pool;
+	odp_ipsec_sa_t *sa;
+	uint32_t num_sa = 0;
+	uint32_t round_sa, i;
+	int rc = 0;
+
+	pkt_pool = odp_pool_lookup("packet_pool");
+	if (pkt_pool == ODP_POOL_INVALID) {
+		app_err("pkt_pool not found\n");
+		return -1;
+	}
+
+	sa = malloc(cargs->lookup_num_sa * sizeof(odp_ipsec_sa_t));
+	if (sa == NULL) {
+		app_err("SA table alloc failed\n");
+		return -1;
+	}
+
+	/* SAs are found with lookup */
+	memset(&param, 0, sizeof(param));
+	param.num_sa = 0;
+	param.sa = NULL;
+
+	printf("\n%15s %15s %15s %15s\n", "num SA", "packets",
+	       "lookup errors", "avg in (ns)");
+
+	round_sa = 1;
+
+	while (1) {
+		uint64_t nsec = 0;
+		uint32_t lookup_err = 0;
+
+		if (round_sa > cargs->lookup_num_sa)
+			round_sa = cargs->lookup_num_sa;
+
+		while (num_sa < round_sa) {
+			sa[num_sa] = create_lookup_sa(num_sa);
+			if (sa[num_sa] == ODP_IPSEC_SA_INVALID)
+				break;
+			num_sa++;
+		}
+
+		if (num_sa < round_sa) {
+			printf("SA create failed after %u SAs\n", num_sa);
+			break;
+		}
+
+		for (i = 0; i < (uint32_t)cargs->iteration_count; i++) {
+			odp_packet_t pkt, out_pkt;
+			odp_ipsec_packet_result_t result;
+			odp_time_t t1, t2;
+			int num_out = 1;
+			/* Spread packets over SAs in non-sequential order */
+			uint32_t idx = (uint32_t)(((uint64_t)i * 7919) %
+						  num_sa);
+
+			pkt = make_lookup_packet(pkt_pool, idx);
+			if (pkt == ODP_PACKET_INVALID) {
+				rc = -1;
+				goto destroy;
+			}
+
+			t1 = odp_time_local();
+			rc = odp_ipsec_in(&pkt, 1, &out_pkt, &num_out, &param);
+			t2 = odp_time_local();
+
+			if (rc <= 0) {
+				app_err("failed odp_ipsec_in: rc = %d\n", rc);
+				odp_packet_free(pkt);
+				rc = -1;
+				goto destroy;
+			}
+			rc = 0;
+
+			nsec += odp_time_diff_ns(t2, t1);
+
+			odp_ipsec_result(&result, out_pkt);
+			if (result.status.error.sa_lookup)
+				lookup_err++;
+
+			odp_packet_free(out_pkt);
+		}
+
+		printf("%15u %15d %15u %15.1f\n", num_sa,
+		       cargs->iteration_count, lookup_err,
+		       (double)nsec / cargs->iteration_count);
+
+		if (round_sa == cargs->lookup_num_sa)
+			break;
+
+		round_sa *= 10;
+	}
+
+destroy:
+	for (i = 0; i < num_sa; i++) {
+		odp_ipsec_sa_disable(sa[i]);
+		odp_ipsec_sa_destroy(sa[i]);
+	}
+
+	free(sa);
+
+	return rc;
+}
+
 typedef struct thr_arg {
 	ipsec_args_t ipsec_args;
 	ipsec_alg_config_t *ipsec_alg_config;
@@ -898,6 +1091,8 @@ static void usage(char *progname)
 	       "  -p, --poll           Poll completion queue for completion events.\n"
 	       "  -t, --tunnel         Use tunnel-mode IPsec transformation.\n"
 	       "  -u, --ah             Use AH transformation instead of ESP.\n"
+	       "  -r, --lookup <number> Measure inbound SA lookup cost with\n"
+	       "                       1, 10, 100, ... up to <number> SAs.\n"
 	       "  -h, --help	       Display help and exit.\n"
 	       "\n");
 }
@@ -918,10 +1113,11 @@ static void parse_args(int argc, char *argv[], ipsec_args_t *cargs)
 		{"schedule", no_argument, NULL, 's'},
 		{"tunnel", no_argument, NULL, 't'},
 		{"ah", no_argument, NULL, 'u'},
+		{"lookup", required_argument, NULL, 'r'},
 		{NULL, 0, NULL, 0}
 	};
 
-	static const char *shortopts = "+a:c:df:hi:m:nl:sptu";
+	static const char *shortopts = "+a:c:df:hi:m:nl:r:sptu";
 
 	cargs->in_flight = 1;
 	cargs->debug_packets = 0;
@@ -975,6 +1171,9 @@ static void parse_args(int argc, char *argv[], ipsec_args_t *cargs)
 		case 'u':
 			cargs->ah = 1;
 			break;
+		case 'r':
+			cargs->lookup_num_sa = atoi(optarg);
+			break;
 		default:
 			break;
 		}
@@ -987,6 +1186,12 @@ static void parse_args(int argc, char *argv[], ipsec_args_t *cargs)
 		usage(argv[0]);
 		exit(-1);
 	}
+
+	if (cargs->lookup_num_sa && (cargs->schedule || cargs->poll)) {
+		printf("-r (lookup) test runs only in sync mode\n");
+		usage(argv[0]);
+		exit(-1);
+	}
 }
 
 int main(int argc, char *argv[])
@@ -1005,6 +1210,7 @@ int main(int argc, char *argv[])
 	odp_instance_t instance;
 	odp_init_t init_param;
 	odp_pool_capability_t capa;
+	odp_ipsec_capability_t ipsec_capa;
 	odp_ipsec_config_t config;
 	uint32_t max_seg_len;
 	unsigned int i;
@@ -1066,8 +1272,19 @@ int main(int argc, char *argv[])
 	}
 	odp_pool_print(pool);
 
+	if (odp_ipsec_capability(&ipsec_capa)) {
+		app_err("IPsec capability request failed.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if (cargs.lookup_num_sa > ipsec_capa.max_num_sa) {
+		printf("Max number of SAs limited to %u\n",
+		       ipsec_capa.max_num_sa);
+		cargs.lookup_num_sa = ipsec_capa.max_num_sa;
+	}
+
 	odp_ipsec_config_init(&config);
-	config.max_num_sa = 2;
+	config.max_num_sa = cargs.lookup_num_sa ? cargs.lookup_num_sa : 2;
 	config.inbound.chksums.all_chksum = 0;
 	config.outbound.all_chksum = 0;
 
@@ -1124,7 +1341,10 @@ int main(int argc, char *argv[])
 
 	memset(thr, 0, sizeof(thr));
 
-	if (cargs.alg_config) {
+	if (cargs.lookup_num_sa) {
+		if (run_lookup_test(&cargs))
+			app_err("SA lookup test failed\n");
+	} else if (cargs.alg_config) {
 		odph_odpthread_params_t thr_param;
 
 		memset(&thr_param, 0, sizeof(thr_param));
@@ -38,6 +38,8 @@
 #define TEST_HDR_MAGIC    0x92749451
 #define MAX_WORKERS       (ODP_THREAD_COUNT_MAX - 1)
 #define BATCH_LEN_MAX     32
+#define MAX_QUEUES        32
+#define NUM_FLOWS         256 /* UDP flows with multiple input queues */
 
 /* Packet rate at which to start when using binary search */
 #define RATE_SEARCH_INITIAL_PPS 1000000
@@ -77,6 +79,8 @@ typedef struct {
 				   0: receive packets via direct deq */
 	uint32_t rx_batch_len;	/* Number of packets to receive in a single
 				   batch */
+	uint32_t num_rx_queues;	/* Number of input queues on the receive
+				   interface */
 	uint64_t pps;		/* Attempted packet rate */
 	int      verbose;	/* Print verbose information, such as per
 				   thread statistics */
@@ -132,6 +136,8 @@ typedef struct {
 	uint32_t tx_stats_size;
 	/* Indicate to the receivers to shutdown */
 	odp_atomic_u32_t shutdown;
+	/* Input queue index of the next receive thread */
+	odp_atomic_u32_t rx_queue_idx;
 	/* Sequence number of IP packets */
 	odp_atomic_u32_t ip_seq ODP_ALIGNED_CACHE;
 } test_globals_t;
@@ -210,7 +216,11 @@ static odp_packet_t pktio_create_packet(uint32_t seq)
 	offset += ODPH_IPV4HDR_LEN;
 	odp_packet_l4_offset_set(pkt, offset);
 	udp = (odph_udphdr_t *)(buf + offset);
-	udp->src_port = odp_cpu_to_be_16(0);
+	/* Spread packets to multiple flows for input hashing */
+	if (gbl_args->args.num_rx_queues > 1)
+		udp->src_port = odp_cpu_to_be_16(seq % NUM_FLOWS);
+	else
+		udp->src_port = odp_cpu_to_be_16(0);
 	udp->dst_port = odp_cpu_to_be_16(0);
 	udp->length = odp_cpu_to_be_16(payload_len + ODPH_UDPHDR_LEN);
 	udp->chksum = 0;
@@ -427,8 +437,16 @@ static int run_thread_rx(void *arg)
 	pkt_rx_stats_t *stats = &globals->rx_stats[thr_id];
 
 	if (gbl_args->args.schedule == 0) {
-		if (odp_pktin_event_queue(globals->pktio_rx, &queue, 1) != 1)
+		odp_queue_t inq[MAX_QUEUES];
+		uint32_t idx = odp_atomic_fetch_inc_u32(&globals->rx_queue_idx);
+		int num = odp_pktin_event_queue(globals->pktio_rx, inq,
+						MAX_QUEUES);
+
+		if (num < 1)
 			ODPH_ABORT("No input queue.\n");
+
+		/* Receive threads share input queues round robin */
+		queue = inq[idx % num];
 	}
 
 	odp_barrier_wait(&globals->rx_barrier);
@@ -739,6 +757,7 @@ static int test_init(void)
 	const char *iface;
 	int schedule;
 	odp_pktio_config_t cfg;
+	odp_pktin_queue_param_t pktin_param;
 
 	odp_pool_param_init(&params);
 	params.pkt.len     = PKT_HDR_LEN + gbl_args->args.pkt_len;
@@ -753,6 +772,7 @@ static int test_init(void)
 
 	odp_atomic_init_u32(&gbl_args->ip_seq, 0);
 	odp_atomic_init_u32(&gbl_args->shutdown, 0);
+	odp_atomic_init_u32(&gbl_args->rx_queue_idx, 0);
 
 	iface    = gbl_args->args.ifaces[0];
 	schedule = gbl_args->args.schedule;
@@ -786,8 +806,16 @@ static int test_init(void)
 		return -1;
 	}
 
-	/* Configure also input side (with defaults) */
-	if (odp_pktin_queue_config(gbl_args->pktio_tx, NULL)) {
+	/* Configure also input side. Multiple input queues use flow
+	 * hashing. */
+	odp_pktin_queue_param_init(&pktin_param);
+	if (gbl_args->args.num_rx_queues > 1) {
+		pktin_param.hash_enable = 1;
+		pktin_param.hash_proto.proto.ipv4_udp = 1;
+		pktin_param.num_queues = gbl_args->args.num_rx_queues;
+	}
+
+	if (odp_pktin_queue_config(gbl_args->pktio_tx, &pktin_param)) {
 		ODPH_ERR("failed to configure pktio_tx queue\n");
 		return -1;
 	}
@@ -805,7 +833,7 @@ static int test_init(void)
 			return -1;
 		}
 
-		if (odp_pktin_queue_config(gbl_args->pktio_rx, NULL)) {
+		if (odp_pktin_queue_config(gbl_args->pktio_rx, &pktin_param)) {
 			ODPH_ERR("failed to configure pktio_rx queue\n");
 			return -1;
 		}
@@ -822,26 +850,30 @@ static int test_init(void)
 
 static int empty_inq(odp_pktio_t pktio)
 {
-	odp_queue_t queue = ODP_QUEUE_INVALID;
+	odp_queue_t queue[MAX_QUEUES];
 	odp_event_t ev;
 	odp_queue_type_t q_type;
+	int i, num;
 
-	if (odp_pktin_event_queue(pktio, &queue, 1) != 1)
+	num = odp_pktin_event_queue(pktio, queue, MAX_QUEUES);
+	if (num < 1)
 		return -1;
 
-	q_type = odp_queue_type(queue);
+	q_type = odp_queue_type(queue[0]);
 
 	/* flush any pending events */
-	while (1) {
-		if (q_type == ODP_QUEUE_TYPE_PLAIN)
-			ev = odp_queue_deq(queue);
-		else
-			ev = odp_schedule(NULL, ODP_SCHED_NO_WAIT);
-
-		if (ev != ODP_EVENT_INVALID)
-			odp_event_free(ev);
-		else
-			break;
+	for (i = 0; i < num; i++) {
+		while (1) {
+			if (q_type == ODP_QUEUE_TYPE_PLAIN)
+				ev = odp_queue_deq(queue[i]);
+			else
+				ev = odp_schedule(NULL, ODP_SCHED_NO_WAIT);
+
+			if (ev != ODP_EVENT_INVALID)
+				odp_event_free(ev);
+			else
+				break;
+		}
 	}
 
 	return 0;
@@ -926,6 +958,8 @@ static void usage(void)
 	printf("                         default: disabled (use scheduler)\n");
 	printf("  -R, --rxbatch <length> Number of packets per RX batch\n");
 	printf("                         default: %d\n", BATCH_LEN_MAX);
+	printf("  -q, --rxqueues <num>   Number of input queues (with flow hashing)\n");
+	printf("                         default: 1\n");
 	printf("  -l, --length <length>  Additional payload length in bytes\n");
 	printf("                         default: 0\n");
 	printf("  -r, --rate <number>    Attempted packet rate in PPS\n");
@@ -947,6 +981,7 @@ static void parse_args(int argc, char *argv[], test_args_t *args)
 		{"txbatch",   required_argument, NULL, 'b'},
 		{"plain",     no_argument,       NULL, 'p'},
 		{"rxbatch",   required_argument, NULL, 'R'},
+		{"rxqueues",  required_argument, NULL, 'q'},
 		{"length",    required_argument, NULL, 'l'},
 		{"rate",      required_argument, NULL, 'r'},
 		{"interface", required_argument, NULL, 'i'},
@@ -956,12 +991,13 @@ static void parse_args(int argc, char *argv[], test_args_t *args)
 		{NULL, 0, NULL, 0}
 	};
 
-	static const char *shortopts = "+c:t:b:pR:l:r:i:d:vh";
+	static const char *shortopts = "+c:t:b:pR:q:l:r:i:d:vh";
 
 	args->cpu_count      = 2;
 	args->num_tx_workers = 0; /* defaults to cpu_count+1/2 */
 	args->tx_batch_len   = BATCH_LEN_MAX;
 	args->rx_batch_len   = BATCH_LEN_MAX;
+	args->num_rx_queues  = 1;
 	args->duration       = 1;
 	args->pps            = RATE_SEARCH_INITIAL_PPS;
 	args->search         = 1;
@@ -1018,6 +1054,15 @@ static void parse_args(int argc, char *argv[], test_args_t *args)
 		case 'R':
 			args->rx_batch_len = atoi(optarg);
 			break;
+		case 'q':
+			args->num_rx_queues = atoi(optarg);
+			if (args->num_rx_queues < 1 ||
+			    args->num_rx_queues > MAX_QUEUES) {
+				printf("Bad number of input queues: %u\n",
+				       args->num_rx_queues);
+				exit(EXIT_FAILURE);
+			}
+			break;
 		case 'v':
 			args->verbose = 1;
 			break;
@@ -11,6 +11,7 @@
 #include <signal.h>
 #include <stdlib.h>
 #include <getopt.h>
+#include <time.h>
 
 #include <odp_api.h>
 #include <odp/helper/odph_api.h>
@@ -19,6 +20,13 @@
 #define MAX_TIMERS      10000
 #define START_NS        (100 * ODP_TIME_MSEC_IN_NS)
 
+/* Timer counts and measurement time of the timer processing cost test */
+#define NUM_COST_ROUNDS 3
+#define COST_TEST_NS    (2 * ODP_TIME_SEC_IN_NS)
+
+#define MODE_TIMEOUT    0
+#define MODE_COST       1
+
 typedef struct test_options_t {
 	uint32_t num_cpu;
 	uint32_t num_tp;
@@ -26,6 +34,7 @@ typedef struct test_options_t {
 	uint64_t res_ns;
 	uint64_t period_ns;
 	int      shared;
+	int      mode;
 
 } test_options_t;
 
@@ -92,6 +101,11 @@ static void print_usage(void)
 	       "                         tested only with single CPU. Default: 1\n"
 	       "                           0: Private timer pools\n"
 	       "                           1: Shared timer pools\n"
+	       "  -m, --mode             Test mode. Default: 0\n"
+	       "                           0: Measure timeout accuracy and schedule() overhead\n"
+	       "                           1: Measure timer processing cost with 1k, 100k and 1M\n"
+	       "                              active timers that do not expire during the test.\n"
+	       "                              Uses a single shared timer pool and the main thread.\n"
 	       "  -h, --help             This help\n"
 	       "\n");
 }
@@ -109,11 +123,12 @@ static int parse_options(int argc, char *argv[], test_options_t *test_options)
 		{"res_ns",    required_argument, NULL, 'r'},
 		{"period_ns", required_argument, NULL, 'p'},
 		{"shared",    required_argument, NULL, 's'},
+		{"mode",      required_argument, NULL, 'm'},
 		{"help",      no_argument,       NULL, 'h'},
 		{NULL, 0, NULL, 0}
 	};
 
-	static const char *shortopts = "+c:n:t:r:p:s:h";
+	static const char *shortopts = "+c:n:t:r:p:s:m:h";
 
 	test_options->num_cpu   = 1;
 	test_options->num_tp    = 1;
@@ -121,6 +136,7 @@ static int parse_options(int argc, char *argv[], test_options_t *test_options)
 	test_options->res_ns    = 10 * ODP_TIME_MSEC_IN_NS;
 	test_options->period_ns = 100 * ODP_TIME_MSEC_IN_NS;
 	test_options->shared    = 1;
+	test_options->mode      = MODE_TIMEOUT;
 
 	while (1) {
 		opt = getopt_long(argc, argv, shortopts, longopts, &long_index);
@@ -147,6 +163,9 @@ static int parse_options(int argc, char *argv[], test_options_t *test_options)
 		case 's':
 			test_options->shared = atoi(optarg);
 			break;
+		case 'm':
+			test_options->mode = atoi(optarg);
+			break;
 		case 'h':
 			/* fall through */
 		default:
@@ -156,6 +175,12 @@ static int parse_options(int argc, char *argv[], test_options_t *test_options)
 		}
 	}
 
+	if (test_options->mode != MODE_TIMEOUT &&
+	    test_options->mode != MODE_COST) {
+		printf("Error: bad test mode %i\n", test_options->mode);
+		ret = -1;
+	}
+
 	if (test_options->num_timer > MAX_TIMERS) {
 		printf("Error: too many timers. Max %u\n", MAX_TIMERS);
 		ret = -1;
@@ -654,6 +679,202 @@ static void print_stat(test_global_t *global)
 	printf("\n");
 }
 
+static uint64_t cpu_time_ns(clockid_t clock_id)
+{
+	struct timespec ts;
+
+	if (clock_gettime(clock_id, &ts))
+		return 0;
+
+	return ((uint64_t)ts.tv_sec * ODP_TIME_SEC_IN_NS) + ts.tv_nsec;
+}
+
+/* Measure timer processing cost with a large number of active timers. None
+ * of the timers expire during the measurement, so the measured cost is
+ * the cost of finding out that there is nothing to expire. */
+static int cost_round(test_global_t *global, uint32_t num_timer)
+{
+	odp_timer_capability_t timer_capa;
+	odp_timer_pool_param_t timer_pool_param;
+	odp_pool_param_t pool_param;
+	odp_queue_param_t queue_param;
+	odp_timer_pool_t tp;
+	odp_pool_t pool;
+	odp_queue_t queue;
+	odp_timer_t *timer;
+	odp_timeout_t tmo;
+	odp_event_t ev;
+	odp_time_t t1, t2;
+	uint64_t tick_cur, tick, c1, c2;
+	uint64_t proc1, proc2, thr1, thr2, nsec, bg_nsec;
+	uint64_t rounds = 0;
+	uint64_t events = 0;
+	uint32_t i;
+	int ret = 0;
+	test_options_t *test_options = &global->test_options;
+	uint64_t res_ns = test_options->res_ns;
+	/* Timers expire well after the measurement period */
+	uint64_t tmo_ns = START_NS + COST_TEST_NS + (10 * ODP_TIME_SEC_IN_NS);
+
+	if (odp_timer_capability(ODP_CLOCK_CPU, &timer_capa)) {
+		printf("Error: timer capability failed\n");
+		return -1;
+	}
+
+	if (timer_capa.max_timers && num_timer > timer_capa.max_timers) {
+		printf("Skipping %u timers (max %u)\n", num_timer,
+		       timer_capa.max_timers);
+		return 0;
+	}
+
+	timer = malloc(num_timer * sizeof(odp_timer_t));
+	if (timer == NULL) {
+		printf("Error: timer table alloc failed\n");
+		return -1;
+	}
+
+	memset(&timer_pool_param, 0, sizeof(odp_timer_pool_param_t));
+	timer_pool_param.res_ns     = res_ns;
+	timer_pool_param.min_tmo    = START_NS;
+	timer_pool_param.max_tmo    = 2 * tmo_ns;
+	timer_pool_param.num_timers = num_timer;
+	timer_pool_param.clk_src    = ODP_CLOCK_CPU;
+
+	odp_pool_param_init(&pool_param);
+	pool_param.type    = ODP_POOL_TIMEOUT;
+	pool_param.tmo.num = num_timer;
+
+	odp_queue_param_init(&queue_param);
+	queue_param.type        = ODP_QUEUE_TYPE_SCHED;
+	queue_param.sched.prio  = ODP_SCHED_PRIO_DEFAULT;
+	queue_param.sched.sync  = ODP_SCHED_SYNC_ATOMIC;
+	queue_param.sched.group = ODP_SCHED_GROUP_ALL;
+
+	tp    = odp_timer_pool_create(NULL, &timer_pool_param);
+	pool  = odp_pool_create(NULL, &pool_param);
+	queue = odp_queue_create(NULL, &queue_param);
+
+	if (tp == ODP_TIMER_POOL_INVALID || pool == ODP_POOL_INVALID ||
+	    queue == ODP_QUEUE_INVALID) {
+		printf("Error: resource create failed (%u timers)\n",
+		       num_timer);
+		ret = -1;
+		goto destroy;
+	}
+
+	odp_timer_pool_start();
+
+	for (i = 0; i < num_timer; i++)
+		timer[i] = ODP_TIMER_INVALID;
+
+	tick_cur = odp_timer_current_tick(tp);
+	tick     = tick_cur + odp_timer_ns_to_tick(tp, tmo_ns);
+
+	for (i = 0; i < num_timer; i++) {
+		tmo = odp_timeout_alloc(pool);
+		timer[i] = odp_timer_alloc(tp, queue, NULL);
+
+		if (tmo == ODP_TIMEOUT_INVALID || timer[i] == ODP_TIMER_INVALID) {
+			printf("Error: timer alloc failed (%u)\n", i);
+			if (tmo != ODP_TIMEOUT_INVALID)
+				odp_timeout_free(tmo);
+			ret = -1;
+			goto free_timers;
+		}
+
+		ev = odp_timeout_to_event(tmo);
+
+		/* Spread timers over one millisecond */
+		if (odp_timer_set_abs(timer[i], tick + (i % 1000) * 1000,
+				      &ev) != ODP_TIMER_SUCCESS) {
+			printf("Error: timer set failed (%u)\n", i);
+			odp_event_free(ev);
+			ret = -1;
+			goto free_timers;
+		}
+	}
+
+	proc1 = cpu_time_ns(CLOCK_PROCESS_CPUTIME_ID);
+	thr1  = cpu_time_ns(CLOCK_THREAD_CPUTIME_ID);
+	t1    = odp_time_local();
+	c1    = odp_cpu_cycles();
+
+	do {
+		ev = odp_schedule(NULL, ODP_SCHED_NO_WAIT);
+		rounds++;
+
+		if (ev != ODP_EVENT_INVALID) {
+			events++;
+			odp_event_free(ev);
+		}
+
+		t2   = odp_time_local();
+		nsec = odp_time_diff_ns(t2, t1);
+	} while (nsec < COST_TEST_NS);
+
+	c2    = odp_cpu_cycles();
+	thr2  = cpu_time_ns(CLOCK_THREAD_CPUTIME_ID);
+	proc2 = cpu_time_ns(CLOCK_PROCESS_CPUTIME_ID);
+
+	/* CPU time used by other than the main thread, e.g. timer threads */
+	bg_nsec = (proc2 - proc1) - (thr2 - thr1);
+
+	printf("  %8u timers: %10.1f cycles per schedule() round, "
+	       "%5.1f%% CPU in background threads, %" PRIu64 " events\n",
+	       num_timer, (double)odp_cpu_cycles_diff(c2, c1) / rounds,
+	       100.0 * bg_nsec / nsec, events);
+
+free_timers:
+	for (i = 0; i < num_timer; i++) {
+		if (timer[i] == ODP_TIMER_INVALID)
+			break;
+
+		ev = odp_timer_free(timer[i]);
+		if (ev != ODP_EVENT_INVALID)
+			odp_event_free(ev);
+	}
+
+	/* Free events that possibly were already scheduled */
+	while ((ev = odp_schedule(NULL, ODP_SCHED_NO_WAIT)) !=
+	       ODP_EVENT_INVALID)
+		odp_event_free(ev);
+
+destroy:
+	if (queue != ODP_QUEUE_INVALID)
+		odp_queue_destroy(queue);
+
+	if (pool != ODP_POOL_INVALID)
+		odp_pool_destroy(pool);
+
+	if (tp != ODP_TIMER_POOL_INVALID)
+		odp_timer_pool_destroy(tp);
+
+	free(timer);
+
+	return ret;
+}
+
+static int test_cost(test_global_t *global)
+{
+	const uint32_t num_timer[NUM_COST_ROUNDS] = {1000, 100000, 1000000};
+	int i;
+
+	printf("\nTimer processing cost test\n");
+	printf("  resolution       %" PRIu64 " nsec\n",
+	       global->test_options.res_ns);
+	printf("  test duration    %.2f sec per round\n\n",
+	       (double)COST_TEST_NS / ODP_TIME_SEC_IN_NS);
+
+	for (i = 0; i < NUM_COST_ROUNDS; i++) {
+		if (cost_round(global, num_timer[i]))
+			return -1;
+	}
+
+	printf("\n");
+
+	return 0;
+}
+
 static void sig_handler(int signo)
 {
 	(void)signo;
@@ -708,6 +929,13 @@ int main(int argc, char **argv)
 
 	odp_schedule_config(NULL);
 
+	if (test_options->mode == MODE_COST) {
+		if (test_cost(global))
+			return -1;
+
+		goto term;
+	}
+
 	if (set_num_cpu(global))
 		return -1;
 
@@ -746,6 +974,7 @@ int main(int argc, char **argv)
 
 	destroy_timer_pool(global);
 
+term:
 	if (odp_term_local()) {
 		printf("Error: term local failed.\n");
 		return -1;
@@ -292,13 +292,14 @@ static void test_out_ipv4_esp_null_sha256_tun_ipv6(void)
 	ipsec_sa_destroy(sa);
 }
 
-static void test_out_in_common(odp_bool_t ah,
-			       odp_cipher_alg_t cipher,
-			       const odp_crypto_key_t *cipher_key,
-			       odp_auth_alg_t auth,
-			       const odp_crypto_key_t *auth_key,
-			       const odp_crypto_key_t *cipher_key_extra,
-			       const odp_crypto_key_t *auth_key_extra)
+static void test_out_in_common_esn(odp_bool_t ah,
+				   odp_bool_t esn,
+				   odp_cipher_alg_t cipher,
+				   const odp_crypto_key_t *cipher_key,
+				   odp_auth_alg_t auth,
+				   const odp_crypto_key_t *auth_key,
+				   const odp_crypto_key_t *cipher_key_extra,
+				   const odp_crypto_key_t *auth_key_extra)
 {
 	odp_ipsec_sa_param_t param;
 	odp_ipsec_sa_t sa_out;
@@ -309,6 +310,7 @@ static void test_out_in_common(odp_bool_t ah,
 			    cipher, cipher_key,
 			    auth, auth_key,
 			    cipher_key_extra, auth_key_extra);
+	param.opt.esn = esn;
 
 	sa_out = odp_ipsec_sa_create(&param);
 
@@ -319,6 +321,9 @@ static void test_out_in_common(odp_bool_t ah,
 			    cipher, cipher_key,
 			    auth, auth_key,
 			    cipher_key_extra, auth_key_extra);
+	param.opt.esn = esn;
+	if (esn)
+		param.inbound.antireplay_ws = 32;
 
 	sa_in = odp_ipsec_sa_create(&param);
 
@@ -342,6 +347,20 @@ static void test_out_in_common(odp_bool_t ah,
 	ipsec_sa_destroy(sa_in);
 }
 
+static void test_out_in_common(odp_bool_t ah,
+			       odp_cipher_alg_t cipher,
+			       const odp_crypto_key_t *cipher_key,
+			       odp_auth_alg_t auth,
+			       const odp_crypto_key_t *auth_key,
+			       const odp_crypto_key_t *cipher_key_extra,
+			       const odp_crypto_key_t *auth_key_extra)
+{
+	test_out_in_common_esn(ah, false,
+			       cipher, cipher_key,
+			       auth, auth_key,
+			       cipher_key_extra, auth_key_extra);
+}
+
 static void test_esp_out_in(struct cipher_param *cipher,
 			    struct auth_param *auth)
 {
@@ -537,6 +556,30 @@ static void test_out_ipv4_esp_chacha20_poly1305(void)
 			   &key_rfc7634_salt, NULL);
 }
 
+static void test_out_ipv4_esp_aes_cbc_sha256_esn(void)
+{
+	test_out_in_common_esn(false, true,
+			       ODP_CIPHER_ALG_AES_CBC, &key_a5_128,
+			       ODP_AUTH_ALG_SHA256_HMAC, &key_5a_256,
+			       NULL, NULL);
+}
+
+static void test_out_ipv4_esp_aes_gcm128_esn(void)
+{
+	test_out_in_common_esn(false, true,
+			       ODP_CIPHER_ALG_AES_GCM, &key_a5_128,
+			       ODP_AUTH_ALG_AES_GCM, NULL,
+			       &key_mcgrew_gcm_salt_2, NULL);
+}
+
+static void test_out_ipv4_ah_sha256_esn(void)
+{
+	test_out_in_common_esn(true, true,
+			       ODP_CIPHER_ALG_NULL, NULL,
+			       ODP_AUTH_ALG_SHA256_HMAC, &key_5a_256,
+			       NULL, NULL);
+}
+
 static void test_out_ipv4_ah_sha256_frag_check(void)
 {
 	odp_ipsec_sa_param_t param;
@@ -1187,6 +1230,12 @@ odp_testinfo_t ipsec_out_suite[] = {
 				  ipsec_check_esp_aes_ccm_256),
 	ODP_TEST_INFO_CONDITIONAL(test_out_ipv4_esp_chacha20_poly1305,
 				  ipsec_check_esp_chacha20_poly1305),
+	ODP_TEST_INFO_CONDITIONAL(test_out_ipv4_esp_aes_cbc_sha256_esn,
+				  ipsec_check_esp_aes_cbc_128_sha256),
+	ODP_TEST_INFO_CONDITIONAL(test_out_ipv4_esp_aes_gcm128_esn,
+				  ipsec_check_esp_aes_gcm_128),
+	ODP_TEST_INFO_CONDITIONAL(test_out_ipv4_ah_sha256_esn,
+				  ipsec_check_ah_sha256),
 	ODP_TEST_INFO_CONDITIONAL(test_out_ipv4_ah_sha256_frag_check,
 				  ipsec_check_ah_sha256),
 	ODP_TEST_INFO_CONDITIONAL(test_out_ipv4_ah_sha256_frag_check_2,